@@ -33,6 +33,8 @@
 
 #include "PerceptualColor/constpropagatinguniquepointer.h"
 
+#include <functional>
+
 namespace PerceptualColor
 {
 /** @brief Base class for LCh diagrams.
@@ -74,6 +76,9 @@ public:
     virtual ~AbstractDiagram() noexcept override;
 
 protected:
+    QRect circularHandleBoundingRect(const QPointF &center) const;
+    void coalesceInput(const std::function<void()> &handler);
+    void discardPendingInput();
     QColor focusIndicatorColor() const;
     int gradientMinimumLength() const;
     int gradientThickness() const;
@@ -83,6 +88,10 @@ protected:
     QColor handleColorFromBackgroundLightness(qreal lightness) const;
     int handleOutlineThickness() const;
     qreal handleRadius() const;
+    bool isInteractionInProgress() const;
+    QRect lineBoundingRect(const QPointF &start, const QPointF &end, const qreal lineWidth) const;
+    void registerImageParameterChange();
+    void registerInteraction();
     int spaceForFocusIndicator() const;
     QImage transparencyBackground() const;
 
@@ -130,6 +130,35 @@ class PERCEPTUALCOLOR_IMPORTEXPORT ChromaHueDiagram : public AbstractDiagram
      * @sa NOTIFY @ref currentColorChanged() */
     Q_PROPERTY(LchDouble currentColor READ currentColor WRITE setCurrentColor NOTIFY currentColorChanged)
 
+    /** @brief Minimum color difference for @ref currentColorChangedThrottled()
+     *
+     * A color change is only notified by @ref currentColorChangedThrottled()
+     * if it differs from the most recently notified color by at least this
+     * value, measured as CIE76 ΔE*ab. Negative values are treated
+     * as <tt>0</tt>.
+     *
+     * Default value: <tt>0</tt>, which means that all changes are
+     * notified within the limits of @ref throttledNotificationRate.
+     *
+     * @sa READ @ref throttledNotificationDeltaE() const
+     * @sa WRITE @ref setThrottledNotificationDeltaE()
+     * @sa NOTIFY @ref throttledNotificationDeltaEChanged() */
+    Q_PROPERTY(qreal throttledNotificationDeltaE READ throttledNotificationDeltaE WRITE setThrottledNotificationDeltaE NOTIFY throttledNotificationDeltaEChanged)
+
+    /** @brief Maximum rate of @ref currentColorChangedThrottled()
+     *
+     * The maximum number of @ref currentColorChangedThrottled() signals
+     * per second. Negative values are treated as <tt>0</tt>.
+     *
+     * Default value: <tt>0</tt>, which disables throttled notifications:
+     * Neither @ref currentColorChangedThrottled() nor
+     * @ref currentColorChangeFinished() are emitted.
+     *
+     * @sa READ @ref throttledNotificationRate() const
+     * @sa WRITE @ref setThrottledNotificationRate()
+     * @sa NOTIFY @ref throttledNotificationRateChanged() */
+    Q_PROPERTY(qreal throttledNotificationRate READ throttledNotificationRate WRITE setThrottledNotificationRate NOTIFY throttledNotificationRateChanged)
+
 public:
     Q_INVOKABLE explicit ChromaHueDiagram(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, QWidget *parent = nullptr);
     virtual ~ChromaHueDiagram() noexcept override;
@@ -138,14 +167,46 @@ public:
     LchDouble currentColor() const;
     virtual QSize minimumSizeHint() const override;
     virtual QSize sizeHint() const override;
+    /** @brief Getter for property @ref throttledNotificationDeltaE
+     *  @returns the property @ref throttledNotificationDeltaE */
+    qreal throttledNotificationDeltaE() const;
+    /** @brief Getter for property @ref throttledNotificationRate
+     *  @returns the property @ref throttledNotificationRate */
+    qreal throttledNotificationRate() const;
 
 public Q_SLOTS:
     void setCurrentColor(const PerceptualColor::LchDouble &newCurrentColor);
+    void setThrottledNotificationDeltaE(const qreal newThrottledNotificationDeltaE);
+    void setThrottledNotificationRate(const qreal newThrottledNotificationRate);
 
 Q_SIGNALS:
+    /** @brief A series of changes of @ref currentColor has finished.
+     *
+     * Emitted once when @ref currentColor has come to rest after one or
+     * more changes, for example when the user releases the mouse
+     * button. Only emitted if @ref throttledNotificationRate is
+     * not <tt>0</tt>.
+     *
+     * @param newCurrentColor the new current color */
+    void currentColorChangeFinished(const PerceptualColor::LchDouble &newCurrentColor);
     /** @brief Notify signal for property @ref currentColor.
      *  @param newCurrentColor the new current color */
     void currentColorChanged(const PerceptualColor::LchDouble &newCurrentColor);
+    /** @brief Rate-limited variant of @ref currentColorChanged().
+     *
+     * Emitted at most @ref throttledNotificationRate times per second,
+     * and only for changes of at least @ref throttledNotificationDeltaE.
+     * Intermediate changes are dropped, but the final color of a series
+     * of changes is always notified by @ref currentColorChangeFinished().
+     *
+     * @param newCurrentColor the new current color */
+    void currentColorChangedThrottled(const PerceptualColor::LchDouble &newCurrentColor);
+    /** @brief Notify signal for property @ref throttledNotificationDeltaE.
+     * @param newThrottledNotificationDeltaE the new value */
+    void throttledNotificationDeltaEChanged(const qreal newThrottledNotificationDeltaE);
+    /** @brief Notify signal for property @ref throttledNotificationRate.
+     * @param newThrottledNotificationRate the new value */
+    void throttledNotificationRateChanged(const qreal newThrottledNotificationRate);
 
 protected:
     virtual void keyPressEvent(QKeyEvent *event) override;
@@ -330,6 +330,42 @@ class PERCEPTUALCOLOR_IMPORTEXPORT ColorDialog : public QDialog
      * @sa NOTIFY @ref optionsChanged()*/
     Q_PROPERTY(ColorDialogOptions options READ options WRITE setOptions NOTIFY optionsChanged)
 
+    /** @brief Minimum color difference for @ref currentColorChangedThrottled()
+     *
+     * A color change is only notified by @ref currentColorChangedThrottled()
+     * if it differs from the most recently notified color by at least this
+     * value. The difference is measured as CIE76 ΔE*ab (with the alpha
+     * channel taken into account as an additional dimension, scaled to
+     * the range [0, 100]). Negative values are treated as <tt>0</tt>.
+     *
+     * Default value: <tt>0</tt>, which means that all changes are
+     * notified within the limits of @ref throttledNotificationRate.
+     *
+     * @sa READ @ref throttledNotificationDeltaE() const
+     * @sa WRITE @ref setThrottledNotificationDeltaE()
+     * @sa NOTIFY @ref throttledNotificationDeltaEChanged() */
+    Q_PROPERTY(qreal throttledNotificationDeltaE READ throttledNotificationDeltaE WRITE setThrottledNotificationDeltaE NOTIFY throttledNotificationDeltaEChanged)
+
+    /** @brief Maximum rate of @ref currentColorChangedThrottled()
+     *
+     * The maximum number of @ref currentColorChangedThrottled() signals
+     * per second. Negative values are treated as <tt>0</tt>.
+     *
+     * Default value: <tt>0</tt>, which disables throttled notifications:
+     * Neither @ref currentColorChangedThrottled() nor
+     * @ref currentColorChangeFinished() are emitted.
+     *
+     * Throttled notifications are useful if each color change triggers
+     * expensive work in your application: Do a cheap preview on
+     * @ref currentColorChangedThrottled() and a full-quality update
+     * on @ref currentColorChangeFinished():
+     * @snippet test/testcolordialog.cpp ColorDialog Throttled notifications
+     *
+     * @sa READ @ref throttledNotificationRate() const
+     * @sa WRITE @ref setThrottledNotificationRate()
+     * @sa NOTIFY @ref throttledNotificationRateChanged() */
+    Q_PROPERTY(qreal throttledNotificationRate READ throttledNotificationRate WRITE setThrottledNotificationRate NOTIFY throttledNotificationRateChanged)
+
 public:
     /** @brief Local alias for QColorDialog::ColorDialogOption
      *
@@ -390,30 +426,62 @@ public:
     Q_INVOKABLE QColor selectedColor() const;
     virtual void setVisible(bool visible) override;
     Q_INVOKABLE bool testOption(PerceptualColor::ColorDialog::ColorDialogOption option) const;
+    /** @brief Getter for property @ref throttledNotificationDeltaE
+     *  @returns the property @ref throttledNotificationDeltaE */
+    qreal throttledNotificationDeltaE() const;
+    /** @brief Getter for property @ref throttledNotificationRate
+     *  @returns the property @ref throttledNotificationRate */
+    qreal throttledNotificationRate() const;
 
 public Q_SLOTS:
     void setCurrentColor(const QColor &color);
     void setLayoutDimensions(const PerceptualColor::ColorDialog::DialogLayoutDimensions newLayoutDimensions);
     Q_INVOKABLE void setOption(PerceptualColor::ColorDialog::ColorDialogOption option, bool on = true);
     void setOptions(PerceptualColor::ColorDialog::ColorDialogOptions newOptions);
+    void setThrottledNotificationDeltaE(const qreal newThrottledNotificationDeltaE);
+    void setThrottledNotificationRate(const qreal newThrottledNotificationRate);
 
 Q_SIGNALS:
     /** @brief This signal is emitted just after the user has clicked OK to
      * select a color to use.
      *  @param color the chosen color */
     void colorSelected(const QColor &color);
+    /** @brief A series of changes of the “current color” has finished.
+     *
+     * Emitted once when the “current color” has come to rest after
+     * one or more changes, for example when the user has finished
+     * dragging a handle. Only emitted if
+     * @ref throttledNotificationRate is not <tt>0</tt>.
+     *
+     * @param color the new “current color” */
+    void currentColorChangeFinished(const QColor &color);
     /** @brief Notify signal for property @ref currentColor.
      *
      * This signal is emitted whenever the “current color” changes in the
      * dialog.
      * @param color the new “current color” */
     void currentColorChanged(const QColor &color);
+    /** @brief Rate-limited variant of @ref currentColorChanged().
+     *
+     * Emitted at most @ref throttledNotificationRate times per second,
+     * and only for changes of at least @ref throttledNotificationDeltaE.
+     * Intermediate changes are dropped, but the final color of a series
+     * of changes is always notified by @ref currentColorChangeFinished().
+     *
+     * @param color the new “current color” */
+    void currentColorChangedThrottled(const QColor &color);
     /** @brief Notify signal for property @ref layoutDimensions.
      * @param newLayoutDimensions the new layout dimensions */
     void layoutDimensionsChanged(const PerceptualColor::ColorDialog::DialogLayoutDimensions newLayoutDimensions);
     /** @brief Notify signal for property @ref options.
      * @param newOptions the new options */
     void optionsChanged(const PerceptualColor::ColorDialog::ColorDialogOptions newOptions);
+    /** @brief Notify signal for property @ref throttledNotificationDeltaE.
+     * @param newThrottledNotificationDeltaE the new value */
+    void throttledNotificationDeltaEChanged(const qreal newThrottledNotificationDeltaE);
+    /** @brief Notify signal for property @ref throttledNotificationRate.
+     * @param newThrottledNotificationRate the new value */
+    void throttledNotificationRateChanged(const qreal newThrottledNotificationRate);
 
 protected:
     virtual void done(int result) override;
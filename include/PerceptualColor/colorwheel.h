@@ -100,6 +100,27 @@ class PERCEPTUALCOLOR_IMPORTEXPORT ColorWheel : public AbstractDiagram
      * to @ref PolarPointF::normalizedAngleDegree() */
     Q_PROPERTY(qreal hue READ hue WRITE setHue NOTIFY hueChanged USER true)
 
+    /** @brief Maximum rate of @ref hueChangedThrottled()
+     *
+     * The maximum number of @ref hueChangedThrottled() signals
+     * per second. Negative values are treated as <tt>0</tt>.
+     *
+     * Default value: <tt>0</tt>, which disables throttled notifications:
+     * Neither @ref hueChangedThrottled() nor @ref hueChangeFinished()
+     * are emitted.
+     *
+     * @sa READ @ref throttledNotificationRate() const
+     * @sa WRITE @ref setThrottledNotificationRate()
+     * @sa NOTIFY @ref throttledNotificationRateChanged()
+     *
+     * @internal
+     *
+     * Unlike the other diagrams, this widget has no minimum color
+     * difference for throttled notifications: It controls only the
+     * hue, so a ΔE*ab threshold would depend on a lightness and a
+     * chroma that this widget does not know. */
+    Q_PROPERTY(qreal throttledNotificationRate READ throttledNotificationRate WRITE setThrottledNotificationRate NOTIFY throttledNotificationRateChanged)
+
 public:
     Q_INVOKABLE explicit ColorWheel(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, QWidget *parent = nullptr);
     virtual ~ColorWheel() noexcept override;
@@ -108,14 +129,37 @@ public:
     qreal hue() const;
     virtual QSize minimumSizeHint() const override;
     virtual QSize sizeHint() const override;
+    /** @brief Getter for property @ref throttledNotificationRate
+     *  @returns the property @ref throttledNotificationRate */
+    qreal throttledNotificationRate() const;
 
 Q_SIGNALS:
+    /** @brief A series of changes of @ref hue has finished.
+     *
+     * Emitted once when @ref hue has come to rest after one or more
+     * changes, for example when the user releases the mouse button.
+     * Only emitted if @ref throttledNotificationRate is not <tt>0</tt>.
+     *
+     * @param newHue the new hue */
+    void hueChangeFinished(const qreal newHue);
     /** @brief Notify signal for property @ref hue.
      * @param newHue the new hue */
     void hueChanged(const qreal newHue);
+    /** @brief Rate-limited variant of @ref hueChanged().
+     *
+     * Emitted at most @ref throttledNotificationRate times per second.
+     * Intermediate changes are dropped, but the final hue of a series
+     * of changes is always notified by @ref hueChangeFinished().
+     *
+     * @param newHue the new hue */
+    void hueChangedThrottled(const qreal newHue);
+    /** @brief Notify signal for property @ref throttledNotificationRate.
+     * @param newThrottledNotificationRate the new value */
+    void throttledNotificationRateChanged(const qreal newThrottledNotificationRate);
 
 public Q_SLOTS:
     void setHue(const qreal newHue);
+    void setThrottledNotificationRate(const qreal newThrottledNotificationRate);
 
 protected:
     virtual void keyPressEvent(QKeyEvent *event) override;
@@ -0,0 +1,97 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef IMAGEDISKCACHE_H
+#define IMAGEDISKCACHE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <QtGlobal>
+
+namespace PerceptualColor
+{
+/** @brief Persistent on-disk cache for the images of the diagrams.
+ *
+ * The widgets of this library render their diagrams (color wheel,
+ * chroma-hue plane, chroma-lightness plane) pixel by pixel, which takes
+ * some time. By default, this happens again each time the application
+ * starts. When the disk cache is enabled, rendered images are stored in
+ * a cache directory and reused by later application starts, as long as
+ * the color profile and all image parameters (size, border, lightness
+ * or hue, device pixel ratio…) are identical.
+ *
+ * The cache is disabled by default. Enable it at application start,
+ * before creating the widgets:
+ *
+ * @snippet test/testimagediskcache.cpp Enable
+ *
+ * The cache is located within
+ * <tt>QStandardPaths::CacheLocation</tt>, so set the application name
+ * (<tt>QCoreApplication::setApplicationName()</tt>) before using the
+ * cache. Its total size is limited (see @ref setMaximumSize()): When
+ * the limit is exceeded, the least recently used images are deleted.
+ *
+ * The images are stored losslessly. A cached image is therefore
+ * bit-identical to a newly rendered one. Changing the color profile
+ * invalidates the cache automatically, because the profile itself
+ * (and also the version of this library) is part of the cache key.
+ *
+ * All functions of this class are thread-safe. */
+class PERCEPTUALCOLOR_IMPORTEXPORT ImageDiskCache
+{
+public:
+    static void clear();
+    static QString directory();
+    static bool isEnabled();
+    static qint64 maximumSize();
+    static void setEnabled(const bool enabled);
+    static void setMaximumSize(const qint64 newMaximumSize);
+
+private:
+    ImageDiskCache() = delete;
+    Q_DISABLE_COPY(ImageDiskCache)
+
+    static QString fileName(const QByteArray &key);
+    static QImage load(const QByteArray &key);
+    static void prune();
+    static void store(const QByteArray &key, const QImage &image);
+
+    /** @internal @brief The classes that use the cache. */
+    friend class ChromaHueImage;
+    /** @internal @brief The classes that use the cache. */
+    friend class ChromaLightnessImage;
+    /** @internal @brief The classes that use the cache. */
+    friend class ColorWheelImage;
+    /** @internal @brief Only for unit tests. */
+    friend class TestImageDiskCache;
+};
+
+} // namespace PerceptualColor
+
+#endif // IMAGEDISKCACHE_H
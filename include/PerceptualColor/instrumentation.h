@@ -0,0 +1,109 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+
+#include <QMap>
+#include <QString>
+#include <QtGlobal>
+
+namespace PerceptualColor
+{
+/** @brief Opt-in measurement of where the library spends its time.
+ *
+ * When enabled, the library records:
+ * - Timing scopes for image generation, gamut mapping, color space
+ *   initialization and paint events.
+ * - Counters, for example for the LittleCMS transform calls
+ *   (<tt>cmsDoTransform</tt>) and for the hits and misses of the
+ *   image caches. See @ref counters() for the names.
+ *
+ * The results are available in two ways:
+ * - Each finished timing scope is logged to the Qt logging category
+ *   <tt>perceptualcolor.instrumentation</tt> at debug level. Like all
+ *   debug output, it is disabled by default; enable it for example
+ *   with <tt>QT_LOGGING_RULES="perceptualcolor.instrumentation.debug=true"</tt>.
+ *   A summary of the counters is logged at info level when the trace
+ *   is written.
+ * - @ref writeTrace() writes all timing scopes and counters as a
+ *   <a href="https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU">
+ *   Chrome trace</a> JSON file, which can be loaded in
+ *   <tt>chrome://tracing</tt>, <a href="https://ui.perfetto.dev">Perfetto</a>
+ *   and other profiling tools.
+ *
+ * Instrumentation is disabled by default. When disabled, its overhead is
+ * a single atomic load per scope or counter. It can be enabled by API:
+ *
+ * @snippet test/testinstrumentation.cpp Instrumentation usage
+ *
+ * or without recompiling, by environment variables that are read once
+ * when the library is used the first time:
+ * | Environment variable                  | Effect
+ * | :------------------------------------ | :-----
+ * | <tt>PERCEPTUALCOLOR_INSTRUMENTATION</tt> | A non-zero integer enables the instrumentation.
+ * | <tt>PERCEPTUALCOLOR_TRACE_FILE</tt>      | Enables the instrumentation and sets @ref traceFileName().
+ *
+ * If @ref traceFileName() is not empty, the trace is written
+ * automatically when the <tt>QCoreApplication</tt> object is destroyed.
+ *
+ * The number of recorded timing scopes is limited to
+ * @ref maximumEventCount(); further scopes are dropped (but still
+ * logged). Counters are never dropped.
+ *
+ * All functions of this class are thread-safe. */
+class PERCEPTUALCOLOR_IMPORTEXPORT Instrumentation
+{
+public:
+    static QMap<QString, quint64> counters();
+    static int eventCount();
+    static bool isEnabled();
+    static int maximumEventCount();
+    static void reset();
+    static void setEnabled(const bool enabled);
+    static void setTraceFileName(const QString &fileName);
+    static QString traceFileName();
+    static bool writeTrace(const QString &fileName);
+
+private:
+    Instrumentation() = delete;
+    Q_DISABLE_COPY(Instrumentation)
+
+    static void addEvent(const char *name, const qint64 startMicroseconds, const qint64 durationMicroseconds);
+    static void addToCounter(const char *name, const quint64 increment);
+    static qint64 timestampMicroseconds();
+
+    /** @internal @brief The classes that record data. */
+    friend class InstrumentationScope;
+    /** @internal @brief Only for unit tests. */
+    friend class TestInstrumentation;
+};
+
+} // namespace PerceptualColor
+
+#endif // INSTRUMENTATION_H
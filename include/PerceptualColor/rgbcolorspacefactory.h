@@ -30,7 +30,12 @@
 #include "PerceptualColor/perceptualcolorglobal.h"
 #include "perceptualcolorinternal.h"
 
+#include <QByteArray>
+#include <QFuture>
 #include <QSharedPointer>
+#include <QString>
+
+#include <functional>
 
 namespace PerceptualColor
 {
@@ -48,13 +53,27 @@ class RgbColorSpace;
  * the last widget that used it has been deleted. And passing the shared
  * pointer to widget constructors is fast! Usage example:
  *
- * @snippet test/testrgbcolorspacefactory.cpp Create */
+ * @snippet test/testrgbcolorspacefactory.cpp Create
+ *
+ * The factory shares color space objects: Requesting a profile that is
+ * already in use returns the existing object. See @ref createFromFile()
+ * for details.
+ *
+ * To keep the GUI responsive, color space objects can also be created
+ * on a worker thread:
+ *
+ * @snippet test/testrgbcolorspacefactory.cpp Async
+ *
+ * This class is thread-safe. */
 class PERCEPTUALCOLOR_IMPORTEXPORT RgbColorSpaceFactory
 {
 public:
     // No Q_INVOKABLE here because the class does not inherit QObject:
     static QSharedPointer<PerceptualColor::RgbColorSpace> createSrgb();
+    static QFuture<QSharedPointer<PerceptualColor::RgbColorSpace>> createSrgbAsync();
     static QSharedPointer<PerceptualColor::RgbColorSpace> createFromFile(const QString &fileName);
+    static QFuture<QSharedPointer<PerceptualColor::RgbColorSpace>> createFromFileAsync(const QString &fileName);
+    static QSharedPointer<PerceptualColor::RgbColorSpace> createFromMemory(const QByteArray &data);
 
 private:
     /** @internal
@@ -65,6 +84,12 @@ private:
      * is private. */
     RgbColorSpaceFactory() = default;
 
+    static QSharedPointer<PerceptualColor::RgbColorSpace> addToCache(const QByteArray &profileId, const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace);
+    static QSharedPointer<PerceptualColor::RgbColorSpace> cachedColorSpace(const QByteArray &profileId);
+    static QFuture<QSharedPointer<PerceptualColor::RgbColorSpace>> createAsync(const std::function<QSharedPointer<PerceptualColor::RgbColorSpace>()> &createFunction);
+    static QSharedPointer<PerceptualColor::RgbColorSpace> createShared(const QByteArray &profileId, const std::function<QSharedPointer<PerceptualColor::RgbColorSpace>()> &createFunction);
+    static QByteArray profileId(const char *data, const qint64 size);
+
     /** @internal
      *
      * @brief Only for unit tests. */
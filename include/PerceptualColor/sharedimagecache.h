@@ -0,0 +1,93 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SHAREDIMAGECACHE_H
+#define SHAREDIMAGECACHE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+
+#include <QByteArray>
+#include <QImage>
+#include <QtGlobal>
+
+namespace PerceptualColor
+{
+/** @brief Process-wide in-memory cache for the images of the widgets.
+ *
+ * The widgets of this library render their diagrams (color wheel,
+ * chroma-hue plane, chroma-lightness plane, gradients) pixel by pixel.
+ * When an application shows several widgets with identical parameters
+ * (for example several @ref ColorDialog instances at once), all of them
+ * need the very same images. This cache makes sure that such an image
+ * is rendered only once and then shared by all widgets.
+ *
+ * The cache is enabled by default. Images are identified by the color
+ * profile, the image type and all image parameters (size, border,
+ * lightness or hue, device pixel ratio…).
+ *
+ * The images are implicitly shared (reference-counted): Widgets that
+ * show an image hold a reference to the same memory as the cache. The
+ * memory used by the cache itself is limited (see @ref setMaximumSize()).
+ * When the limit is exceeded, the least recently used images are removed
+ * from the cache. (They stay alive as long as a widget still uses them.)
+ *
+ * @snippet test/testsharedimagecache.cpp Statistics
+ *
+ * All functions of this class are thread-safe.
+ *
+ * @sa @ref ImageDiskCache */
+class PERCEPTUALCOLOR_IMPORTEXPORT SharedImageCache
+{
+public:
+    static void clear();
+    static quint64 hits();
+    static qint64 maximumSize();
+    static quint64 misses();
+    static void setMaximumSize(const qint64 newMaximumSize);
+    static qint64 size();
+
+private:
+    SharedImageCache() = delete;
+    Q_DISABLE_COPY(SharedImageCache)
+
+    static QImage find(const QByteArray &key);
+    static void insert(const QByteArray &key, const QImage &image);
+
+    /** @internal @brief The classes that use the cache. */
+    friend class ChromaHueImage;
+    /** @internal @brief The classes that use the cache. */
+    friend class ChromaLightnessImage;
+    /** @internal @brief The classes that use the cache. */
+    friend class ColorWheelImage;
+    /** @internal @brief The classes that use the cache. */
+    friend class GradientImage;
+    /** @internal @brief Only for unit tests. */
+    friend class TestSharedImageCache;
+};
+
+} // namespace PerceptualColor
+
+#endif // SHAREDIMAGECACHE_H
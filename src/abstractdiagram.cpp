@@ -36,9 +36,12 @@
 #include <cmath>
 
 #include <QApplication>
+#include <QGuiApplication>
 #include <QPainter>
+#include <QScreen>
 #include <QStyle>
 #include <QStyleOption>
+#include <QWindow>
 
 #include "helper.h"
 
@@ -49,7 +52,19 @@ namespace PerceptualColor
  * to the base class’s constructor. */
 AbstractDiagram::AbstractDiagram(QWidget *parent)
     : QWidget(parent)
+    , d_pointer(new AbstractDiagramPrivate)
 {
+    d_pointer->m_interactionTimer.setSingleShot(true);
+    d_pointer->m_interactionTimer.setInterval(AbstractDiagramPrivate::interactionPauseMilliseconds);
+    // Once the interaction pauses, coarse images that have been
+    // painted meanwhile have to be refined.
+    connect(&d_pointer->m_interactionTimer, &QTimer::timeout, this, [this]() {
+        update();
+    });
+    d_pointer->m_inputCoalescingTimer.setSingleShot(true);
+    connect(&d_pointer->m_inputCoalescingTimer, &QTimer::timeout, this, [this]() {
+        d_pointer->processPendingInput(this);
+    });
 }
 
 /** @brief Destructor */
@@ -278,4 +293,181 @@ QColor AbstractDiagram::handleColorFromBackgroundLightness(qreal lightness) cons
     return Qt::white;
 }
 
+/** @brief If an interaction is in progress.
+ *
+ * While the user drags a handle or holds down a key, the diagram is
+ * painted many times per second. Diagrams with expensive images can
+ * render coarse images meanwhile (progressive rendering) and refine
+ * them once the interaction pauses. When the interaction pauses, a
+ * repaint is scheduled automatically.
+ *
+ * @returns <tt>true</tt> if an interaction is in progress.
+ *
+ * @sa @ref registerInteraction()
+ * @sa @ref registerImageParameterChange() */
+bool AbstractDiagram::isInteractionInProgress() const
+{
+    return d_pointer->m_interactionTimer.isActive();
+}
+
+/** @brief Registers an interaction.
+ *
+ * Subclasses call this function on each step of a continuous
+ * interaction, like mouse moves while a handle is dragged, or
+ * auto-repeated key presses.
+ *
+ * @sa @ref isInteractionInProgress() */
+void AbstractDiagram::registerInteraction()
+{
+    d_pointer->m_interactionTimer.start();
+}
+
+/** @brief Registers a change of the parameters of the diagram image.
+ *
+ * Often, the image parameters of a diagram change because the user
+ * interacts with <em>another</em> widget, like the lightness slider
+ * in @ref ColorDialog. Subclasses call this function whenever the
+ * parameters of their image change. When changes follow each other
+ * quickly, this is considered to be an interaction.
+ *
+ * @sa @ref isInteractionInProgress() */
+void AbstractDiagram::registerImageParameterChange()
+{
+    if (d_pointer->m_imageParameterChangeTimer.isValid() //
+        && (d_pointer->m_imageParameterChangeTimer.elapsed() < AbstractDiagramPrivate::interactionPauseMilliseconds)) {
+        registerInteraction();
+    }
+    d_pointer->m_imageParameterChangeTimer.start();
+}
+
+/** @brief Bounding rectangle of a circular handle.
+ *
+ * Subclasses can use this to schedule paint events only for the area
+ * that a handle covers, instead of the whole widget.
+ *
+ * @param center The center of the handle, measured in
+ * <em>device-independant pixels</em>.
+ * @returns The smallest rectangle that contains a circular handle of
+ * @ref handleRadius() with an outline of @ref handleOutlineThickness(),
+ * including its anti-aliasing. Measured in
+ * <em>device-independant pixels</em>.
+ *
+ * @sa @ref lineBoundingRect() */
+QRect AbstractDiagram::circularHandleBoundingRect(const QPointF &center) const
+{
+    // One pixel additional margin for anti-aliasing:
+    const qreal radius = handleRadius() + handleOutlineThickness() / 2.0 + 1;
+    return QRectF(center.x() - radius, //
+                  center.y() - radius,
+                  2 * radius,
+                  2 * radius)
+        .toAlignedRect();
+}
+
+/** @brief Bounding rectangle of a line.
+ *
+ * Subclasses can use this to schedule paint events only for the area
+ * that a line handle covers, instead of the whole widget.
+ *
+ * @param start The start point of the line, measured in
+ * <em>device-independant pixels</em>.
+ * @param end The end point of the line, measured in
+ * <em>device-independant pixels</em>.
+ * @param lineWidth The width of the pen, measured in
+ * <em>device-independant pixels</em>.
+ * @returns The smallest rectangle that contains the line, including its
+ * anti-aliasing and any kind of cap style. Measured in
+ * <em>device-independant pixels</em>.
+ *
+ * @sa @ref circularHandleBoundingRect() */
+QRect AbstractDiagram::lineBoundingRect(const QPointF &start, const QPointF &end, const qreal lineWidth) const
+{
+    // One pixel additional margin for anti-aliasing:
+    const qreal margin = lineWidth / 2 + 1;
+    return QRectF(start, end) //
+        .normalized()
+        .adjusted(-margin, -margin, margin, margin)
+        .toAlignedRect();
+}
+
+/** @brief Processes input, but at most once per frame.
+ *
+ * Subclasses call this function for input that can arrive faster than
+ * the screen refreshes and is expensive to process, like mouse moves
+ * while a handle is dragged, or auto-repeated key presses.
+ *
+ * If no input has been processed within the current frame, the handler
+ * is called immediately. Otherwise, it is stored and called at the end
+ * of the frame. If meanwhile more input arrives, it replaces the stored
+ * handler: Only the most recent input is processed, intermediate input
+ * is dropped.
+ *
+ * @param handler The function that processes the input. It should
+ * capture all necessary data (like the mouse position) by value.
+ *
+ * @sa @ref discardPendingInput() */
+void AbstractDiagram::coalesceInput(const std::function<void()> &handler)
+{
+    if (d_pointer->m_inputCoalescingTimer.isActive()) {
+        d_pointer->m_pendingInput = handler;
+        return;
+    }
+    d_pointer->m_pendingInput = nullptr;
+    handler();
+    d_pointer->m_inputCoalescingTimer.start(AbstractDiagramPrivate::frameIntervalMilliseconds(this));
+}
+
+/** @brief Discards input that is waiting for processing.
+ *
+ * Subclasses call this function before processing input that
+ * must not be delayed, like a mouse release that defines the final
+ * position of a handle. Afterwards, they process this input directly.
+ *
+ * @sa @ref coalesceInput() */
+void AbstractDiagram::discardPendingInput()
+{
+    d_pointer->m_pendingInput = nullptr;
+}
+
+/** @brief The duration of a frame.
+ *
+ * @param widget The widget
+ * @returns The duration of a frame of the screen on which the widget is
+ * displayed, measured in milliseconds. If the refresh rate is not
+ * available, the duration of a frame at 60 Hz. */
+int AbstractDiagram::AbstractDiagramPrivate::frameIntervalMilliseconds(const QWidget *widget)
+{
+    const QWindow *window = widget->window()->windowHandle();
+    const QScreen *screen = (window != nullptr) //
+        ? window->screen()
+        : QGuiApplication::primaryScreen();
+    const qreal refreshRate = (screen != nullptr) //
+        ? screen->refreshRate()
+        : 0;
+    if (refreshRate <= 0) {
+        return 16;
+    }
+    return qMax(1, qRound(1000 / refreshRate));
+}
+
+/** @brief Processes the input that waits for processing, if any.
+ *
+ * Called at the end of each frame.
+ *
+ * @param widget The widget to which this private implementation belongs.
+ *
+ * @sa @ref coalesceInput() */
+void AbstractDiagram::AbstractDiagramPrivate::processPendingInput(const QWidget *widget)
+{
+    if (!m_pendingInput) {
+        return;
+    }
+    // The handler might call coalesceInput() again, so it
+    // is removed before it is called.
+    const std::function<void()> handler = m_pendingInput;
+    m_pendingInput = nullptr;
+    handler();
+    m_inputCoalescingTimer.start(frameIntervalMilliseconds(widget));
+}
+
 } // namespace PerceptualColor
@@ -33,6 +33,11 @@
 // Include the header of the public class of this private implementation.
 #include "PerceptualColor/abstractdiagram.h"
 
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include <functional>
+
 namespace PerceptualColor
 {
 /** @internal
@@ -50,6 +55,40 @@ public:
      * the class as a whole is <tt>final</tt>. */
     ~AbstractDiagramPrivate() noexcept = default;
 
+    /** @brief Time without interaction after which the interaction
+     * is considered to be paused, measured in milliseconds.
+     *
+     * @sa @ref m_interactionTimer */
+    static constexpr int interactionPauseMilliseconds = 200;
+    /** @brief Measures the time since the most recent change of
+     * image parameters.
+     *
+     * @sa @ref registerImageParameterChange() */
+    QElapsedTimer m_imageParameterChangeTimer;
+    /** @brief Single-shot timer that is active during one frame after
+     * an input has been processed.
+     *
+     * @sa @ref coalesceInput() */
+    QTimer m_inputCoalescingTimer;
+    /** @brief Single-shot timer that is active while an interaction
+     * is in progress.
+     *
+     * Each interaction restarts the timer. When it times out, the
+     * interaction is paused.
+     *
+     * @sa @ref isInteractionInProgress()
+     * @sa @ref registerInteraction() */
+    QTimer m_interactionTimer;
+    /** @brief The most recent input that is waiting for processing.
+     *
+     * An empty function if no input is waiting.
+     *
+     * @sa @ref coalesceInput() */
+    std::function<void()> m_pendingInput;
+
+    static int frameIntervalMilliseconds(const QWidget *widget);
+    void processPendingInput(const QWidget *widget);
+
 private:
     Q_DISABLE_COPY(AbstractDiagramPrivate)
 };
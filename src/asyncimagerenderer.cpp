@@ -0,0 +1,250 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "asyncimagerenderer.h"
+
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief The state that is shared between the renderer and its
+ * worker threads.
+ *
+ * The renderer might be destroyed while a worker thread is still
+ * running. Therefore, the workers do not access the renderer directly,
+ * but only through this reference-counted state. */
+struct AsyncImageRenderer::SharedState {
+    /** @brief Protects @ref owner. */
+    QMutex mutex;
+    /** @brief The renderer, or <tt>nullptr</tt> if it has been
+     * destroyed. */
+    AsyncImageRenderer *owner = nullptr;
+};
+
+/** @internal
+ *
+ * @brief Worker thread task that renders a single image. */
+class AsyncImageRenderer::RenderRunnable final : public QRunnable
+{
+public:
+    /** @brief Constructor
+     *
+     * @param state The shared state
+     * @param renderId The identifier of this render
+     * @param key The key of this render
+     * @param renderFunction The function that renders the image
+     * @param cancellationFlag The cancellation flag of this render */
+    RenderRunnable(const QSharedPointer<SharedState> &state,
+                   const quint64 renderId,
+                   const QByteArray &key,
+                   const RenderFunction &renderFunction,
+                   const QSharedPointer<QAtomicInt> &cancellationFlag)
+        : m_cancellationFlag(cancellationFlag)
+        , m_key(key)
+        , m_renderFunction(renderFunction)
+        , m_renderId(renderId)
+        , m_state(state)
+    {
+    }
+    /** @brief Renders the image and delivers it to the renderer. */
+    virtual void run() override
+    {
+        if (m_cancellationFlag->loadAcquire() != 0) {
+            return;
+        }
+        const QImage result = m_renderFunction(*m_cancellationFlag);
+        if ((m_cancellationFlag->loadAcquire() != 0) || result.isNull()) {
+            return;
+        }
+        // Posting the event while holding the lock guarantees that the
+        // owner is still alive. If it is destroyed afterwards, but before
+        // the event is processed, QObject drops the event.
+        QMutexLocker locker(&m_state->mutex);
+        AsyncImageRenderer *owner = m_state->owner;
+        if (owner == nullptr) {
+            return;
+        }
+        const quint64 renderId = m_renderId;
+        const QByteArray key = m_key;
+        QMetaObject::invokeMethod(
+            owner,
+            [owner, renderId, key, result]() {
+                owner->deliver(renderId, key, result);
+            },
+            Qt::QueuedConnection);
+    }
+
+private:
+    Q_DISABLE_COPY(RenderRunnable)
+    /** @brief The cancellation flag of this render */
+    QSharedPointer<QAtomicInt> m_cancellationFlag;
+    /** @brief The key of this render */
+    QByteArray m_key;
+    /** @brief The function that renders the image */
+    RenderFunction m_renderFunction;
+    /** @brief The identifier of this render */
+    quint64 m_renderId;
+    /** @brief The shared state */
+    QSharedPointer<SharedState> m_state;
+};
+
+/** @brief Constructor
+ *
+ * @param parent The parent object */
+AsyncImageRenderer::AsyncImageRenderer(QObject *parent)
+    : QObject(parent)
+    , m_sharedState(new SharedState)
+{
+    m_sharedState->owner = this;
+}
+
+/** @brief Destructor
+ *
+ * Cancels the render in progress. Does not wait for the worker
+ * thread to finish. */
+AsyncImageRenderer::~AsyncImageRenderer() noexcept
+{
+    if (!m_pendingCancellationFlag.isNull()) {
+        m_pendingCancellationFlag->storeRelease(1);
+    }
+    QMutexLocker locker(&m_sharedState->mutex);
+    m_sharedState->owner = nullptr;
+}
+
+/** @brief If the image for a given key is ready.
+ *
+ * @param key The key
+ *
+ * @returns <tt>true</tt> if @ref image() has been rendered for the
+ * given key. */
+bool AsyncImageRenderer::hasImage(const QByteArray &key) const
+{
+    return !m_image.isNull() && (m_imageKey == key);
+}
+
+/** @brief The most recent ready image.
+ *
+ * @returns The most recent ready image. This might be a stale image
+ * that does not correspond to the most recent request; see
+ * @ref isReady(). A null image if no image is ready yet. */
+QImage AsyncImageRenderer::image() const
+{
+    return m_image;
+}
+
+/** @brief If @ref image() corresponds to the most recent request.
+ *
+ * @returns <tt>true</tt> if @ref image() corresponds to the most recent
+ * request. <tt>false</tt> if a render is still in progress, or if there
+ * was no request yet. */
+bool AsyncImageRenderer::isReady() const
+{
+    return m_pendingCancellationFlag.isNull() && !m_image.isNull();
+}
+
+/** @brief Requests an image.
+ *
+ * @param key A key that contains all parameters that influence the
+ * image content.
+ * @param renderFunction The function that renders the image.
+ *
+ * @returns The best image that is available immediately:
+ * - If the image for this key is ready, this image is returned.
+ * - If there is no image at all yet (first request), the image is
+ *   rendered synchronously and returned. This way, widgets never
+ *   show an empty diagram.
+ * - Otherwise, the image is rendered asynchronously, and the most
+ *   recent ready (stale) image is returned. Once the new image is
+ *   ready, @ref imageReady() is emitted. */
+QImage AsyncImageRenderer::request(const QByteArray &key, const RenderFunction &renderFunction)
+{
+    if (m_pendingCancellationFlag.isNull()) {
+        if (!m_image.isNull() && (key == m_imageKey)) {
+            return m_image;
+        }
+    } else {
+        if (key == m_pendingKey) {
+            // Already in progress.
+            return m_image;
+        }
+        // The render in progress is stale.
+        m_pendingCancellationFlag->storeRelease(1);
+        m_pendingCancellationFlag.reset();
+        if (key == m_imageKey) {
+            // Back to the parameters of the ready image.
+            return m_image;
+        }
+    }
+
+    ++m_pendingRenderId;
+    if (m_image.isNull()) {
+        const QAtomicInt neverCancelled {0};
+        m_image = renderFunction(neverCancelled);
+        m_imageKey = key;
+        return m_image;
+    }
+
+    m_pendingCancellationFlag.reset(new QAtomicInt(0));
+    m_pendingKey = key;
+    QThreadPool::globalInstance()->start( //
+        new RenderRunnable(m_sharedState, //
+                           m_pendingRenderId,
+                           key,
+                           renderFunction,
+                           m_pendingCancellationFlag));
+    return m_image;
+}
+
+/** @brief Receives the result of a worker thread.
+ *
+ * @param renderId The identifier of the render
+ * @param key The key of the render
+ * @param image The rendered image */
+void AsyncImageRenderer::deliver(const quint64 renderId, const QByteArray &key, const QImage &image)
+{
+    if ((renderId != m_pendingRenderId) || m_pendingCancellationFlag.isNull()) {
+        // Stale result.
+        return;
+    }
+    m_pendingCancellationFlag.reset();
+    m_pendingKey.clear();
+    m_image = image;
+    m_imageKey = key;
+    Q_EMIT imageReady();
+}
+
+} // namespace PerceptualColor
@@ -0,0 +1,122 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ASYNCIMAGERENDERER_H
+#define ASYNCIMAGERENDERER_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QImage>
+#include <QObject>
+#include <QSharedPointer>
+
+#include <functional>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief Renders images on a worker thread.
+ *
+ * Rendering the images of the diagrams takes some time. When a widget
+ * renders within its paint event, the GUI thread is blocked meanwhile.
+ * This class renders instead on a worker thread. While the new image
+ * is not yet ready, the most recent ready image is provided, so that
+ * widgets can show it (maybe scaled) in the meantime.
+ *
+ * Each request is identified by a key, that must contain all parameters
+ * that influence the image content. When the key of a new request
+ * differs from the key of the render that is currently in progress, the
+ * render in progress is stale: It gets cancelled, and a new render
+ * starts.
+ *
+ * Usage:
+ * @snippet test/testasyncimagerenderer.cpp AsyncImageRenderer usage
+ *
+ * @note The render function is called on a worker thread. It must
+ * therefore not access the widget, but only use copies of the
+ * parameters (and thread-safe objects like @ref RgbColorSpace). */
+class AsyncImageRenderer final : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief A function that renders an image.
+     *
+     * The argument is the cancellation flag. When it becomes
+     * non-zero, the function should stop as soon as possible
+     * and return a null image. */
+    using RenderFunction = std::function<QImage(const QAtomicInt &isCancelled)>;
+
+    explicit AsyncImageRenderer(QObject *parent = nullptr);
+    virtual ~AsyncImageRenderer() noexcept override;
+    bool hasImage(const QByteArray &key) const;
+    QImage image() const;
+    bool isReady() const;
+    QImage request(const QByteArray &key, const RenderFunction &renderFunction);
+
+Q_SIGNALS:
+    /** @brief A new image is ready.
+     *
+     * Emitted when an asynchronous render has finished and
+     * @ref image() has changed. */
+    void imageReady();
+
+private:
+    Q_DISABLE_COPY(AsyncImageRenderer)
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestAsyncImageRenderer;
+
+    struct SharedState;
+    class RenderRunnable;
+
+    void deliver(const quint64 renderId, const QByteArray &key, const QImage &image);
+
+    /** @brief The most recent ready image. */
+    QImage m_image;
+    /** @brief The key of @ref m_image. */
+    QByteArray m_imageKey;
+    /** @brief Cancellation flag of the render in progress.
+     *
+     * A null pointer if no render is in progress. */
+    QSharedPointer<QAtomicInt> m_pendingCancellationFlag;
+    /** @brief The key of the render in progress. */
+    QByteArray m_pendingKey;
+    /** @brief The identifier of the render in progress.
+     *
+     * Results of other (older) renders are ignored. */
+    quint64 m_pendingRenderId = 0;
+    /** @brief State that is shared with the worker threads. */
+    QSharedPointer<SharedState> m_sharedState;
+};
+
+} // namespace PerceptualColor
+
+#endif // ASYNCIMAGERENDERER_H
@@ -34,6 +34,7 @@
 #include "chromahuediagram_p.h"
 
 #include "helper.h"
+#include "instrumentationscope.h"
 #include "lchvalues.h"
 #include "polarpointf.h"
 
@@ -41,6 +42,7 @@
 #include <QMouseEvent>
 #include <QPainter>
 #include <QStyle>
+#include <QThread>
 
 namespace PerceptualColor
 {
@@ -72,6 +74,19 @@ ChromaHueDiagram::ChromaHueDiagram(const QSharedPointer<PerceptualColor::RgbColo
     // Qt::FocusPolicy::TabFocus for QWidget::focusPolicy().
     setFocusPolicy(Qt::FocusPolicy::TabFocus);
 
+    // Repaint when an asynchronously rendered image gets ready.
+    connect(&d_pointer->m_chromaHueRenderer, &AsyncImageRenderer::imageReady, this, [this]() {
+        update();
+    });
+
+    // Forward throttled notifications.
+    connect(&d_pointer->m_colorChangeThrottle, &ColorChangeThrottle::throttledChange, this, [this]() {
+        Q_EMIT currentColorChangedThrottled(d_pointer->m_currentColor);
+    });
+    connect(&d_pointer->m_colorChangeThrottle, &ColorChangeThrottle::finished, this, [this]() {
+        Q_EMIT currentColorChangeFinished(d_pointer->m_currentColor);
+    });
+
     // Initialize the color
     setCurrentColor(LchValues::srgbVersatileInitialColor());
 }
@@ -125,6 +140,9 @@ void ChromaHueDiagram::mousePressEvent(QMouseEvent *event)
         setFocus(Qt::MouseFocusReason);
         // Enable mouse tracking from now on:
         d_pointer->m_isMouseEventActive = true;
+        // The press defines the position; older input is obsolete.
+        discardPendingInput();
+        d_pointer->m_isKeyInputPending = false;
         // As clicks are only accepted within the visible gamut, the mouse
         // cursor is made invisible. Its function is taken over by the
         // handle itself within the displayed gamut.
@@ -167,13 +185,21 @@ void ChromaHueDiagram::mouseMoveEvent(QMouseEvent *event)
 {
     if (d_pointer->m_isMouseEventActive) {
         event->accept();
-        const cmsCIELab lab = d_pointer->fromWidgetPixelPositionToLab(event->pos());
-        if (d_pointer->isWidgetPixelPositionWithinMouseSensibleCircle(event->pos()) && d_pointer->m_rgbColorSpace->isInGamut(lab)) {
-            setCursor(Qt::BlankCursor);
-        } else {
-            unsetCursor();
-        }
-        d_pointer->setColorFromWidgetPixelPosition(event->pos());
+        registerInteraction();
+        // Gamut tests are expensive. Mouse moves can arrive much faster
+        // than the screen refreshes, so only the most recent position is
+        // processed once per frame.
+        d_pointer->m_isKeyInputPending = false;
+        const QPoint position = event->pos();
+        coalesceInput([this, position]() {
+            const cmsCIELab lab = d_pointer->fromWidgetPixelPositionToLab(position);
+            if (d_pointer->isWidgetPixelPositionWithinMouseSensibleCircle(position) && d_pointer->m_rgbColorSpace->isInGamut(lab)) {
+                setCursor(Qt::BlankCursor);
+            } else {
+                unsetCursor();
+            }
+            d_pointer->setColorFromWidgetPixelPosition(position);
+        });
     } else {
         // Make sure default behavior like drag-window in KDE’s
         // Breeze widget style works.
@@ -210,7 +236,14 @@ void ChromaHueDiagram::mouseReleaseEvent(QMouseEvent *event)
         event->accept();
         unsetCursor();
         d_pointer->m_isMouseEventActive = false;
+        // The final position is processed immediately and exactly,
+        // replacing input that is still waiting for processing.
+        discardPendingInput();
+        d_pointer->m_isKeyInputPending = false;
         d_pointer->setColorFromWidgetPixelPosition(event->pos());
+        // The interaction has finished; there is no need to wait until
+        // the color comes to rest.
+        d_pointer->m_colorChangeThrottle.finish();
         // Schedule a paint event, so that the wheel handle will be hidden.
         // It’s not enough to hope setColorFromWidgetCoordinates() would do
         // this, because setColorFromWidgetCoordinates() would not update the
@@ -291,7 +324,11 @@ void ChromaHueDiagram::wheelEvent(QWheelEvent *event)
  * are likely that the user tries them out by trial-and-error. */
 void ChromaHueDiagram::keyPressEvent(QKeyEvent *event)
 {
-    LchDouble newColor = currentColor();
+    // If a key press is still waiting for processing, this key press
+    // adds to it, so that no step gets lost.
+    LchDouble newColor = d_pointer->m_isKeyInputPending //
+        ? d_pointer->m_pendingKeyColor
+        : currentColor();
     switch (event->key()) {
     case Qt::Key_Up:
         newColor.c += singleStepChroma;
@@ -339,10 +376,24 @@ void ChromaHueDiagram::keyPressEvent(QKeyEvent *event)
         // (Doing so would be counter-intuitive.)
         newColor.c = 0;
     }
-    // Move the value into gamut (if necessary):
-    newColor = d_pointer->m_rgbColorSpace->nearestInGamutColorByAdjustingChroma(newColor);
-    // Apply the new value:
-    setCurrentColor(newColor);
+    if (event->isAutoRepeat()) {
+        registerInteraction();
+        // Auto-repeated key presses can arrive faster than the screen
+        // refreshes, so they are processed at most once per frame.
+        d_pointer->m_pendingKeyColor = newColor;
+        d_pointer->m_isKeyInputPending = true;
+        coalesceInput([this, newColor]() {
+            d_pointer->m_isKeyInputPending = false;
+            // Move the value into gamut (if necessary) and apply it:
+            setCurrentColor(d_pointer->m_rgbColorSpace->nearestInGamutColorByAdjustingChroma(newColor));
+        });
+    } else {
+        // A single key press is processed immediately.
+        discardPendingInput();
+        d_pointer->m_isKeyInputPending = false;
+        // Move the value into gamut (if necessary) and apply it:
+        setCurrentColor(d_pointer->m_rgbColorSpace->nearestInGamutColorByAdjustingChroma(newColor));
+    }
 }
 
 /** @brief Recommmended size for the widget.
@@ -392,19 +443,69 @@ void ChromaHueDiagram::setCurrentColor(const LchDouble &newCurrentColor)
     }
 
     LchDouble oldColor = d_pointer->m_currentColor;
+    const QRegion oldHandleRegion = d_pointer->handleRegion();
 
     d_pointer->m_currentColor = newCurrentColor;
 
-    // Update, if necessary, the diagram.
+    // Schedule a paint event:
     if (d_pointer->m_currentColor.l != oldColor.l) {
+        // Update the diagram:
         d_pointer->m_chromaHueImage.setLightness(d_pointer->m_currentColor.l);
+        registerImageParameterChange();
+        update();
+    } else {
+        // Only the handle has moved:
+        update(oldHandleRegion + d_pointer->handleRegion());
     }
 
-    // Schedule a paint event:
-    update();
-
     // Emit notify signal
     Q_EMIT currentColorChanged(newCurrentColor);
+    LchaDouble throttleColor;
+    throttleColor.l = newCurrentColor.l;
+    throttleColor.c = newCurrentColor.c;
+    throttleColor.h = newCurrentColor.h;
+    throttleColor.a = 1;
+    d_pointer->m_colorChangeThrottle.registerChange(throttleColor);
+}
+
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal ChromaHueDiagram::throttledNotificationDeltaE() const
+{
+    return d_pointer->m_colorChangeThrottle.minimumDeltaE();
+}
+
+/** @brief Setter for the @ref throttledNotificationDeltaE property.
+ *
+ * @param newThrottledNotificationDeltaE the new value */
+void ChromaHueDiagram::setThrottledNotificationDeltaE(const qreal newThrottledNotificationDeltaE)
+{
+    const qreal oldValue = d_pointer->m_colorChangeThrottle.minimumDeltaE();
+    d_pointer->m_colorChangeThrottle.setMinimumDeltaE(newThrottledNotificationDeltaE);
+    if (d_pointer->m_colorChangeThrottle.minimumDeltaE() != oldValue) {
+        Q_EMIT throttledNotificationDeltaEChanged( //
+            d_pointer->m_colorChangeThrottle.minimumDeltaE());
+    }
+}
+
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal ChromaHueDiagram::throttledNotificationRate() const
+{
+    return d_pointer->m_colorChangeThrottle.maximumRate();
+}
+
+/** @brief Setter for the @ref throttledNotificationRate property.
+ *
+ * @param newThrottledNotificationRate the new value */
+void ChromaHueDiagram::setThrottledNotificationRate(const qreal newThrottledNotificationRate)
+{
+    const qreal oldValue = d_pointer->m_colorChangeThrottle.maximumRate();
+    d_pointer->m_colorChangeThrottle.setMaximumRate(newThrottledNotificationRate);
+    if (d_pointer->m_colorChangeThrottle.maximumRate() != oldValue) {
+        Q_EMIT throttledNotificationRateChanged( //
+            d_pointer->m_colorChangeThrottle.maximumRate());
+    }
 }
 
 /** @brief The point that is the center of the diagram coordinate system.
@@ -470,6 +571,47 @@ QPointF ChromaHueDiagram::ChromaHueDiagramPrivate::widgetCoordinatesFromCurrentC
         diagramOffset() - currentColor.y() * scaleFactor);
 }
 
+/** @brief The handle on the color wheel.
+ *
+ * @returns The line of the handle on the surrounding color wheel,
+ * measured in widget coordinates. This handle is only visible while
+ * a mouse event is active; see @ref m_isMouseEventActive. */
+QLineF ChromaHueDiagram::ChromaHueDiagramPrivate::wheelHandleLine() const
+{
+    // The radius of the outer border of the color wheel
+    const qreal radius = q_pointer->maximumWidgetSquareSize() / static_cast<qreal>(2) - q_pointer->spaceForFocusIndicator();
+    // Get widget coordinate point for the handle
+    QPointF myHandleInner = PolarPointF(radius - q_pointer->gradientThickness(), m_currentColor.h).toCartesian();
+    myHandleInner.ry() *= -1; // Transform to Widget coordinate points
+    myHandleInner += diagramCenter();
+    QPointF myHandleOuter = PolarPointF(radius, m_currentColor.h).toCartesian();
+    myHandleOuter.ry() *= -1; // Transform to Widget coordinate points
+    myHandleOuter += diagramCenter();
+    return QLineF(myHandleInner, myHandleOuter);
+}
+
+/** @brief The area covered by the handles.
+ *
+ * @returns The area covered by the handle within the gamut, by the line
+ * from the center of the diagram to this handle, and (if visible) by
+ * the handle on the color wheel, measured in widget coordinates. When
+ * only the handles move, only this area has to be repainted. */
+QRegion ChromaHueDiagram::ChromaHueDiagramPrivate::handleRegion() const
+{
+    const QPointF handleCenter = widgetCoordinatesFromCurrentColor();
+    QRegion result = q_pointer->circularHandleBoundingRect(handleCenter);
+    result += q_pointer->lineBoundingRect(diagramCenter(), //
+                                          handleCenter,
+                                          q_pointer->handleOutlineThickness());
+    if (m_isMouseEventActive) {
+        const QLineF wheelHandle = wheelHandleLine();
+        result += q_pointer->lineBoundingRect(wheelHandle.p1(), //
+                                              wheelHandle.p2(),
+                                              q_pointer->handleOutlineThickness());
+    }
+    return result;
+}
+
 /** @brief Converts widget pixel positions to Lab coordinates
  * @param position The position of a pixel of the widget coordinate
  * system. The given value  does not necessarily need to
@@ -585,34 +727,22 @@ bool ChromaHueDiagram::ChromaHueDiagramPrivate::isWidgetPixelPositionWithinMouse
 void ChromaHueDiagram::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
-
-    // We do not paint directly on the widget, but on a QImage buffer first:
-    // Render anti-aliased looks better. But as Qt documentation says:
-    //
-    //      “Renderhints are used to specify flags to QPainter that may or
-    //       may not be respected by any given engine.”
-    //
-    // Painting here directly on the widget might lead to different
-    // anti-aliasing results depending on the underlying window system. This
-    // is especially problematic as anti-aliasing might shift or not a pixel
-    // to the left or to the right. So we paint on a QImage first. As QImage
-    // (at difference to QPixmap and a QWidget) is independent of native
-    // platform rendering, it guarantees identical anti-aliasing results on
-    // all platforms. Here the quote from QPainter class documentation:
+    const InstrumentationScope instrumentationScope("ChromaHueDiagram::paintEvent");
+    // The static layer (gamut image and the color wheel around) is
+    // composited on a QImage buffer and cached as QPixmap, so that it can
+    // be blitted fast. It is only rebuilt when one of the images changes;
+    // when only the handle moves, it is reused. We compose it on a QImage
+    // because, as Qt documentation says:
     //
     //      “To get the optimal rendering result using QPainter, you should
     //       use the platform independent QImage as paint device; i.e. using
     //       QImage will ensure that the result has an identical pixel
     //       representation on any platform.”
-    QImage buffer(maximumPhysicalSquareSize(),        // width
-                  maximumPhysicalSquareSize(),        // height
-                  QImage::Format_ARGB32_Premultiplied // format
-    );
-    buffer.fill(Qt::transparent);
-    buffer.setDevicePixelRatio(devicePixelRatioF());
+    //
+    // Handles and focus indicator are painted directly over the
+    // static layer.
 
     // Other initialization
-    QPainter bufferPainter(&buffer);
     QPen pen;
     const QBrush transparentBrush {Qt::transparent};
     // Set color of the handle: Black or white, depending on the lightness of
@@ -620,8 +750,7 @@ void ChromaHueDiagram::paintEvent(QPaintEvent *event)
     const QColor handleColor {handleColorFromBackgroundLightness(d_pointer->m_currentColor.l)};
     const QPointF widgetCoordinatesFromCurrentColor {d_pointer->widgetCoordinatesFromCurrentColor()};
 
-    // Paint the gamut itself as available in the cache.
-    bufferPainter.setRenderHint(QPainter::Antialiasing, false);
+    // Get the gamut image as available in the cache.
     // As devicePixelRatioF() might have changed, we make sure everything
     // that might depend on devicePixelRatioF() is updated before painting.
     d_pointer->m_chromaHueImage.setBorder(d_pointer->diagramBorder() * devicePixelRatioF());
@@ -629,34 +758,89 @@ void ChromaHueDiagram::paintEvent(QPaintEvent *event)
     d_pointer->m_chromaHueImage.setChromaRange(d_pointer->m_rgbColorSpace->maximumChroma());
     d_pointer->m_chromaHueImage.setLightness(d_pointer->m_currentColor.l);
     d_pointer->m_chromaHueImage.setDevicePixelRatioF(devicePixelRatioF());
-    bufferPainter.drawImage(QPoint(0, 0),                          // position of the image
-                            d_pointer->m_chromaHueImage.getImage() // image
-    );
-
-    // Paint a color wheel around
-    bufferPainter.setRenderHint(QPainter::Antialiasing, false);
+    // Progressive rendering: While an interaction is in progress, a
+    // coarse image is rendered, unless the full-resolution image for
+    // the current parameters is available anyway.
+    int resolutionDivisor = 1;
+    d_pointer->m_chromaHueImage.setResolutionDivisor(resolutionDivisor);
+    if (isInteractionInProgress() && !d_pointer->m_chromaHueRenderer.hasImage(d_pointer->m_chromaHueImage.cacheKey())) {
+        resolutionDivisor = interactiveResolutionDivisor;
+        d_pointer->m_chromaHueImage.setResolutionDivisor(resolutionDivisor);
+    }
+    // The image is rendered on a worker thread. The render function
+    // must therefore not access this widget, but only copies of the
+    // parameters.
+    const QSharedPointer<RgbColorSpace> colorSpace = d_pointer->m_rgbColorSpace;
+    const qreal border = d_pointer->diagramBorder() * devicePixelRatioF();
+    const int imageSize = maximumPhysicalSquareSize();
+    const qreal chromaRange = d_pointer->m_rgbColorSpace->maximumChroma();
+    const qreal lightness = d_pointer->m_currentColor.l;
+    const qreal devicePixelRatio = devicePixelRatioF();
+    auto renderFunction = [colorSpace, border, imageSize, chromaRange, lightness, devicePixelRatio, resolutionDivisor](const QAtomicInt &isCancelled) {
+        ChromaHueImage image(colorSpace);
+        image.setBorder(border);
+        image.setImageSize(imageSize);
+        image.setChromaRange(chromaRange);
+        image.setLightness(lightness);
+        image.setDevicePixelRatioF(devicePixelRatio);
+        image.setResolutionDivisor(resolutionDivisor);
+        // The image has to be rendered again whenever the lightness
+        // changes, which happens continuously while the user drags a
+        // lightness slider. Use all available processor cores for this.
+        image.setThreadCount(QThread::idealThreadCount());
+        image.setCancellationFlag(&isCancelled);
+        return image.getImage();
+    };
+    // While a new image is rendered, the renderer provides the most
+    // recent ready image, which might have a different size. Therefore,
+    // it is always drawn into the full target rectangle.
+    const QImage chromaHueImage = d_pointer->m_chromaHueRenderer.request( //
+        d_pointer->m_chromaHueImage.cacheKey(),
+        renderFunction);
+
+    // Get the color wheel around.
     // As devicePixelRatioF() might have changed, we make sure everything
     // that might depend on devicePixelRatioF() is updated before painting.
     d_pointer->m_wheelImage.setBorder(spaceForFocusIndicator() * devicePixelRatioF());
     d_pointer->m_wheelImage.setDevicePixelRatioF(devicePixelRatioF());
     d_pointer->m_wheelImage.setImageSize(maximumPhysicalSquareSize());
     d_pointer->m_wheelImage.setWheelThickness(gradientThickness() * devicePixelRatioF());
-    bufferPainter.drawImage(QPoint(0, 0),                      // position of the image
-                            d_pointer->m_wheelImage.getImage() // the image itself
-    );
+    const QImage wheelImage = d_pointer->m_wheelImage.getImage();
+
+    // Rebuild the static layer if necessary.
+    if ((chromaHueImage.cacheKey() != d_pointer->m_staticLayerChromaHueKey) //
+        || (wheelImage.cacheKey() != d_pointer->m_staticLayerWheelKey)) {
+        QImage buffer(imageSize,                          // width
+                      imageSize,                          // height
+                      QImage::Format_ARGB32_Premultiplied // format
+        );
+        buffer.fill(Qt::transparent);
+        buffer.setDevicePixelRatio(devicePixelRatio);
+        QPainter bufferPainter(&buffer);
+        bufferPainter.setRenderHint(QPainter::Antialiasing, false);
+        const qreal logicalImageSize = imageSize / devicePixelRatio;
+        bufferPainter.drawImage(QRectF(0, 0, logicalImageSize, logicalImageSize), // target rectangle
+                                chromaHueImage                                    // image
+        );
+        bufferPainter.drawImage(QPoint(0, 0), // position of the image
+                                wheelImage    // the image itself
+        );
+        bufferPainter.end();
+        d_pointer->m_staticLayer = QPixmap::fromImage(buffer);
+        d_pointer->m_staticLayerChromaHueKey = chromaHueImage.cacheKey();
+        d_pointer->m_staticLayerWheelKey = wheelImage.cacheKey();
+    }
+
+    // Paint the static layer to the actual widget. (The painter is
+    // clipped to the paint event’s region, so when only the handle has
+    // moved, only the area of the handle is copied.)
+    QPainter widgetPainter(this);
+    widgetPainter.setRenderHint(QPainter::Antialiasing, false);
+    widgetPainter.drawPixmap(QPoint(0, 0), d_pointer->m_staticLayer);
 
     // Paint a handle on the color wheel (only if a mouse event is
     // currently active).
     if (d_pointer->m_isMouseEventActive) {
-        // The radius of the outer border of the color wheel
-        const qreal radius = maximumWidgetSquareSize() / static_cast<qreal>(2) - spaceForFocusIndicator();
-        // Get widget coordinate point for the handle
-        QPointF myHandleInner = PolarPointF(radius - gradientThickness(), d_pointer->m_currentColor.h).toCartesian();
-        myHandleInner.ry() *= -1; // Transform to Widget coordinate points
-        myHandleInner += d_pointer->diagramCenter();
-        QPointF myHandleOuter = PolarPointF(radius, d_pointer->m_currentColor.h).toCartesian();
-        myHandleOuter.ry() *= -1; // Transform to Widget coordinate points
-        myHandleOuter += d_pointer->diagramCenter();
         // Draw the line
         pen = QPen();
         pen.setWidth(handleOutlineThickness());
@@ -665,20 +849,20 @@ void ChromaHueDiagram::paintEvent(QPaintEvent *event)
         // of the wheel. But: Is it really worth the complexity?
         pen.setCapStyle(Qt::FlatCap);
         pen.setColor(handleColor);
-        bufferPainter.setPen(pen);
-        bufferPainter.setRenderHint(QPainter::Antialiasing, true);
-        bufferPainter.drawLine(myHandleInner, myHandleOuter);
+        widgetPainter.setPen(pen);
+        widgetPainter.setRenderHint(QPainter::Antialiasing, true);
+        widgetPainter.drawLine(d_pointer->wheelHandleLine());
     }
 
     // Paint the handle within the gamut
-    bufferPainter.setRenderHint(QPainter::Antialiasing, true);
+    widgetPainter.setRenderHint(QPainter::Antialiasing, true);
     pen = QPen();
     pen.setWidth(handleOutlineThickness());
     pen.setColor(handleColor);
     pen.setCapStyle(Qt::RoundCap);
-    bufferPainter.setPen(pen);
-    bufferPainter.setBrush(transparentBrush);
-    bufferPainter.drawEllipse(widgetCoordinatesFromCurrentColor, // center
+    widgetPainter.setPen(pen);
+    widgetPainter.setBrush(transparentBrush);
+    widgetPainter.drawEllipse(widgetCoordinatesFromCurrentColor, // center
                               handleRadius(),                    // x radius
                               handleRadius()                     // y radius
     );
@@ -691,7 +875,7 @@ void ChromaHueDiagram::paintEvent(QPaintEvent *event)
         QPointF lineEndWidgetCoordinates = PolarPointF(lineRadial, diagramPolarCoordinatesFromCurrentColor.angleDegree()).toCartesian();
         lineEndWidgetCoordinates.ry() *= (-1);
         lineEndWidgetCoordinates += d_pointer->diagramCenter();
-        bufferPainter.drawLine(
+        widgetPainter.drawLine(
             // point 1 (center of the diagram):
             d_pointer->diagramCenter(),
             // point 2:
@@ -728,13 +912,13 @@ void ChromaHueDiagram::paintEvent(QPaintEvent *event)
     // accommodates also to handleRadius(), the distance of the focus line to
     // the real widget also does, which looks nice.
     if (hasFocus()) {
-        bufferPainter.setRenderHint(QPainter::Antialiasing, true);
+        widgetPainter.setRenderHint(QPainter::Antialiasing, true);
         pen = QPen();
         pen.setWidth(handleOutlineThickness());
         pen.setColor(focusIndicatorColor());
-        bufferPainter.setPen(pen);
-        bufferPainter.setBrush(transparentBrush);
-        bufferPainter.drawEllipse(
+        widgetPainter.setPen(pen);
+        widgetPainter.setBrush(transparentBrush);
+        widgetPainter.drawEllipse(
             // center:
             d_pointer->diagramCenter(),
             // x radius:
@@ -742,11 +926,6 @@ void ChromaHueDiagram::paintEvent(QPaintEvent *event)
             // y radius:
             d_pointer->diagramOffset() - handleOutlineThickness() / 2.0);
     }
-
-    // Paint the buffer to the actual widget
-    QPainter widgetPainter(this);
-    widgetPainter.setRenderHint(QPainter::Antialiasing, false);
-    widgetPainter.drawImage(QPoint(0, 0), buffer);
 }
 
 /** @brief The border around the round diagram.
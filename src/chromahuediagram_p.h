@@ -33,11 +33,17 @@
 // Include the header of the public class of this private implementation.
 #include "PerceptualColor/chromahuediagram.h"
 
+#include "asyncimagerenderer.h"
 #include "chromahueimage.h"
+#include "colorchangethrottle.h"
 #include "colorwheelimage.h"
 #include "constpropagatingrawpointer.h"
 #include "lchvalues.h"
 
+#include <QLineF>
+#include <QPixmap>
+#include <QRegion>
+
 namespace PerceptualColor
 {
 /** @internal
@@ -65,10 +71,24 @@ public:
     ~ChromaHueDiagramPrivate() noexcept = default;
 
     // Member variables
-    /** @brief The image of the chroma-hue diagram itself. */
+    /** @brief The image of the chroma-hue diagram itself.
+     *
+     * This object holds the current parameters of the image. The image
+     * itself is rendered by @ref m_chromaHueRenderer. */
     ChromaHueImage m_chromaHueImage;
+    /** @brief Renders @ref m_chromaHueImage on a worker thread. */
+    AsyncImageRenderer m_chromaHueRenderer;
+    /** @brief Throttles the notifications about color changes.
+     *
+     * @sa @ref throttledNotificationRate
+     * @sa @ref throttledNotificationDeltaE */
+    ColorChangeThrottle m_colorChangeThrottle;
     /** @brief Internal storage of the @ref currentColor() property */
     LchDouble m_currentColor;
+    /** @brief If a key press is waiting for processing.
+     *
+     * @sa @ref m_pendingKeyColor */
+    bool m_isKeyInputPending = false;
     /** @brief Holds if currently a mouse event is active or not.
      *
      * Default value is <tt>false</tt>.
@@ -85,9 +105,30 @@ public:
      * circular widget, only reacting on mouse events within the circle;
      * this requires this custom implementation. */
     bool m_isMouseEventActive = false;
+    /** @brief The color that a key press, which is waiting for
+     * processing, will set (before moving it into the gamut).
+     *
+     * Only valid if @ref m_isKeyInputPending is <tt>true</tt>. */
+    LchDouble m_pendingKeyColor;
     /** @brief Pointer to @ref RgbColorSpace object used to describe the
      * color space. */
     QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace;
+    /** @brief Cache for the static layer of the widget.
+     *
+     * The static layer is the chroma-hue image composited with the
+     * color wheel around it. It does not contain the handles or the focus
+     * indicator, which are painted over it. It is only rebuilt when one
+     * of the images changes.
+     *
+     * @sa @ref m_staticLayerChromaHueKey
+     * @sa @ref m_staticLayerWheelKey */
+    QPixmap m_staticLayer;
+    /** @brief <tt>QImage::cacheKey()</tt> of the chroma-hue image
+     * within @ref m_staticLayer. */
+    qint64 m_staticLayerChromaHueKey = 0;
+    /** @brief <tt>QImage::cacheKey()</tt> of the wheel image
+     * within @ref m_staticLayer. */
+    qint64 m_staticLayerWheelKey = 0;
     /** @brief The image of the color wheel. */
     ColorWheelImage m_wheelImage;
 
@@ -96,8 +137,10 @@ public:
     QPointF diagramCenter() const;
     qreal diagramOffset() const;
     cmsCIELab fromWidgetPixelPositionToLab(const QPoint position) const;
+    QRegion handleRegion() const;
     bool isWidgetPixelPositionWithinMouseSensibleCircle(const QPoint widgetCoordinates) const;
     void setColorFromWidgetPixelPosition(const QPoint position);
+    QLineF wheelHandleLine() const;
     QPointF widgetCoordinatesFromCurrentColor() const;
 
 private:
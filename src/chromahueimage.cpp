@@ -31,10 +31,18 @@
 // First the interface, which forces the header to be self-contained.
 #include "chromahueimage.h"
 
+#include "PerceptualColor/imagediskcache.h"
+#include "PerceptualColor/sharedimagecache.h"
 #include "helper.h"
+#include "instrumentationscope.h"
 #include "lchvalues.h"
+#include "parallelrows.h"
+#include "rgbdouble.h"
+#include "scanlinewriter.h"
 
+#include <QDataStream>
 #include <QPainter>
+#include <QVector>
 #include <QtMath>
 
 namespace PerceptualColor
@@ -152,6 +160,77 @@ void ChromaHueImage::setChromaRange(const qreal newChromaRange)
     }
 }
 
+/** @brief Setter for the resolution divisor property.
+ *
+ * For progressive rendering: While the user interacts with a widget,
+ * a coarse image that is available quickly is often preferable to an
+ * exact image that takes long to render. With a resolution divisor of
+ * <tt>n</tt>, the image is rendered with only <tt>1/n</tt> of the
+ * resolution in each direction and then scaled up to the full image
+ * size. The result is blurry, but with a divisor of <tt>2</tt>, only
+ * a quarter of the pixels has to be calculated. Coarse images are
+ * neither stored in nor loaded from @ref SharedImageCache and
+ * @ref ImageDiskCache.
+ *
+ * The default value is <tt>1</tt> which means full resolution.
+ *
+ * @param newResolutionDivisor The new resolution divisor. Values smaller
+ * than <tt>1</tt> are treated as <tt>1</tt>. */
+void ChromaHueImage::setResolutionDivisor(const int newResolutionDivisor)
+{
+    const int temp = qMax(1, newResolutionDivisor);
+    if (m_resolutionDivisor != temp) {
+        m_resolutionDivisor = temp;
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
+/** @brief Setter for the thread count property.
+ *
+ * The rows of the image are distributed across this number of threads
+ * (see @ref ParallelRows). The rendered image is identical, regardless
+ * of the thread count. Therefore, changing this property does not
+ * invalidate the cache.
+ *
+ * You can set this to <tt>QThread::idealThreadCount()</tt> to use all
+ * available processor cores.
+ *
+ * The default value is <tt>1</tt> which means that the image is rendered
+ * sequentially within the calling thread.
+ *
+ * @param newThreadCount The new thread count. Values smaller
+ * than <tt>1</tt> are treated as <tt>1</tt>. */
+void ChromaHueImage::setThreadCount(const int newThreadCount)
+{
+    m_threadCount = qMax(1, newThreadCount);
+}
+
+/** @brief Setter for the cancellation flag.
+ *
+ * Allows to cancel @ref getImage() from another thread: When the flag
+ * becomes non-zero while @ref getImage() is running, it stops as soon
+ * as possible and returns a null image. (Cancelled renders are not
+ * cached.)
+ *
+ * @param newCancellationFlag Pointer to the cancellation flag. It must
+ * stay valid while @ref getImage() is running. <tt>nullptr</tt> means
+ * that @ref getImage() cannot be cancelled. This is the default. */
+void ChromaHueImage::setCancellationFlag(const QAtomicInt *newCancellationFlag)
+{
+    m_cancellationFlag = newCancellationFlag;
+}
+
+/** @brief If the current render has been cancelled.
+ *
+ * @returns If the current render has been cancelled.
+ *
+ * @sa @ref setCancellationFlag() */
+bool ChromaHueImage::isCancelled() const
+{
+    return (m_cancellationFlag != nullptr) && (m_cancellationFlag->loadAcquire() != 0);
+}
+
 /** @brief Delivers an image of the chroma hue plane.
  *
  * @returns Delivers a square image of the chroma hue plane. It consists
@@ -169,6 +248,50 @@ QImage ChromaHueImage::getImage()
         return m_image;
     }
 
+    const InstrumentationScope instrumentationScope("ChromaHueImage::getImage");
+
+    // Progressive rendering: Render an image with reduced
+    // resolution and scale it up to the full image size.
+    if (m_resolutionDivisor > 1) {
+        ChromaHueImage coarseImage(m_rgbColorSpace);
+        coarseImage.setImageSize(qCeil(static_cast<qreal>(m_imageSizePhysical) / m_resolutionDivisor));
+        coarseImage.setBorder(m_borderPhysical / m_resolutionDivisor);
+        coarseImage.setChromaRange(m_chromaRange);
+        coarseImage.setLightness(m_lightness);
+        coarseImage.setThreadCount(m_threadCount);
+        coarseImage.setCancellationFlag(m_cancellationFlag);
+        coarseImage.m_useCaches = false;
+        const QImage coarse = coarseImage.getImage();
+        if (coarse.isNull()) {
+            // Cancelled (or empty image size)
+            m_image = QImage();
+            return m_image;
+        }
+        m_image = coarse.scaled(m_imageSizePhysical, //
+                                m_imageSizePhysical,
+                                Qt::IgnoreAspectRatio,
+                                Qt::SmoothTransformation);
+        m_image.setDevicePixelRatio(m_devicePixelRatioF);
+        return m_image;
+    }
+
+    const QByteArray key = m_useCaches ? cacheKey() : QByteArray();
+    if (m_useCaches) {
+        // Try the process-wide shared cache.
+        m_image = SharedImageCache::find(key);
+        if (!m_image.isNull()) {
+            return m_image;
+        }
+
+        // Try the persistent disk cache.
+        m_image = ImageDiskCache::load(key);
+        if (!m_image.isNull()) {
+            m_image.setDevicePixelRatio(m_devicePixelRatioF);
+            SharedImageCache::insert(key, m_image);
+            return m_image;
+        }
+    }
+
     // If no image is in cache, create a new one (in the cache) with
     // correct image size.
     m_image = QImage(QSize(m_imageSizePhysical, m_imageSizePhysical), QImage::Format_ARGB32_Premultiplied);
@@ -191,22 +314,21 @@ QImage ChromaHueImage::getImage()
     m_image.fill(m_rgbColorSpace->toQColorRgbBound(LchValues::neutralGray()));
 
     // Prepare for gamut painting
-    cmsCIELab lab;
-    lab.L = m_lightness;
-    int x;
-    int y;
-    QColor tempColor;
     const qreal scaleFactor = static_cast<qreal>(2 * m_chromaRange)
         // The following line will never be 0 because we have have
         // tested above that circleRadius is > 0, so this line will
         // we > 0 also.
         / (m_imageSizePhysical - 2 * m_borderPhysical);
+    // The rows are rendered in parallel. The image has been detached
+    // yet by fill(), so the threads can safely write to the scanlines.
+    uchar *const imageBits = m_image.bits();
+    const int bytesPerLine = m_image.bytesPerLine();
 
     // Paint the gamut.
-    // The pixel at position QPoint(x, y) is the square with the top-left
-    // edge at coordinate point QPoint(x, y) and the botton-right edge at
-    // coordinate point QPoint(x+1, y+1). This pixel is supposed to have
-    // the color from coordinate point QPoint(x+0.5, y+0.5), which is
+    // The pixel at position QPoint(x, y) is the square with the top-left
+    // edge at coordinate point QPoint(x, y) and the botton-right edge at
+    // coordinate point QPoint(x+1, y+1). This pixel is supposed to have
+    // the color from coordinate point QPoint(x+0.5, y+0.5), which is
     // the middle of this pixel. Therefore, with an offset of 0.5 we can
     // convert from the pixel position to the point in the middle of the pixel.
     constexpr qreal pixelOffset = 0.5;
@@ -215,18 +337,44 @@ QImage ChromaHueImage::getImage()
     // tolerance)? Tought anyway the color transform (which is the heavy
     // work) is only done when within a given diameter, reducing loop runs
     // itself might also increase performance at least a little bit…
-    for (y = 0; y < m_imageSizePhysical; ++y) {
+    auto paintRow = [this, scaleFactor, imageBits, bytesPerLine](const int y) {
+        if (isCancelled()) {
+            return;
+        }
+        // Buffers for the row-by-row conversion: All pixels of a row, that
+        // are within the circle, are collected and then converted within
+        // a single call to the color space.
+        QVector<cmsCIELab> labBuffer(m_imageSizePhysical);
+        QVector<int> xBuffer(m_imageSizePhysical);
+        QVector<RgbDouble> rgbBuffer(m_imageSizePhysical);
+        QVector<bool> isInGamutBuffer(m_imageSizePhysical);
+        cmsCIELab lab;
+        lab.L = m_lightness;
         lab.b = m_chromaRange - (y + pixelOffset - m_borderPhysical) * scaleFactor;
-        for (x = 0; x < m_imageSizePhysical; ++x) {
+        int count = 0;
+        for (int x = 0; x < m_imageSizePhysical; ++x) {
             lab.a = (x + pixelOffset - m_borderPhysical) * scaleFactor - m_chromaRange;
             if ((qPow(lab.a, 2) + qPow(lab.b, 2)) <= (qPow(m_chromaRange + overlap, 2))) {
-                tempColor = m_rgbColorSpace->toQColorRgbUnbound(lab);
-                if (tempColor.isValid()) {
-                    // The pixel is within the gamut!
-                    m_image.setPixelColor(x, y, tempColor);
-                }
+                labBuffer[count] = lab;
+                xBuffer[count] = x;
+                ++count;
             }
         }
+        m_rgbColorSpace->toRgbUnbound(labBuffer.constData(), //
+                                      rgbBuffer.data(),
+                                      isInGamutBuffer.data(),
+                                      count);
+        // Write only the pixels that are within the gamut.
+        ScanlineWriter::writeMasked(reinterpret_cast<QRgb *>(imageBits + y * bytesPerLine), //
+                                    xBuffer.constData(),
+                                    rgbBuffer.constData(),
+                                    isInGamutBuffer.constData(),
+                                    count);
+    };
+    ParallelRows::forEachRow(m_imageSizePhysical, m_threadCount, paintRow);
+    if (isCancelled()) {
+        m_image = QImage();
+        return m_image;
     }
 
     // Cut off everything outside the circle.
@@ -252,10 +400,39 @@ QImage ChromaHueImage::getImage()
                           circleRadius + cutOffThickness / 2,                   // width
                           circleRadius + cutOffThickness / 2                    // height
     );
+    myPainter.end();
+
+    if (m_useCaches) {
+        ImageDiskCache::store(key, m_image);
+    }
 
     // Set the correct scaling information for the image and return
     m_image.setDevicePixelRatio(m_devicePixelRatioF);
+    if (m_useCaches) {
+        SharedImageCache::insert(key, m_image);
+    }
     return m_image;
 }
 
+/** @brief Key for caches.
+ *
+ * @returns A key that contains everything that influences the image
+ * content. Two objects with the same key render identical images. The
+ * key is used for example by @ref ImageDiskCache and
+ * @ref SharedImageCache. */
+QByteArray ChromaHueImage::cacheKey() const
+{
+    QByteArray result;
+    QDataStream stream(&result, QIODevice::WriteOnly);
+    stream << QByteArrayLiteral("ChromaHueImage") //
+           << m_rgbColorSpace->profileIdentifier() //
+           << m_imageSizePhysical //
+           << m_borderPhysical //
+           << m_lightness //
+           << m_chromaRange //
+           << m_devicePixelRatioF //
+           << m_resolutionDivisor;
+    return result;
+}
+
 } // namespace PerceptualColor
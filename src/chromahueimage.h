@@ -30,6 +30,8 @@
 #include "PerceptualColor/perceptualcolorglobal.h"
 #include "perceptualcolorinternal.h"
 
+#include <QAtomicInt>
+#include <QByteArray>
 #include <QImage>
 #include <QSharedPointer>
 
@@ -71,6 +73,9 @@ namespace PerceptualColor
  *
  * This class supports HiDPI via its @ref setDevicePixelRatioF function.
  *
+ * The image can be rendered with various threads in parallel. See
+ * @ref setThreadCount() for details.
+ *
  * @note Resetting a property to its very same value does not trigger an
  * image calculation. So, if the border is 5, and you call @ref setBorder
  * <tt>(5)</tt>, than this will not trigger an image calculation, but the
@@ -88,19 +93,31 @@ class ChromaHueImage final
 {
 public:
     explicit ChromaHueImage(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace);
+    QByteArray cacheKey() const;
     QImage getImage();
     void setBorder(const qreal newBorder);
+    void setCancellationFlag(const QAtomicInt *newCancellationFlag);
     void setChromaRange(const qreal newChromaRange);
     void setDevicePixelRatioF(const qreal newDevicePixelRatioF);
     void setImageSize(const int newImageSize);
     void setLightness(const qreal newLightness);
+    void setResolutionDivisor(const int newResolutionDivisor);
+    void setThreadCount(const int newThreadCount);
 
 private:
     Q_DISABLE_COPY(ChromaHueImage)
 
     /** @internal @brief Only for unit tests. */
     friend class TestChromaHueImage;
+    /** @internal @brief Only for unit tests. */
+    friend class TestImageDiskCache;
 
+    bool isCancelled() const;
+
+    /** @brief Internal store for the cancellation flag.
+     *
+     * @sa @ref setCancellationFlag() */
+    const QAtomicInt *m_cancellationFlag = nullptr;
     /** @brief Internal store for the border size, measured in physical pixels.
      *
      * @sa @ref setBorder() */
@@ -140,8 +157,24 @@ private:
      *
      * @sa @ref setChromaRange() */
     qreal m_chromaRange = 0;
+    /** @brief Internal store for the resolution divisor.
+     *
+     * @sa @ref setResolutionDivisor() */
+    int m_resolutionDivisor = 1;
     /** @brief Pointer to @ref RgbColorSpace object */
     QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace;
+    /** @brief Internal store for the thread count.
+     *
+     * @sa @ref setThreadCount() */
+    int m_threadCount = 1;
+    /** @brief If @ref getImage() uses @ref SharedImageCache and
+     * @ref ImageDiskCache.
+     *
+     * <tt>false</tt> for the internal images that render with reduced
+     * resolution (see @ref setResolutionDivisor()): They are only
+     * needed during an interaction and must not displace the
+     * full-resolution images from the caches. */
+    bool m_useCaches = true;
 };
 
 } // namespace PerceptualColor
@@ -34,11 +34,14 @@
 #include "chromalightnessdiagram_p.h"
 
 #include "helper.h"
+#include "instrumentationscope.h"
 #include "lchvalues.h"
 
 #include <QApplication>
 #include <QDebug>
+#include <QPaintEvent>
 #include <QPainter>
+#include <QThread>
 #include <QtMath>
 
 namespace PerceptualColor
@@ -64,6 +67,19 @@ ChromaLightnessDiagram::ChromaLightnessDiagram(const QSharedPointer<PerceptualCo
     d_pointer->m_chromaLightnessImage.setImageSize(
         // Update the image size will free memory of the cache inmediatly.
         d_pointer->calculateImageSizePhysical());
+
+    // Repaint when an asynchronously rendered image gets ready.
+    connect(&d_pointer->m_chromaLightnessRenderer, &AsyncImageRenderer::imageReady, this, [this]() {
+        update();
+    });
+
+    // Forward throttled notifications.
+    connect(&d_pointer->m_colorChangeThrottle, &ColorChangeThrottle::throttledChange, this, [this]() {
+        Q_EMIT currentColorChangedThrottled(d_pointer->m_currentColor);
+    });
+    connect(&d_pointer->m_colorChangeThrottle, &ColorChangeThrottle::finished, this, [this]() {
+        Q_EMIT currentColorChangeFinished(d_pointer->m_currentColor);
+    });
 }
 
 /** @brief Default destructor */
@@ -215,6 +231,9 @@ LchDouble ChromaLightnessDiagram::ChromaLightnessDiagramPrivate::fromWidgetPixel
  * implement this? */
 void ChromaLightnessDiagram::mousePressEvent(QMouseEvent *event)
 {
+    // The press defines the position; older input is obsolete.
+    discardPendingInput();
+    d_pointer->m_isKeyInputPending = false;
     d_pointer->m_isMouseEventActive = true;
     d_pointer->setCurrentColorFromWidgetPixelPosition(event->pos());
     if (d_pointer->isWidgetPixelPositionInGamut(event->pos())) {
@@ -235,12 +254,20 @@ void ChromaLightnessDiagram::mousePressEvent(QMouseEvent *event)
  * @param event The corresponding mouse event */
 void ChromaLightnessDiagram::mouseMoveEvent(QMouseEvent *event)
 {
-    d_pointer->setCurrentColorFromWidgetPixelPosition(event->pos());
-    if (d_pointer->isWidgetPixelPositionInGamut(event->pos())) {
-        setCursor(Qt::BlankCursor);
-    } else {
-        unsetCursor();
-    }
+    registerInteraction();
+    // Searching the nearest in-gamut color is expensive. Mouse moves can
+    // arrive much faster than the screen refreshes, so only the most
+    // recent position is processed once per frame.
+    d_pointer->m_isKeyInputPending = false;
+    const QPoint position = event->pos();
+    coalesceInput([this, position]() {
+        d_pointer->setCurrentColorFromWidgetPixelPosition(position);
+        if (d_pointer->isWidgetPixelPositionInGamut(position)) {
+            setCursor(Qt::BlankCursor);
+        } else {
+            unsetCursor();
+        }
+    });
 }
 
 /** @brief React on a mouse release event.
@@ -255,7 +282,14 @@ void ChromaLightnessDiagram::mouseMoveEvent(QMouseEvent *event)
  * @param event The corresponding mouse event */
 void ChromaLightnessDiagram::mouseReleaseEvent(QMouseEvent *event)
 {
+    // The final position is processed immediately and exactly,
+    // replacing input that is still waiting for processing.
+    discardPendingInput();
+    d_pointer->m_isKeyInputPending = false;
     d_pointer->setCurrentColorFromWidgetPixelPosition(event->pos());
+    // The interaction has finished; there is no need to wait until
+    // the color comes to rest.
+    d_pointer->m_colorChangeThrottle.finish();
     unsetCursor();
 }
 
@@ -267,37 +301,88 @@ void ChromaLightnessDiagram::mouseReleaseEvent(QMouseEvent *event)
 void ChromaLightnessDiagram::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
-    // We do not paint directly on the widget, but on a QImage buffer first:
-    // Render anti-aliased looks better. But as Qt documentation says:
-    //
-    //      “Renderhints are used to specify flags to QPainter that may or
-    //       may not be respected by any given engine.”
-    //
-    // Painting here directly on the widget might lead to different
-    // anti-aliasing results depending on the underlying window system. This
-    // is especially problematic as anti-aliasing might shift or not a pixel
-    // to the left or to the right. So we paint on a QImage first. As QImage
-    // (at difference to QPixmap and a QWidget) is independent of native
-    // platform rendering, it guarantees identical anti-aliasing results on
-    // all platforms. Here the quote from QPainter class documentation:
+    const InstrumentationScope instrumentationScope("ChromaLightnessDiagram::paintEvent");
+    // The diagram image is composited on a QImage buffer and cached as
+    // QPixmap, so that it can be blitted fast. It is only rebuilt when
+    // the image changes; when only the handle moves, it is reused. We
+    // compose it on a QImage because, as Qt documentation says:
     //
     //      “To get the optimal rendering result using QPainter, you should
     //       use the platform independent QImage as paint device; i.e. using
     //       QImage will ensure that the result has an identical pixel
     //       representation on any platform.”
-    QImage paintBuffer(physicalPixelSize(), QImage::Format_ARGB32_Premultiplied);
-    paintBuffer.fill(Qt::transparent);
-    QPainter painter(&paintBuffer);
-    QPen pen;
+    //
+    // Handle and focus indicator are painted directly over the
+    // static layer.
+
+    // Get the diagram itself as available in the cache.
+    // The image is rendered on a worker thread. The render function
+    // must therefore not access this widget, but only copies of the
+    // parameters.
+    const QSharedPointer<RgbColorSpace> colorSpace = d_pointer->m_rgbColorSpace;
+    const QSize imageSize = d_pointer->calculateImageSizePhysical();
+    const qreal hue = d_pointer->m_currentColor.h;
+    d_pointer->m_chromaLightnessImage.setImageSize(imageSize);
+    d_pointer->m_chromaLightnessImage.setHue(hue);
+    // Progressive rendering: While an interaction is in progress, a
+    // coarse image is rendered, unless the full-resolution image for
+    // the current parameters is available anyway.
+    int resolutionDivisor = 1;
+    d_pointer->m_chromaLightnessImage.setResolutionDivisor(resolutionDivisor);
+    if (isInteractionInProgress() && !d_pointer->m_chromaLightnessRenderer.hasImage(d_pointer->m_chromaLightnessImage.cacheKey())) {
+        resolutionDivisor = interactiveResolutionDivisor;
+        d_pointer->m_chromaLightnessImage.setResolutionDivisor(resolutionDivisor);
+    }
+    auto renderFunction = [colorSpace, imageSize, hue, resolutionDivisor](const QAtomicInt &isCancelled) {
+        ChromaLightnessImage image(colorSpace);
+        image.setImageSize(imageSize);
+        image.setHue(hue);
+        image.setResolutionDivisor(resolutionDivisor);
+        // The image has to be rendered again whenever the hue changes,
+        // which happens continuously while the user interacts with other
+        // widgets. Use all available processor cores for this.
+        image.setThreadCount(QThread::idealThreadCount());
+        image.setCancellationFlag(&isCancelled);
+        return image.getImage();
+    };
+    const QImage diagramImage = d_pointer->m_chromaLightnessRenderer.request( //
+        d_pointer->m_chromaLightnessImage.cacheKey(),
+        renderFunction);
+
+    // Rebuild the static layer if necessary.
+    const qreal devicePixelRatio = devicePixelRatioF();
+    if ((diagramImage.cacheKey() != d_pointer->m_staticLayerImageKey) //
+        || (d_pointer->m_staticLayer.size() != physicalPixelSize()) //
+        || (d_pointer->m_staticLayer.devicePixelRatioF() != devicePixelRatio)) {
+        QImage buffer(physicalPixelSize(), QImage::Format_ARGB32_Premultiplied);
+        buffer.fill(Qt::transparent);
+        QPainter bufferPainter(&buffer);
+        bufferPainter.setRenderHint(QPainter::Antialiasing, false);
+        // While a new image is rendered, the renderer provides the most
+        // recent ready image, which might have a different size. Therefore,
+        // it is always drawn into the full target rectangle.
+        bufferPainter.drawImage(
+            // Operating in physical pixels:
+            QRect(QPoint(d_pointer->leftBorderPhysical(), // x position (top-left)
+                         d_pointer->defaultBorderPhysical()), // y position (top-left)
+                  imageSize),
+            diagramImage // image
+        );
+        bufferPainter.end();
+        buffer.setDevicePixelRatio(devicePixelRatio);
+        d_pointer->m_staticLayer = QPixmap::fromImage(buffer);
+        d_pointer->m_staticLayerImageKey = diagramImage.cacheKey();
+    }
 
-    // Paint the diagram itself as available in the cache.
+    // Paint the static layer to the actual widget. (The painter is
+    // clipped to the paint event’s region, so when only the handle has
+    // moved, only the area of the handle is copied.)
+    QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing, false);
-    painter.drawImage(
-        // Operating in physical pixels:
-        d_pointer->leftBorderPhysical(),             // x position (top-left)
-        d_pointer->defaultBorderPhysical(),          // y position (top-left)
-        d_pointer->m_chromaLightnessImage.getImage() // image
-    );
+    painter.drawPixmap(QPoint(0, 0), d_pointer->m_staticLayer);
+    // Handle and focus indicator are calculated in physical pixels.
+    painter.scale(1 / devicePixelRatio, 1 / devicePixelRatio);
+    QPen pen;
 
     // Paint a focus indicator.
     //
@@ -352,15 +437,7 @@ void ChromaLightnessDiagram::paintEvent(QPaintEvent *event)
     }
 
     // Paint the handle on-the-fly.
-    const int diagramHeight = d_pointer->calculateImageSizePhysical().height();
-    QPointF colorCoordinatePoint = QPointF(
-        // x:
-        d_pointer->m_currentColor.c * diagramHeight / 100.0,
-        // y:
-        d_pointer->m_currentColor.l * diagramHeight / 100.0 * (-1) + diagramHeight);
-    colorCoordinatePoint += QPointF(d_pointer->leftBorderPhysical(),   // horizontal offset
-                                    d_pointer->defaultBorderPhysical() // vertical offset
-    );
+    const QPointF colorCoordinatePoint = d_pointer->widgetCoordinatesFromCurrentColor() * devicePixelRatio;
     pen = QPen();
     pen.setWidthF(handleOutlineThickness() * devicePixelRatioF());
     pen.setColor(handleColorFromBackgroundLightness(d_pointer->m_currentColor.l));
@@ -370,12 +447,6 @@ void ChromaLightnessDiagram::paintEvent(QPaintEvent *event)
                         handleRadius() * devicePixelRatioF(), // x radius
                         handleRadius() * devicePixelRatioF()  // y radius
     );
-
-    // Paint the buffer to the actual widget
-    paintBuffer.setDevicePixelRatio(devicePixelRatioF());
-    QPainter widgetPainter(this);
-    widgetPainter.setRenderHint(QPainter::Antialiasing, true);
-    widgetPainter.drawImage(0, 0, paintBuffer);
 }
 
 /** @brief React on key press events.
@@ -401,7 +472,11 @@ void ChromaLightnessDiagram::paintEvent(QPaintEvent *event)
  * gamut has some sort of corner, and there, the curser blocks. */
 void ChromaLightnessDiagram::keyPressEvent(QKeyEvent *event)
 {
-    LchDouble temp = d_pointer->m_currentColor;
+    // If a key press is still waiting for processing, this key press
+    // adds to it, so that no step gets lost.
+    LchDouble temp = d_pointer->m_isKeyInputPending //
+        ? d_pointer->m_pendingKeyColor
+        : d_pointer->m_currentColor;
     switch (event->key()) {
     case Qt::Key_Up:
         temp.l += singleStepLightness;
@@ -447,9 +522,26 @@ void ChromaLightnessDiagram::keyPressEvent(QKeyEvent *event)
 
     // Set the new image coordinates (only takes effect when image
     // coordinates are indeed different)
-    setCurrentColor(
-        // Search for the nearest color without changing the hue:
-        d_pointer->m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness(temp));
+    if (event->isAutoRepeat()) {
+        registerInteraction();
+        // Auto-repeated key presses can arrive faster than the screen
+        // refreshes, so they are processed at most once per frame.
+        d_pointer->m_pendingKeyColor = temp;
+        d_pointer->m_isKeyInputPending = true;
+        coalesceInput([this, temp]() {
+            d_pointer->m_isKeyInputPending = false;
+            setCurrentColor(
+                // Search for the nearest color without changing the hue:
+                d_pointer->m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness(temp));
+        });
+    } else {
+        // A single key press is processed immediately.
+        discardPendingInput();
+        d_pointer->m_isKeyInputPending = false;
+        setCurrentColor(
+            // Search for the nearest color without changing the hue:
+            d_pointer->m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness(temp));
+    }
 }
 
 /** @brief Tests if a given widget pixel position is within
@@ -488,6 +580,23 @@ bool ChromaLightnessDiagram::ChromaLightnessDiagramPrivate::isWidgetPixelPositio
         && m_rgbColorSpace->isInGamut(color));
 }
 
+/** @brief Widget coordinate point corresponding to the
+ * @ref currentColor property
+ *
+ * @returns Widget coordinate point corresponding to the @ref currentColor
+ * property. This is the position of the handle, measured in
+ * <em>device-independant pixels</em>. */
+QPointF ChromaLightnessDiagram::ChromaLightnessDiagramPrivate::widgetCoordinatesFromCurrentColor() const
+{
+    const int diagramHeight = calculateImageSizePhysical().height();
+    const QPointF physicalCoordinatePoint(
+        // x:
+        m_currentColor.c * diagramHeight / 100.0 + leftBorderPhysical(),
+        // y:
+        m_currentColor.l * diagramHeight / 100.0 * (-1) + diagramHeight + defaultBorderPhysical());
+    return physicalCoordinatePoint / q_pointer->devicePixelRatioF();
+}
+
 /** @brief Setter for the @ref currentColor() property.
  *
  * @param newCurrentColor the new @ref currentColor
@@ -503,13 +612,66 @@ void ChromaLightnessDiagram::setCurrentColor(const PerceptualColor::LchDouble &n
     }
 
     double oldHue = d_pointer->m_currentColor.h;
+    const QRect oldHandleRect = circularHandleBoundingRect(d_pointer->widgetCoordinatesFromCurrentColor());
     d_pointer->m_currentColor = newCurrentColor;
+    // Schedule a paint event:
     if (d_pointer->m_currentColor.h != oldHue) {
         // Update the diagram (only if the hue has changed):
         d_pointer->m_chromaLightnessImage.setHue(d_pointer->m_currentColor.h);
+        registerImageParameterChange();
+        update();
+    } else {
+        // Only the handle has moved:
+        update(QRegion(oldHandleRect) //
+               + circularHandleBoundingRect(d_pointer->widgetCoordinatesFromCurrentColor()));
     }
-    update(); // Schedule a paint event
     Q_EMIT currentColorChanged(newCurrentColor);
+    LchaDouble throttleColor;
+    throttleColor.l = newCurrentColor.l;
+    throttleColor.c = newCurrentColor.c;
+    throttleColor.h = newCurrentColor.h;
+    throttleColor.a = 1;
+    d_pointer->m_colorChangeThrottle.registerChange(throttleColor);
+}
+
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal ChromaLightnessDiagram::throttledNotificationDeltaE() const
+{
+    return d_pointer->m_colorChangeThrottle.minimumDeltaE();
+}
+
+/** @brief Setter for the @ref throttledNotificationDeltaE property.
+ *
+ * @param newThrottledNotificationDeltaE the new value */
+void ChromaLightnessDiagram::setThrottledNotificationDeltaE(const qreal newThrottledNotificationDeltaE)
+{
+    const qreal oldValue = d_pointer->m_colorChangeThrottle.minimumDeltaE();
+    d_pointer->m_colorChangeThrottle.setMinimumDeltaE(newThrottledNotificationDeltaE);
+    if (d_pointer->m_colorChangeThrottle.minimumDeltaE() != oldValue) {
+        Q_EMIT throttledNotificationDeltaEChanged( //
+            d_pointer->m_colorChangeThrottle.minimumDeltaE());
+    }
+}
+
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal ChromaLightnessDiagram::throttledNotificationRate() const
+{
+    return d_pointer->m_colorChangeThrottle.maximumRate();
+}
+
+/** @brief Setter for the @ref throttledNotificationRate property.
+ *
+ * @param newThrottledNotificationRate the new value */
+void ChromaLightnessDiagram::setThrottledNotificationRate(const qreal newThrottledNotificationRate)
+{
+    const qreal oldValue = d_pointer->m_colorChangeThrottle.maximumRate();
+    d_pointer->m_colorChangeThrottle.setMaximumRate(newThrottledNotificationRate);
+    if (d_pointer->m_colorChangeThrottle.maximumRate() != oldValue) {
+        Q_EMIT throttledNotificationRateChanged( //
+            d_pointer->m_colorChangeThrottle.maximumRate());
+    }
 }
 
 /** @brief React on a resize event.
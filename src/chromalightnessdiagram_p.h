@@ -33,9 +33,13 @@
 // Include the header of the public class of this private implementation.
 #include "chromalightnessdiagram.h"
 
+#include "asyncimagerenderer.h"
 #include "chromalightnessimage.h"
+#include "colorchangethrottle.h"
 #include "constpropagatingrawpointer.h"
 
+#include <QPixmap>
+
 namespace PerceptualColor
 {
 /** @internal
@@ -53,8 +57,18 @@ public:
     ~ChromaLightnessDiagramPrivate() noexcept = default;
 
     // Member variables
-    /** @brief The image of the chroma-lightness diagram itself. */
+    /** @brief The image of the chroma-lightness diagram itself.
+     *
+     * This object holds the current parameters of the image. The image
+     * itself is rendered by @ref m_chromaLightnessRenderer. */
     ChromaLightnessImage m_chromaLightnessImage;
+    /** @brief Renders @ref m_chromaLightnessImage on a worker thread. */
+    AsyncImageRenderer m_chromaLightnessRenderer;
+    /** @brief Throttles the notifications about color changes.
+     *
+     * @sa @ref throttledNotificationRate
+     * @sa @ref throttledNotificationDeltaE */
+    ColorChangeThrottle m_colorChangeThrottle;
     /** @brief Internal storage of the @ref currentColor property */
     LchDouble m_currentColor;
     /** @brief Holds if currently a mouse event is active or not.
@@ -73,8 +87,29 @@ public:
      * circular widget, only reacting on mouse events within the circle;
      * this requires this custom implementation. */
     bool m_isMouseEventActive = false; // TODO Remove me!
+    /** @brief If a key press is waiting for processing.
+     *
+     * @sa @ref m_pendingKeyColor */
+    bool m_isKeyInputPending = false;
+    /** @brief The color that a key press, which is waiting for
+     * processing, will set.
+     *
+     * Only valid if @ref m_isKeyInputPending is <tt>true</tt>. */
+    LchDouble m_pendingKeyColor;
     /** @brief Pointer to RgbColorSpace() object */
     QSharedPointer<RgbColorSpace> m_rgbColorSpace;
+    /** @brief Cache for the static layer of the widget.
+     *
+     * The static layer contains the diagram image at its position within
+     * the widget. It does not contain the handle or the focus indicator,
+     * which are painted over it. It is only rebuilt when the image
+     * or the widget size change.
+     *
+     * @sa @ref m_staticLayerImageKey */
+    QPixmap m_staticLayer;
+    /** @brief <tt>QImage::cacheKey()</tt> of the diagram image
+     * within @ref m_staticLayer. */
+    qint64 m_staticLayerImageKey = 0;
 
     // Member functions
     QSize calculateImageSizePhysical() const;
@@ -83,6 +118,7 @@ public:
     bool isWidgetPixelPositionInGamut(const QPoint widgetPixelPosition) const;
     int leftBorderPhysical() const;
     void setCurrentColorFromWidgetPixelPosition(const QPoint widgetPixelPosition);
+    QPointF widgetCoordinatesFromCurrentColor() const;
 
 private:
     Q_DISABLE_COPY(ChromaLightnessDiagramPrivate)
@@ -31,10 +31,19 @@
 // First the interface, which forces the header to be self-contained.
 #include "chromalightnessimage.h"
 
+#include "PerceptualColor/imagediskcache.h"
+#include "PerceptualColor/sharedimagecache.h"
+#include "instrumentationscope.h"
 #include "lchvalues.h"
+#include "parallelrows.h"
 #include "polarpointf.h"
+#include "rgbdouble.h"
+#include "scanlinewriter.h"
 
+#include <QDataStream>
 #include <QPainter>
+#include <QVector>
+#include <QtMath>
 
 namespace PerceptualColor
 {
@@ -95,6 +104,77 @@ void ChromaLightnessImage::setHue(const qreal newHue)
     }
 }
 
+/** @brief Setter for the resolution divisor property.
+ *
+ * For progressive rendering: While the user interacts with a widget,
+ * a coarse image that is available quickly is often preferable to an
+ * exact image that takes long to render. With a resolution divisor of
+ * <tt>n</tt>, the image is rendered with only <tt>1/n</tt> of the
+ * resolution in each direction and then scaled up to the full image
+ * size. The result is blurry, but with a divisor of <tt>2</tt>, only
+ * a quarter of the pixels has to be calculated. Coarse images are
+ * neither stored in nor loaded from @ref SharedImageCache and
+ * @ref ImageDiskCache.
+ *
+ * The default value is <tt>1</tt> which means full resolution.
+ *
+ * @param newResolutionDivisor The new resolution divisor. Values smaller
+ * than <tt>1</tt> are treated as <tt>1</tt>. */
+void ChromaLightnessImage::setResolutionDivisor(const int newResolutionDivisor)
+{
+    const int temp = qMax(1, newResolutionDivisor);
+    if (m_resolutionDivisor != temp) {
+        m_resolutionDivisor = temp;
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
+/** @brief Setter for the thread count property.
+ *
+ * The rows of the image are distributed across this number of threads
+ * (see @ref ParallelRows). The rendered image is identical, regardless
+ * of the thread count. Therefore, changing this property does not
+ * invalidate the cache.
+ *
+ * You can set this to <tt>QThread::idealThreadCount()</tt> to use all
+ * available processor cores.
+ *
+ * The default value is <tt>1</tt> which means that the image is rendered
+ * sequentially within the calling thread.
+ *
+ * @param newThreadCount The new thread count. Values smaller
+ * than <tt>1</tt> are treated as <tt>1</tt>. */
+void ChromaLightnessImage::setThreadCount(const int newThreadCount)
+{
+    m_threadCount = qMax(1, newThreadCount);
+}
+
+/** @brief Setter for the cancellation flag.
+ *
+ * Allows to cancel @ref getImage() from another thread: When the flag
+ * becomes non-zero while @ref getImage() is running, it stops as soon
+ * as possible and returns a null image. (Cancelled renders are not
+ * cached.)
+ *
+ * @param newCancellationFlag Pointer to the cancellation flag. It must
+ * stay valid while @ref getImage() is running. <tt>nullptr</tt> means
+ * that @ref getImage() cannot be cancelled. This is the default. */
+void ChromaLightnessImage::setCancellationFlag(const QAtomicInt *newCancellationFlag)
+{
+    m_cancellationFlag = newCancellationFlag;
+}
+
+/** @brief If the current render has been cancelled.
+ *
+ * @returns If the current render has been cancelled.
+ *
+ * @sa @ref setCancellationFlag() */
+bool ChromaLightnessImage::isCancelled() const
+{
+    return (m_cancellationFlag != nullptr) && (m_cancellationFlag->loadAcquire() != 0);
+}
+
 /** @brief Delivers an image of a chroma-lightness diagram.
  *
  * @returns A chroma-lightness diagram. For the y axis, its height covers
@@ -121,6 +201,48 @@ QImage ChromaLightnessImage::getImage()
         return m_image;
     }
 
+    const InstrumentationScope instrumentationScope("ChromaLightnessImage::getImage");
+
+    // Progressive rendering: Render an image with reduced
+    // resolution and scale it up to the full image size.
+    if (m_resolutionDivisor > 1) {
+        ChromaLightnessImage coarseImage(m_rgbColorSpace);
+        coarseImage.setImageSize( //
+            QSize(qCeil(static_cast<qreal>(m_imageSizePhysical.width()) / m_resolutionDivisor),
+                  qCeil(static_cast<qreal>(m_imageSizePhysical.height()) / m_resolutionDivisor)));
+        coarseImage.setHue(m_hue);
+        coarseImage.setBackgroundColor(m_backgroundColor);
+        coarseImage.setThreadCount(m_threadCount);
+        coarseImage.setCancellationFlag(m_cancellationFlag);
+        coarseImage.m_useCaches = false;
+        const QImage coarse = coarseImage.getImage();
+        if (coarse.isNull()) {
+            // Cancelled (or empty image size)
+            m_image = QImage();
+            return m_image;
+        }
+        m_image = coarse.scaled(m_imageSizePhysical, //
+                                Qt::IgnoreAspectRatio,
+                                Qt::SmoothTransformation);
+        return m_image;
+    }
+
+    const QByteArray key = m_useCaches ? cacheKey() : QByteArray();
+    if (m_useCaches) {
+        // Try the process-wide shared cache.
+        m_image = SharedImageCache::find(key);
+        if (!m_image.isNull()) {
+            return m_image;
+        }
+
+        // Try the persistent disk cache.
+        m_image = ImageDiskCache::load(key);
+        if (!m_image.isNull()) {
+            SharedImageCache::insert(key, m_image);
+            return m_image;
+        }
+    }
+
     // If no image is in cache, create a new one (in the cache) with
     // correct image size.
     m_image = QImage(m_imageSizePhysical, QImage::Format_ARGB32_Premultiplied);
@@ -132,12 +254,9 @@ QImage ChromaLightnessImage::getImage()
     }
 
     // Initialization
-    LchDouble LCh;
-    QColor rgbColor;
-    int x;
-    int y;
     const int imageHeight = m_imageSizePhysical.height();
     const int imageWidth = m_imageSizePhysical.width();
+    const qreal hue = PolarPointF::normalizedAngleDegree(m_hue);
 
     // Initialize the image background
     if (m_backgroundColor.isValid()) {
@@ -145,34 +264,81 @@ QImage ChromaLightnessImage::getImage()
     } else {
         m_image.fill(m_rgbColorSpace->toQColorRgbBound(LchValues::neutralGray()));
     }
+    // The rows are rendered in parallel. The image has been detached
+    // yet by fill(), so the threads can safely write to the scanlines.
+    uchar *const imageBits = m_image.bits();
+    const int bytesPerLine = m_image.bytesPerLine();
 
     // Paint the gamut.
-    LCh.h = PolarPointF::normalizedAngleDegree(m_hue);
-    for (y = 0; y < imageHeight; ++y) {
+    auto paintRow = [this, imageHeight, imageWidth, hue, imageBits, bytesPerLine](const int y) {
+        if (isCancelled()) {
+            return;
+        }
+        // Buffers for the row-by-row conversion: All pixels of a row are
+        // converted within a single call to the color space.
+        QVector<LchDouble> lchBuffer(imageWidth);
+        QVector<RgbDouble> rgbBuffer(imageWidth);
+        QVector<bool> isInGamutBuffer(imageWidth);
+        LchDouble LCh;
+        LCh.h = hue;
         LCh.l = 100 - (y + 0.5) * 100.0 / imageHeight;
-        for (x = 0; x < imageWidth; ++x) {
+        for (int x = 0; x < imageWidth; ++x) {
             // Using the same scale as on the y axis. floating point
             // division thanks to 100 which is a "cmsFloat64Number"
             LCh.c = (x + 0.5) * 100.0 / imageHeight;
-            rgbColor = m_rgbColorSpace->toQColorRgbUnbound(LCh);
-            if (rgbColor.isValid()) {
-                // The pixel is within the gamut
-                m_image.setPixelColor(x, y, rgbColor);
-                // If color is out-of-gamut: We have chroma on the x axis and
-                // lightness on the y axis. We are drawing the pixmap line per
-                // line, so we go for given lightness from low chroma to high
-                // chroma. Because of the nature of most gamuts, if once in a
-                // line we have an out-of-gamut value, all other pixels that
-                // are more at the right will be out-of-gamut also. So we
-                // could optimize our code and break here. But as we are not
-                // sure about this (we do not know the gamut at compile time)
-                // for the moment we do not optimize the code.
-            }
+            lchBuffer[x] = LCh;
         }
+        m_rgbColorSpace->toRgbUnbound(lchBuffer.constData(), //
+                                      rgbBuffer.data(),
+                                      isInGamutBuffer.data(),
+                                      imageWidth);
+        // Write only the pixels that are within the gamut.
+        // If color is out-of-gamut: We have chroma on the x axis and
+        // lightness on the y axis. We are drawing the pixmap line per
+        // line, so we go for given lightness from low chroma to high
+        // chroma. Because of the nature of most gamuts, if once in a
+        // line we have an out-of-gamut value, all other pixels that
+        // are more at the right will be out-of-gamut also. So we
+        // could optimize our code and break here. But as we are not
+        // sure about this (we do not know the gamut at compile time)
+        // for the moment we do not optimize the code.
+        ScanlineWriter::writeMasked(reinterpret_cast<QRgb *>(imageBits + y * bytesPerLine), //
+                                    rgbBuffer.constData(),
+                                    isInGamutBuffer.constData(),
+                                    imageWidth);
+    };
+    ParallelRows::forEachRow(imageHeight, m_threadCount, paintRow);
+    if (isCancelled()) {
+        m_image = QImage();
+        return m_image;
+    }
+
+    if (m_useCaches) {
+        ImageDiskCache::store(key, m_image);
+        SharedImageCache::insert(key, m_image);
     }
 
     // Now return the cache.
     return m_image;
 }
 
+/** @brief Key for caches.
+ *
+ * @returns A key that contains everything that influences the image
+ * content. Two objects with the same key render identical images. The
+ * key is used for example by @ref ImageDiskCache and
+ * @ref SharedImageCache. */
+QByteArray ChromaLightnessImage::cacheKey() const
+{
+    QByteArray result;
+    QDataStream stream(&result, QIODevice::WriteOnly);
+    stream << QByteArrayLiteral("ChromaLightnessImage") //
+           << m_rgbColorSpace->profileIdentifier() //
+           << m_imageSizePhysical //
+           << PolarPointF::normalizedAngleDegree(m_hue) //
+           << m_backgroundColor //
+           << m_resolutionDivisor;
+    return result;
+}
+
 } // namespace PerceptualColor
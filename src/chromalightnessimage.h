@@ -30,6 +30,8 @@
 #include "PerceptualColor/perceptualcolorglobal.h"
 #include "perceptualcolorinternal.h"
 
+#include <QAtomicInt>
+#include <QByteArray>
 #include <QImage>
 #include <QSharedPointer>
 
@@ -63,6 +65,9 @@ namespace PerceptualColor
  * usage, as no memory will be hold for data that will not be
  * needed again.)
  *
+ * The image can be rendered with various threads in parallel. See
+ * @ref setThreadCount() for details.
+ *
  * @note Resetting a property to its very same value does not trigger an
  * image calculation. So, if the hue is 5, and you call @ref setHue
  * <tt>(5)</tt>, than this will not trigger an image calculation, but the
@@ -80,21 +85,33 @@ class ChromaLightnessImage final
 {
 public:
     explicit ChromaLightnessImage(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace);
+    QByteArray cacheKey() const;
     QImage getImage();
     void setBackgroundColor(const QColor newBackgroundColor);
+    void setCancellationFlag(const QAtomicInt *newCancellationFlag);
     void setHue(const qreal newHue);
     void setImageSize(const QSize newImageSize);
+    void setResolutionDivisor(const int newResolutionDivisor);
+    void setThreadCount(const int newThreadCount);
 
 private:
     Q_DISABLE_COPY(ChromaLightnessImage)
 
     /** @internal @brief Only for unit tests. */
     friend class TestChromaLightnessImage;
+    /** @internal @brief Only for unit tests. */
+    friend class TestImageDiskCache;
+
+    bool isCancelled() const;
 
     /** @brief Internal store for the background color.
      *
      * @sa @ref setBackgroundColor() */
     QColor m_backgroundColor;
+    /** @brief Internal store for the cancellation flag.
+     *
+     * @sa @ref setCancellationFlag() */
+    const QAtomicInt *m_cancellationFlag = nullptr;
     /** @brief Internal store for the hue.
      *
      * This is the hue (h) value in the LCH color model.
@@ -114,8 +131,24 @@ private:
      *
      * @sa @ref setImageSize() */
     QSize m_imageSizePhysical;
+    /** @brief Internal store for the resolution divisor.
+     *
+     * @sa @ref setResolutionDivisor() */
+    int m_resolutionDivisor = 1;
     /** @brief Pointer to @ref RgbColorSpace object */
     QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace;
+    /** @brief Internal store for the thread count.
+     *
+     * @sa @ref setThreadCount() */
+    int m_threadCount = 1;
+    /** @brief If @ref getImage() uses @ref SharedImageCache and
+     * @ref ImageDiskCache.
+     *
+     * <tt>false</tt> for the internal images that render with reduced
+     * resolution (see @ref setResolutionDivisor()): They are only
+     * needed during an interaction and must not displace the
+     * full-resolution images from the caches. */
+    bool m_useCaches = true;
 };
 
 } // namespace PerceptualColor
@@ -0,0 +1,185 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "colorchangethrottle.h"
+
+#include <QtMath>
+
+namespace PerceptualColor
+{
+/** @brief Constructor
+ *
+ * @param parent The parent object */
+ColorChangeThrottle::ColorChangeThrottle(QObject *parent)
+    : QObject(parent)
+{
+    m_rateTimer.setSingleShot(true);
+    connect(&m_rateTimer, &QTimer::timeout, this, &ColorChangeThrottle::notifyPendingChange);
+    m_finishTimer.setSingleShot(true);
+    m_finishTimer.setInterval(finishDelayMilliseconds);
+    connect(&m_finishTimer, &QTimer::timeout, this, &ColorChangeThrottle::finish);
+}
+
+/** @brief Destructor */
+ColorChangeThrottle::~ColorChangeThrottle() noexcept
+{
+}
+
+/** @brief The perceptual distance between two colors.
+ *
+ * @param first The first color
+ * @param second The second color
+ * @returns The CIE76 color difference ΔE*ab between the colors. The alpha
+ * channel is included as an additional dimension, scaled so that the
+ * difference between fully transparent and fully opaque counts as much
+ * as the difference between black and white. */
+qreal ColorChangeThrottle::deltaE(const LchaDouble &first, const LchaDouble &second)
+{
+    const qreal firstHue = qDegreesToRadians(first.h);
+    const qreal secondHue = qDegreesToRadians(second.h);
+    const qreal deltaL = first.l - second.l;
+    const qreal deltaA = first.c * qCos(firstHue) - second.c * qCos(secondHue);
+    const qreal deltaB = first.c * qSin(firstHue) - second.c * qSin(secondHue);
+    const qreal deltaAlpha = (first.a - second.a) * 100;
+    return qSqrt(deltaL * deltaL + deltaA * deltaA + deltaB * deltaB + deltaAlpha * deltaAlpha);
+}
+
+/** @brief Finishes the current series of color changes.
+ *
+ * Emits @ref finished() if there have been changes since the most
+ * recent @ref finished() signal. Changes that wait for notification
+ * are dropped: The receivers of @ref finished() get the final color
+ * anyway.
+ *
+ * This function is called automatically when the changes come to rest.
+ * Owners can call it explicitly when they know that an interaction has
+ * finished, for example on a mouse release. */
+void ColorChangeThrottle::finish()
+{
+    const bool hasUnfinishedChanges = m_hasUnfinishedChanges;
+    reset();
+    if (hasUnfinishedChanges) {
+        Q_EMIT finished();
+    }
+}
+
+/** @brief The maximum rate of @ref throttledChange() signals.
+ *
+ * @returns The maximum number of @ref throttledChange() signals per
+ * second. <tt>0</tt> means that throttling is disabled.
+ *
+ * @sa @ref setMaximumRate() */
+qreal ColorChangeThrottle::maximumRate() const
+{
+    return m_maximumRate;
+}
+
+/** @brief The minimum color difference for @ref throttledChange() signals.
+ *
+ * @returns The minimum color difference, measured as @ref deltaE(),
+ * between the most recently notified color and a new color, so that the
+ * new color is notified by @ref throttledChange().
+ *
+ * @sa @ref setMinimumDeltaE() */
+qreal ColorChangeThrottle::minimumDeltaE() const
+{
+    return m_minimumDeltaE;
+}
+
+/** @brief Notifies the pending change, if it is significant. */
+void ColorChangeThrottle::notifyPendingChange()
+{
+    if (!m_hasPendingChange) {
+        return;
+    }
+    m_hasPendingChange = false;
+    if (m_hasNotifiedColor && (deltaE(m_notifiedColor, m_pendingColor) < m_minimumDeltaE)) {
+        return;
+    }
+    m_notifiedColor = m_pendingColor;
+    m_hasNotifiedColor = true;
+    m_rateTimer.start(qMax(1, qRound(1000 / m_maximumRate)));
+    Q_EMIT throttledChange();
+}
+
+/** @brief Registers a color change.
+ *
+ * The owner calls this function on each change of its color.
+ *
+ * @param color The new color */
+void ColorChangeThrottle::registerChange(const LchaDouble &color)
+{
+    if (m_maximumRate <= 0) {
+        return;
+    }
+    m_pendingColor = color;
+    m_hasPendingChange = true;
+    m_hasUnfinishedChanges = true;
+    m_finishTimer.start();
+    if (!m_rateTimer.isActive()) {
+        notifyPendingChange();
+    }
+}
+
+/** @brief Forgets all changes without emitting signals. */
+void ColorChangeThrottle::reset()
+{
+    m_rateTimer.stop();
+    m_finishTimer.stop();
+    m_hasPendingChange = false;
+    m_hasNotifiedColor = false;
+    m_hasUnfinishedChanges = false;
+}
+
+/** @brief Setter for @ref maximumRate().
+ *
+ * @param newMaximumRate The maximum number of @ref throttledChange()
+ * signals per second. <tt>0</tt> disables throttling. Negative values
+ * are treated as <tt>0</tt>. */
+void ColorChangeThrottle::setMaximumRate(const qreal newMaximumRate)
+{
+    const qreal temp = qMax<qreal>(0, newMaximumRate);
+    if (m_maximumRate != temp) {
+        m_maximumRate = temp;
+        reset();
+    }
+}
+
+/** @brief Setter for @ref minimumDeltaE().
+ *
+ * @param newMinimumDeltaE The new minimum color difference. Negative
+ * values are treated as <tt>0</tt>. */
+void ColorChangeThrottle::setMinimumDeltaE(const qreal newMinimumDeltaE)
+{
+    m_minimumDeltaE = qMax<qreal>(0, newMinimumDeltaE);
+}
+
+} // namespace PerceptualColor
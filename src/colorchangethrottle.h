@@ -0,0 +1,131 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef COLORCHANGETHROTTLE_H
+#define COLORCHANGETHROTTLE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QObject>
+#include <QTimer>
+
+#include "PerceptualColor/lchadouble.h"
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief Rate-limits notifications about color changes.
+ *
+ * While the user drags a handle, the current color of a widget changes
+ * many times per second. Applications that do expensive work on each
+ * change can use throttled notifications instead: Cheap previews during
+ * the interaction, and one full-quality update at its end.
+ *
+ * The owner calls @ref registerChange() on each color change. This
+ * class emits @ref throttledChange() at most @ref maximumRate() times
+ * per second. A change is only notified if it differs at least by
+ * @ref minimumDeltaE() from the most recently notified color. When the
+ * color changes come to rest (or when the owner calls @ref finish()
+ * explicitly), @ref finished() is emitted once.
+ *
+ * The signals do not carry the color. The owner reacts by emitting
+ * its own signals with its current color, which is always the most
+ * recent one.
+ *
+ * Throttling is opt-in: With a @ref maximumRate() of <tt>0</tt> (the
+ * default), this class is disabled and does not emit anything.
+ *
+ * Usage:
+ * @snippet test/testcolorchangethrottle.cpp ColorChangeThrottle usage */
+class ColorChangeThrottle final : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ColorChangeThrottle(QObject *parent = nullptr);
+    virtual ~ColorChangeThrottle() noexcept override;
+    static qreal deltaE(const LchaDouble &first, const LchaDouble &second);
+    void finish();
+    qreal maximumRate() const;
+    qreal minimumDeltaE() const;
+    void registerChange(const LchaDouble &color);
+    void setMaximumRate(const qreal newMaximumRate);
+    void setMinimumDeltaE(const qreal newMinimumDeltaE);
+
+    /** @brief Time without color changes after which the color changes
+     * are considered to be finished, measured in milliseconds. */
+    static constexpr int finishDelayMilliseconds = 200;
+
+Q_SIGNALS:
+    /** @brief Color changes have finished.
+     *
+     * Emitted once after a series of color changes. */
+    void finished();
+    /** @brief A throttled color change.
+     *
+     * Emitted at most @ref maximumRate() times per second. */
+    void throttledChange();
+
+private:
+    Q_DISABLE_COPY(ColorChangeThrottle)
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestColorChangeThrottle;
+
+    void notifyPendingChange();
+    void reset();
+
+    /** @brief Restarted on each change; times out when the changes
+     * come to rest.
+     *
+     * @sa @ref finishDelayMilliseconds */
+    QTimer m_finishTimer;
+    /** @brief If there have been changes since the most recent
+     * @ref finished() signal. */
+    bool m_hasUnfinishedChanges = false;
+    /** @brief If @ref m_notifiedColor is valid. */
+    bool m_hasNotifiedColor = false;
+    /** @brief If @ref m_pendingColor has not been notified yet. */
+    bool m_hasPendingChange = false;
+    /** @brief Internal storage for @ref maximumRate() */
+    qreal m_maximumRate = 0;
+    /** @brief Internal storage for @ref minimumDeltaE() */
+    qreal m_minimumDeltaE = 0;
+    /** @brief The most recently notified color. */
+    LchaDouble m_notifiedColor;
+    /** @brief The most recent color that has not been notified yet. */
+    LchaDouble m_pendingColor;
+    /** @brief Active during the minimum interval after a notification.
+     *
+     * @sa @ref maximumRate() */
+    QTimer m_rateTimer;
+};
+
+} // namespace PerceptualColor
+
+#endif // COLORCHANGETHROTTLE_H
@@ -311,6 +311,13 @@ void ColorDialog::ColorDialogPrivate::setCurrentOpaqueColor(const PerceptualColo
     // Emit signal currentColorChanged() only if necessary
     if (q_pointer->currentColor() != oldQColor) {
         Q_EMIT q_pointer->currentColorChanged(q_pointer->currentColor());
+        const LchDouble currentLch = m_currentOpaqueColor.toLch();
+        LchaDouble throttleColor;
+        throttleColor.l = currentLch.l;
+        throttleColor.c = currentLch.c;
+        throttleColor.h = currentLch.h;
+        throttleColor.a = m_alphaGradientSlider->value();
+        m_colorChangeThrottle.registerChange(throttleColor);
     }
 
     // End of this function. Unblock resursive
@@ -584,6 +591,21 @@ void ColorDialog::ColorDialogPrivate::initialize(const QSharedPointer<Perceptual
                 m_alphaGradientSlider->setValue(newValue / 100);
             });
 
+    connect(&m_colorChangeThrottle,              // sender
+            &ColorChangeThrottle::throttledChange, // signal
+            q_pointer,                             // receiver
+            [this]() {                             // lambda
+                Q_EMIT q_pointer->currentColorChangedThrottled( //
+                    q_pointer->currentColor());
+            });
+    connect(&m_colorChangeThrottle,       // sender
+            &ColorChangeThrottle::finished, // signal
+            q_pointer,                      // receiver
+            [this]() {                      // lambda
+                Q_EMIT q_pointer->currentColorChangeFinished( //
+                    q_pointer->currentColor());
+            });
+
     // Initialize the options
     q_pointer->setOptions(QColorDialog::ColorDialogOption::DontUseNativeDialog);
 
@@ -973,6 +995,44 @@ void ColorDialog::done(int result)
     }
 }
 
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal ColorDialog::throttledNotificationDeltaE() const
+{
+    return d_pointer->m_colorChangeThrottle.minimumDeltaE();
+}
+
+/** @brief Setter for property @ref throttledNotificationDeltaE
+ * @param newThrottledNotificationDeltaE the new value */
+void ColorDialog::setThrottledNotificationDeltaE(const qreal newThrottledNotificationDeltaE)
+{
+    const qreal oldValue = d_pointer->m_colorChangeThrottle.minimumDeltaE();
+    d_pointer->m_colorChangeThrottle.setMinimumDeltaE(newThrottledNotificationDeltaE);
+    if (d_pointer->m_colorChangeThrottle.minimumDeltaE() != oldValue) {
+        Q_EMIT throttledNotificationDeltaEChanged( //
+            d_pointer->m_colorChangeThrottle.minimumDeltaE());
+    }
+}
+
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal ColorDialog::throttledNotificationRate() const
+{
+    return d_pointer->m_colorChangeThrottle.maximumRate();
+}
+
+/** @brief Setter for property @ref throttledNotificationRate
+ * @param newThrottledNotificationRate the new value */
+void ColorDialog::setThrottledNotificationRate(const qreal newThrottledNotificationRate)
+{
+    const qreal oldValue = d_pointer->m_colorChangeThrottle.maximumRate();
+    d_pointer->m_colorChangeThrottle.setMaximumRate(newThrottledNotificationRate);
+    if (d_pointer->m_colorChangeThrottle.maximumRate() != oldValue) {
+        Q_EMIT throttledNotificationRateChanged( //
+            d_pointer->m_colorChangeThrottle.maximumRate());
+    }
+}
+
 // No documentation here (documentation of properties
 // and its getters are in the header)
 ColorDialog::DialogLayoutDimensions ColorDialog::layoutDimensions() const
@@ -33,6 +33,7 @@
 // Include the header of the public class of this private implementation.
 #include "PerceptualColor/colordialog.h"
 
+#include "colorchangethrottle.h"
 #include "constpropagatingrawpointer.h"
 
 #include "PerceptualColor/chromahuediagram.h"
@@ -88,6 +89,11 @@ public:
     QPointer<QDialogButtonBox> m_buttonBox;
     /** @brief Pointer to the @ref ChromaHueDiagram. */
     QPointer<ChromaHueDiagram> m_chromaHueDiagram;
+    /** @brief Throttles the notifications about color changes.
+     *
+     * @sa @ref throttledNotificationRate
+     * @sa @ref throttledNotificationDeltaE */
+    ColorChangeThrottle m_colorChangeThrottle;
     /** @brief Pointer to the @ref ColorPatch widget. */
     QPointer<ColorPatch> m_colorPatch;
     /** @brief Holds the current color without alpha information
@@ -40,6 +40,7 @@
 #include "PerceptualColor/abstractdiagram.h"
 
 #include "helper.h"
+#include "instrumentationscope.h"
 
 namespace PerceptualColor
 {
@@ -117,6 +118,7 @@ void ColorPatch::setColor(const QColor &newColor)
  * @param event the event to be handled */
 void ColorPatch::paintEvent(QPaintEvent *event)
 {
+    const InstrumentationScope instrumentationScope("ColorPatch::paintEvent");
     // First of all, draw the frame
     QFrame::paintEvent(event);
 
@@ -34,6 +34,7 @@
 #include "colorwheel_p.h"
 
 #include "helper.h"
+#include "instrumentationscope.h"
 #include "lchvalues.h"
 #include "polarpointf.h"
 
@@ -77,6 +78,14 @@ ColorWheel::ColorWheel(const QSharedPointer<PerceptualColor::RgbColorSpace> &col
     // circle. Therefore, this class simply defaults to
     // Qt::FocusPolicy::TabFocus for QWidget::focusPolicy().
     setFocusPolicy(Qt::FocusPolicy::TabFocus);
+
+    // Forward throttled notifications.
+    connect(&d_pointer->m_colorChangeThrottle, &ColorChangeThrottle::throttledChange, this, [this]() {
+        Q_EMIT hueChangedThrottled(d_pointer->m_hue);
+    });
+    connect(&d_pointer->m_colorChangeThrottle, &ColorChangeThrottle::finished, this, [this]() {
+        Q_EMIT hueChangeFinished(d_pointer->m_hue);
+    });
 }
 
 /** @brief Default destructor */
@@ -216,6 +225,9 @@ void ColorWheel::mouseReleaseEvent(QMouseEvent *event)
     if (d_pointer->m_isMouseEventActive) {
         d_pointer->m_isMouseEventActive = false;
         setHue(d_pointer->fromWidgetToWheelCoordinates(event->pos()).angleDegree());
+        // The interaction has finished; there is no need to wait until
+        // the hue comes to rest.
+        d_pointer->m_colorChangeThrottle.finish();
     } else {
         // Make sure default coordinates like drag-window in KDE’s Breeze
         // widget style works
@@ -318,73 +330,49 @@ void ColorWheel::keyPressEvent(QKeyEvent *event)
 void ColorWheel::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
-    // We do not paint directly on the widget, but on a QImage buffer first:
-    // Render anti-aliased looks better. But as Qt documentation says:
-    //
-    //      “Renderhints are used to specify flags to QPainter that may or
-    //       may not be respected by any given engine.”
-    //
-    // Painting here directly on the widget might lead to different
-    // anti-aliasing results depending on the underlying window system. This
-    // is especially problematic as anti-aliasing might shift or not a pixel
-    // to the left or to the right. So we paint on a QImage first. As QImage
-    // (at difference to QPixmap and a QWidget) is independent of native
-    // platform rendering, it guarantees identical anti-aliasing results on
-    // all platforms. Here the quote from QPainter class documentation:
-    //
-    //      “To get the optimal rendering result using QPainter, you should
-    //       use the platform independent QImage as paint device; i.e. using
-    //       QImage will ensure that the result has an identical pixel
-    //       representation on any platform.”
-    QImage paintBuffer(maximumPhysicalSquareSize(),        // width
-                       maximumPhysicalSquareSize(),        // height
-                       QImage::Format_ARGB32_Premultiplied // format
-    );
-    paintBuffer.fill(Qt::transparent);
-    paintBuffer.setDevicePixelRatio(devicePixelRatioF());
-    QPainter bufferPainter(&paintBuffer);
-
-    // Paint the color wheel
-    bufferPainter.setRenderHint(QPainter::Antialiasing, false);
+    const InstrumentationScope instrumentationScope("ColorWheel::paintEvent");
+    // The wheel image is cached as QPixmap, so that it can be blitted
+    // fast. It is only rebuilt when the wheel image changes; when only
+    // the handle moves, it is reused. Handle and focus indicator are
+    // painted directly over it.
+
     // As devicePixelRatioF() might have changed, we make sure everything
     // that might depend on devicePixelRatioF() is updated before painting.
     d_pointer->m_wheelImage.setBorder(spaceForFocusIndicator() * devicePixelRatioF());
     d_pointer->m_wheelImage.setDevicePixelRatioF(devicePixelRatioF());
     d_pointer->m_wheelImage.setImageSize(maximumPhysicalSquareSize());
     d_pointer->m_wheelImage.setWheelThickness(gradientThickness() * devicePixelRatioF());
-    bufferPainter.drawImage(QPoint(0, 0),                      // image position (top-left)
-                            d_pointer->m_wheelImage.getImage() // the image itself
-    );
+    const QImage wheelImage = d_pointer->m_wheelImage.getImage();
+    if (wheelImage.cacheKey() != d_pointer->m_staticLayerWheelKey) {
+        d_pointer->m_staticLayer = QPixmap::fromImage(wheelImage);
+        d_pointer->m_staticLayerWheelKey = wheelImage.cacheKey();
+    }
+
+    // Paint the color wheel. (The painter is clipped to the paint
+    // event’s region, so when only the handle has moved, only the
+    // area of the handle is copied.)
+    QPainter widgetPainter(this);
+    widgetPainter.setRenderHint(QPainter::Antialiasing, false);
+    widgetPainter.drawPixmap(QPoint(0, 0), d_pointer->m_staticLayer);
 
     // Paint the handle
-    const qreal wheelOuterRadius = maximumWidgetSquareSize() / 2.0 - spaceForFocusIndicator();
-    // Get widget coordinates for the handle
-    QPointF myHandleInner = d_pointer->fromWheelToWidgetCoordinates(
-        // Inner point at the wheel:
-        PolarPointF(wheelOuterRadius - gradientThickness(), // x
-                    d_pointer->m_hue                        // y
-                    ));
-    QPointF myHandleOuter = d_pointer->fromWheelToWidgetCoordinates(
-        // Outer point at the wheel:
-        PolarPointF(wheelOuterRadius, d_pointer->m_hue));
-    // Draw the line
     QPen pen;
     pen.setWidth(handleOutlineThickness());
     pen.setCapStyle(Qt::FlatCap);
     pen.setColor(Qt::black);
-    bufferPainter.setPen(pen);
-    bufferPainter.setRenderHint(QPainter::Antialiasing, true);
-    bufferPainter.drawLine(myHandleInner, myHandleOuter);
+    widgetPainter.setPen(pen);
+    widgetPainter.setRenderHint(QPainter::Antialiasing, true);
+    widgetPainter.drawLine(d_pointer->handleLine());
 
     // Paint a focus indicator if the widget has the focus
     if (hasFocus()) {
-        bufferPainter.setRenderHint(QPainter::Antialiasing, true);
+        widgetPainter.setRenderHint(QPainter::Antialiasing, true);
         pen = QPen();
         pen.setWidth(handleOutlineThickness());
         pen.setColor(focusIndicatorColor());
-        bufferPainter.setPen(pen);
+        widgetPainter.setPen(pen);
         const qreal center = maximumWidgetSquareSize() / 2.0;
-        bufferPainter.drawEllipse(
+        widgetPainter.drawEllipse(
             // center:
             QPointF(center, center),
             // x radius:
@@ -392,11 +380,25 @@ void ColorWheel::paintEvent(QPaintEvent *event)
             // y radius:
             center - handleOutlineThickness() / 2.0);
     }
+}
 
-    // Paint the buffer to the actual widget
-    QPainter widgetPainter(this);
-    widgetPainter.setRenderHint(QPainter::Antialiasing, false);
-    widgetPainter.drawImage(QPoint(0, 0), paintBuffer);
+/** @brief The handle.
+ *
+ * @returns The line of the handle on the wheel for the
+ * current @ref hue, measured in widget coordinates. */
+QLineF ColorWheel::ColorWheelPrivate::handleLine() const
+{
+    const qreal wheelOuterRadius = q_pointer->maximumWidgetSquareSize() / 2.0 - q_pointer->spaceForFocusIndicator();
+    // Get widget coordinates for the handle
+    const QPointF myHandleInner = fromWheelToWidgetCoordinates(
+        // Inner point at the wheel:
+        PolarPointF(wheelOuterRadius - q_pointer->gradientThickness(), // x
+                    m_hue                                              // y
+                    ));
+    const QPointF myHandleOuter = fromWheelToWidgetCoordinates(
+        // Outer point at the wheel:
+        PolarPointF(wheelOuterRadius, m_hue));
+    return QLineF(myHandleInner, myHandleOuter);
 }
 
 /** @brief React on a resize event.
@@ -428,9 +430,43 @@ qreal ColorWheel::hue() const
 void ColorWheel::setHue(const qreal newHue)
 {
     if (d_pointer->m_hue != newHue) {
+        const QLineF oldHandle = d_pointer->handleLine();
         d_pointer->m_hue = newHue;
         Q_EMIT hueChanged(d_pointer->m_hue);
-        update();
+        // The minimum ΔE of the throttle stays 0, so lightness and
+        // chroma do not matter: Every hue change is a change.
+        LchaDouble throttleColor;
+        throttleColor.l = 0;
+        throttleColor.c = 0;
+        throttleColor.h = d_pointer->m_hue;
+        throttleColor.a = 1;
+        d_pointer->m_colorChangeThrottle.registerChange(throttleColor);
+        // Schedule a paint event only for the area of
+        // the old and the new handle:
+        const QLineF newHandle = d_pointer->handleLine();
+        update( //
+            QRegion(lineBoundingRect(oldHandle.p1(), oldHandle.p2(), handleOutlineThickness())) //
+            + lineBoundingRect(newHandle.p1(), newHandle.p2(), handleOutlineThickness()));
+    }
+}
+
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal ColorWheel::throttledNotificationRate() const
+{
+    return d_pointer->m_colorChangeThrottle.maximumRate();
+}
+
+/** @brief Setter for the @ref throttledNotificationRate property.
+ *
+ * @param newThrottledNotificationRate the new value */
+void ColorWheel::setThrottledNotificationRate(const qreal newThrottledNotificationRate)
+{
+    const qreal oldValue = d_pointer->m_colorChangeThrottle.maximumRate();
+    d_pointer->m_colorChangeThrottle.setMaximumRate(newThrottledNotificationRate);
+    if (d_pointer->m_colorChangeThrottle.maximumRate() != oldValue) {
+        Q_EMIT throttledNotificationRateChanged( //
+            d_pointer->m_colorChangeThrottle.maximumRate());
     }
 }
 
@@ -33,10 +33,14 @@
 // Include the header of the public class of this private implementation.
 #include "PerceptualColor/colorwheel.h"
 
+#include "colorchangethrottle.h"
 #include "colorwheelimage.h"
 #include "constpropagatingrawpointer.h"
 #include "polarpointf.h"
 
+#include <QLineF>
+#include <QPixmap>
+
 namespace PerceptualColor
 {
 /** @internal
@@ -53,6 +57,10 @@ public:
      * the class as a whole is <tt>final</tt>. */
     ~ColorWheelPrivate() noexcept = default;
 
+    /** @brief Throttles the notifications about hue changes.
+     *
+     * @sa @ref throttledNotificationRate */
+    ColorChangeThrottle m_colorChangeThrottle;
     /** @brief Internal storage of the @ref hue() property */
     qreal m_hue;
     /** @brief Holds if currently a mouse event is active or not.
@@ -74,12 +82,24 @@ public:
     /** @brief Pointer to @ref RgbColorSpace object used to describe the
      * color space. */
     QSharedPointer<RgbColorSpace> m_rgbColorSpace;
+    /** @brief Cache for the static layer of the widget.
+     *
+     * Holds @ref m_wheelImage as <tt>QPixmap</tt>, which can be blitted
+     * fast. The handle and the focus indicator are painted over it. It is
+     * only rebuilt when the wheel image changes.
+     *
+     * @sa @ref m_staticLayerWheelKey */
+    QPixmap m_staticLayer;
+    /** @brief <tt>QImage::cacheKey()</tt> of the wheel image
+     * within @ref m_staticLayer. */
+    qint64 m_staticLayerWheelKey = 0;
     /** @brief The image of the wheel itself. */
     ColorWheelImage m_wheelImage;
 
     int border() const;
     QPointF fromWheelToWidgetCoordinates(const PolarPointF wheelCoordinates) const;
     PolarPointF fromWidgetToWheelCoordinates(const QPoint widgetCoordinatePoint) const;
+    QLineF handleLine() const;
     qreal innerDiameter() const;
     void setHueNormalized(const qreal newHue);
 
@@ -31,11 +31,17 @@
 // First the interface, which forces the header to be self-contained.
 #include "colorwheelimage.h"
 
+#include "PerceptualColor/imagediskcache.h"
+#include "PerceptualColor/sharedimagecache.h"
 #include "helper.h"
+#include "instrumentationscope.h"
 #include "lchvalues.h"
-#include "polarpointf.h"
+#include "rgbdouble.h"
+#include "scanlinewriter.h"
 
+#include <QDataStream>
 #include <QPainter>
+#include <QVector>
 #include <QtMath>
 
 namespace PerceptualColor
@@ -149,6 +155,80 @@ void ColorWheelImage::setWheelThickness(const qreal newWheelThickness)
     }
 }
 
+/** @brief Fast calculation of the angle of a point.
+ *
+ * Same result as <tt>@ref PolarPointF(QPointF(x, y)).angleDegree()</tt>,
+ * but considerably faster, at the price of a maximum error of
+ * about <tt>0.001°</tt>. This is far below the resolution of
+ * @ref m_hueTable.
+ *
+ * @param x The x coordinate
+ * @param y The y coordinate
+ *
+ * @returns The angle, measured in degree, counter-clockwise from the
+ * positive x axis. Range: <tt>[0, 360]</tt>. For the point
+ * <tt>(0, 0)</tt>, the angle is <tt>0</tt>. */
+qreal ColorWheelImage::fastAngleDegree(const qreal x, const qreal y)
+{
+    const qreal absoluteX = qAbs(x);
+    const qreal absoluteY = qAbs(y);
+    if ((absoluteX == 0) && (absoluteY == 0)) {
+        return 0;
+    }
+    // Reduce to the first octant, where z is within [0, 1].
+    const bool isSteep = absoluteY > absoluteX;
+    const qreal z = isSteep ? absoluteX / absoluteY : absoluteY / absoluteX;
+    const qreal z2 = z * z;
+    // Polynomial approximation of atan(z) for z within [0, 1]
+    // (Abramowitz and Stegun, formula 4.4.49) with a maximum
+    // error of 1e-5 radian.
+    qreal angle = z
+        * (0.9998660 //
+           + z2 * (-0.3302995 //
+                   + z2 * (0.1801410 //
+                           + z2 * (-0.0851330 //
+                                   + z2 * 0.0208351))));
+    // Back from the first octant to the full circle
+    if (isSteep) {
+        angle = M_PI / 2 - angle;
+    }
+    if (x < 0) {
+        angle = M_PI - angle;
+    }
+    if (y < 0) {
+        angle = 2 * M_PI - angle;
+    }
+    return qRadiansToDegrees(angle);
+}
+
+/** @brief Calculates @ref m_hueTable if not yet done. */
+void ColorWheelImage::ensureHueTable()
+{
+    if (!m_hueTable.isEmpty()) {
+        return;
+    }
+    QVector<LchDouble> lchBuffer(hueTableSize);
+    QVector<RgbDouble> rgbBuffer(hueTableSize);
+    QVector<bool> isInGamutBuffer(hueTableSize);
+    LchDouble lch;
+    lch.l = LchValues::neutralLightness;
+    lch.c = LchValues::srgbVersatileChroma;
+    for (int i = 0; i < hueTableSize; ++i) {
+        lch.h = i * 360. / hueTableSize;
+        lchBuffer[i] = lch;
+    }
+    m_rgbColorSpace->toRgbUnbound(lchBuffer.constData(), //
+                                  rgbBuffer.data(),
+                                  isInGamutBuffer.data(),
+                                  hueTableSize);
+    m_hueTable = QVector<QRgb>(hueTableSize, qRgba(0, 0, 0, 0));
+    for (int i = 0; i < hueTableSize; ++i) {
+        if (isInGamutBuffer.at(i)) {
+            m_hueTable[i] = ScanlineWriter::opaqueArgb32(rgbBuffer.at(i));
+        }
+    }
+}
+
 /** @brief Delivers an image of a color wheel
  *
  * @returns Delivers a square image of a color wheel. Its size
@@ -168,6 +248,23 @@ QImage ColorWheelImage::getImage()
         return m_image;
     }
 
+    const InstrumentationScope instrumentationScope("ColorWheelImage::getImage");
+
+    // Try the process-wide shared cache.
+    const QByteArray key = cacheKey();
+    m_image = SharedImageCache::find(key);
+    if (!m_image.isNull()) {
+        return m_image;
+    }
+
+    // Try the persistent disk cache.
+    m_image = ImageDiskCache::load(key);
+    if (!m_image.isNull()) {
+        m_image.setDevicePixelRatio(m_devicePixelRatioF);
+        SharedImageCache::insert(key, m_image);
+        return m_image;
+    }
+
     // If no cache is available (m_image.isNull()), render a new image.
 
     // Special case: zero-size-image
@@ -197,36 +294,35 @@ QImage ColorWheelImage::getImage()
     // defines an overlap for the wheel, so there are some more pixels that
     // are drawn at the outer and at the inner border of the wheel, to allow
     // later clipping with anti-aliasing
-    PolarPointF polarCoordinates;
-    int x;
-    int y;
-    QColor rgbColor;
-    LchDouble lch;
-    qreal center = (m_imageSizePhysical - 1) / static_cast<qreal>(2);
-    m_image = QImage(QSize(m_imageSizePhysical, m_imageSizePhysical), QImage::Format_ARGB32_Premultiplied);
-    // Because there may be out-of-gamut colors for some hue (depending on the
-    // given lightness and chroma value) which are drawn transparent, it is
-    // important to initialize this image with a transparent background.
-    m_image.fill(Qt::transparent);
-    lch.l = LchValues::neutralLightness;
-    lch.c = LchValues::srgbVersatileChroma;
+    const qreal center = (m_imageSizePhysical - 1) / static_cast<qreal>(2);
     // minimumRadial: Adding "+ 1" would reduce the workload (less pixel to
     // process) and still work mostly, but not completely. It creates sometimes
     // artifacts in the anti-aliasing process. So we don't do that.
     const qreal minimumRadial = center - m_wheelThicknessPhysical - m_borderPhysical - overlap;
     const qreal maximumRadial = center - m_borderPhysical + overlap;
-    for (x = 0; x < m_imageSizePhysical; ++x) {
-        for (y = 0; y < m_imageSizePhysical; ++y) {
-            polarCoordinates = PolarPointF(QPointF(x - center, center - y));
-            if (isInRange<qreal>(minimumRadial, polarCoordinates.radial(), maximumRadial)
-
-            ) {
+    // Compare squared values to avoid the square root for each pixel.
+    const qreal minimumRadialSquare = (minimumRadial > 0) ? minimumRadial * minimumRadial : 0;
+    const qreal maximumRadialSquare = maximumRadial * maximumRadial;
+    // The wheel colors come from a lookup table, so the color space
+    // is not involved in the pixel loop.
+    ensureHueTable();
+    const QRgb *const hueTable = m_hueTable.constData();
+    constexpr qreal tableEntriesPerDegree = hueTableSize / 360.;
+    for (int y = 0; y < m_imageSizePhysical; ++y) {
+        QRgb *const scanline = ScanlineWriter::scanline(&m_image, y);
+        const qreal dy = center - y;
+        for (int x = 0; x < m_imageSizePhysical; ++x) {
+            const qreal dx = x - center;
+            const qreal radialSquare = dx * dx + dy * dy;
+            if (isInRange<qreal>(minimumRadialSquare, radialSquare, maximumRadialSquare)) {
                 // We are within the wheel
-                lch.h = polarCoordinates.angleDegree();
-                rgbColor = m_rgbColorSpace->toQColorRgbUnbound(lch);
-                if (rgbColor.isValid()) {
-                    m_image.setPixelColor(x, y, rgbColor);
+                int index = qRound(fastAngleDegree(dx, dy) * tableEntriesPerDegree);
+                if (index >= hueTableSize) {
+                    index -= hueTableSize;
                 }
+                // Out-of-gamut colors are transparent in the table,
+                // just like the background.
+                scanline[x] = hueTable[index];
             }
         }
     }
@@ -261,10 +357,33 @@ QImage ColorWheelImage::getImage()
         myPainter.setBrush(QBrush(Qt::SolidPattern));
         myPainter.drawEllipse(QRectF(m_wheelThicknessPhysical + m_borderPhysical, m_wheelThicknessPhysical + m_borderPhysical, innerCircleDiameter, innerCircleDiameter));
     }
+    myPainter.end();
+
+    ImageDiskCache::store(key, m_image);
 
     // Set the correct scaling information for the image and return
     m_image.setDevicePixelRatio(m_devicePixelRatioF);
+    SharedImageCache::insert(key, m_image);
     return m_image;
 }
 
+/** @brief Key for caches.
+ *
+ * @returns A key that contains everything that influences the image
+ * content. Two objects with the same key render identical images. The
+ * key is used for example by @ref ImageDiskCache and
+ * @ref SharedImageCache. */
+QByteArray ColorWheelImage::cacheKey() const
+{
+    QByteArray result;
+    QDataStream stream(&result, QIODevice::WriteOnly);
+    stream << QByteArrayLiteral("ColorWheelImage") //
+           << m_rgbColorSpace->profileIdentifier() //
+           << m_imageSizePhysical //
+           << m_borderPhysical //
+           << m_wheelThicknessPhysical //
+           << m_devicePixelRatioF;
+    return result;
+}
+
 } // namespace PerceptualColor
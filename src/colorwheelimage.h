@@ -30,9 +30,12 @@
 #include "PerceptualColor/perceptualcolorglobal.h"
 #include "perceptualcolorinternal.h"
 
+#include <QByteArray>
 #include <QImage>
 #include <QObject>
+#include <QRgb>
 #include <QSharedPointer>
+#include <QVector>
 
 #include "rgbcolorspace.h"
 
@@ -81,6 +84,7 @@ class ColorWheelImage final
 {
 public:
     explicit ColorWheelImage(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace);
+    QByteArray cacheKey() const;
     QImage getImage();
     void setBorder(const qreal newBorder);
     void setDevicePixelRatioF(const qreal newDevicePixelRatioF);
@@ -92,6 +96,19 @@ private:
 
     /** @internal @brief Only for unit tests. */
     friend class TestColorWheelImage;
+    /** @internal @brief Only for unit tests. */
+    friend class TestImageDiskCache;
+    /** @internal @brief Only for unit tests. */
+    friend class TestSharedImageCache;
+
+    /** @brief Number of entries of @ref m_hueTable.
+     *
+     * The hue resolution of the table is <tt>360° / hueTableSize</tt>,
+     * which is <tt>0.1°</tt>. This is far below the visible difference. */
+    static constexpr int hueTableSize = 3600;
+
+    static qreal fastAngleDegree(const qreal x, const qreal y);
+    void ensureHueTable();
 
     /** @brief Internal store for the border size, measured in physical pixels.
      *
@@ -101,6 +118,21 @@ private:
      *
      * @sa @ref setDevicePixelRatioF() */
     qreal m_devicePixelRatioF = 1;
+    /** @brief Lookup table for the wheel colors.
+     *
+     * The color of the wheel depends only on the hue, as lightness and
+     * chroma are constant. Entry <tt>i</tt> holds the color for the hue
+     * <tt>i * 360° / @ref hueTableSize</tt> in
+     * <tt>QImage::Format_ARGB32_Premultiplied</tt>. Out-of-gamut colors
+     * are transparent.
+     *
+     * The table does not depend on the image properties, so it is
+     * calculated only once, and resizing the image is cheap.
+     *
+     * Empty if not yet calculated.
+     *
+     * @sa @ref ensureHueTable() */
+    QVector<QRgb> m_hueTable;
     /** @brief Internal storage of the image (cache).
      *
      * - If <tt>m_image.isNull()</tt> than either no cache is available
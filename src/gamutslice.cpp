@@ -0,0 +1,241 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "gamutslice.h"
+
+#include <cstddef>
+#include <limits>
+
+namespace PerceptualColor
+{
+/** @brief Constructor
+ *
+ * Calculates the nearest in-gamut pixel for all pixels of the raster.
+ * This has linear complexity in the number of pixels.
+ *
+ * @param width The width of the raster.
+ * @param height The height of the raster.
+ * @param inGamutMask Row-major raster with <tt>width * height</tt>
+ * values: <tt>true</tt> for in-gamut pixels, <tt>false</tt> for
+ * out-of-gamut pixels. */
+GamutSlice::GamutSlice(const int width, const int height, const QVector<bool> &inGamutMask)
+    : m_height(qMax(height, 0))
+    , m_width(qMax(width, 0))
+{
+    const int pixelCount = m_width * m_height;
+    Q_ASSERT(inGamutMask.count() == pixelCount);
+    m_nearestPixel.fill(noPixel, pixelCount);
+
+    // Boundary pixels
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            const int index = y * m_width + x;
+            if (!inGamutMask.at(index)) {
+                continue;
+            }
+            const bool isBoundary = (x == 0) //
+                || (x == m_width - 1) //
+                || (y == 0) //
+                || (y == m_height - 1) //
+                || (!inGamutMask.at(index - 1)) //
+                || (!inGamutMask.at(index + 1)) //
+                || (!inGamutMask.at(index - m_width)) //
+                || (!inGamutMask.at(index + m_width));
+            if (isBoundary) {
+                m_boundary.append(QPoint(x, y));
+            }
+        }
+    }
+    if (m_boundary.isEmpty()) {
+        // There are no in-gamut pixels at all.
+        return;
+    }
+
+    // First pass: For each pixel, the nearest in-gamut
+    // pixel within the same column.
+    QVector<int> columnNearestY(pixelCount, noPixel);
+    for (int x = 0; x < m_width; ++x) {
+        int lastY = noPixel;
+        for (int y = 0; y < m_height; ++y) {
+            if (inGamutMask.at(y * m_width + x)) {
+                lastY = y;
+            }
+            columnNearestY[y * m_width + x] = lastY;
+        }
+        lastY = noPixel;
+        for (int y = m_height - 1; y >= 0; --y) {
+            if (inGamutMask.at(y * m_width + x)) {
+                lastY = y;
+            }
+            const int currentY = columnNearestY.at(y * m_width + x);
+            if ((lastY != noPixel) && ((currentY == noPixel) || (lastY - y < y - currentY))) {
+                columnNearestY[y * m_width + x] = lastY;
+            }
+        }
+    }
+
+    // Second pass: For each row, the lower envelope of the parabolas
+    // (x - column)² + (vertical distance within column)², considering
+    // only columns that have in-gamut pixels at all.
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    QVector<int> parabolaColumn(m_width);
+    QVector<double> parabolaStart(m_width + 1);
+    for (int y = 0; y < m_height; ++y) {
+        const int *rowNearestY = columnNearestY.constData() + y * m_width;
+        const auto verticalDistanceSquare = [rowNearestY, y](const int column) -> double {
+            const double distance = rowNearestY[column] - y;
+            return distance * distance;
+        };
+        int k = -1;
+        for (int column = 0; column < m_width; ++column) {
+            if (rowNearestY[column] == noPixel) {
+                continue;
+            }
+            const double value = verticalDistanceSquare(column) + column * column;
+            if (k < 0) {
+                k = 0;
+                parabolaColumn[0] = column;
+                parabolaStart[0] = -infinity;
+                parabolaStart[1] = infinity;
+                continue;
+            }
+            double intersection;
+            while (true) {
+                const int previous = parabolaColumn.at(k);
+                const double previousValue = verticalDistanceSquare(previous) + previous * previous;
+                intersection = (value - previousValue) / (2.0 * (column - previous));
+                if (intersection > parabolaStart.at(k)) {
+                    break;
+                }
+                // parabolaStart[0] is -infinity, so k never gets negative.
+                --k;
+            }
+            ++k;
+            parabolaColumn[k] = column;
+            parabolaStart[k] = intersection;
+            parabolaStart[k + 1] = infinity;
+        }
+        // There is at least one in-gamut pixel, so every row
+        // has at least one parabola.
+        Q_ASSERT(k >= 0);
+        k = 0;
+        for (int x = 0; x < m_width; ++x) {
+            while (parabolaStart.at(k + 1) < x) {
+                ++k;
+            }
+            const int column = parabolaColumn.at(k);
+            m_nearestPixel[y * m_width + x] = rowNearestY[column] * m_width + column;
+        }
+    }
+}
+
+/** @brief The height of the raster.
+ *
+ * @returns The height of the raster. */
+int GamutSlice::height() const
+{
+    return m_height;
+}
+
+/** @brief If there are no in-gamut pixels at all.
+ *
+ * @returns <tt>true</tt> if there are no in-gamut pixels at all.
+ * <tt>false</tt> otherwise. */
+bool GamutSlice::isEmpty() const
+{
+    return m_boundary.isEmpty();
+}
+
+/** @brief Nearest in-gamut pixel.
+ *
+ * @param point The point for which you search the nearest in-gamut
+ * pixel, expressed in the coordinate system of the raster. This point
+ * may be within or outside the raster.
+ * @returns
+ * \li If <tt>point</tt> itself is an in-gamut pixel,
+ *     <tt>point</tt> is returned.
+ * \li Else, if there are in-gamut pixels, the nearest in-gamut pixel is
+ *     returned. (If there are various nearest pixels at the same
+ *     distance, it is undefined which one is returned.)
+ * \li Else there are no in-gamut pixels, and simply the point
+ *     <tt>0, 0</tt> is returned.
+ *
+ * Complexity: <em>O(1)</em> for points within the raster. For points
+ * outside the raster, linear in the number of boundary pixels. */
+QPoint GamutSlice::nearestInGamutPixel(const QPoint point) const
+{
+    if (isEmpty()) {
+        return QPoint(0, 0);
+    }
+
+    const bool isWithinRaster = (point.x() >= 0) //
+        && (point.x() < m_width) //
+        && (point.y() >= 0) //
+        && (point.y() < m_height);
+    if (isWithinRaster) {
+        const int index = m_nearestPixel.at(point.y() * m_width + point.x());
+        return QPoint(index % m_width, index / m_width);
+    }
+
+    QPoint result = m_boundary.at(0);
+    qint64 bestDistanceSquare = std::numeric_limits<qint64>::max();
+    for (const QPoint &candidate : m_boundary) {
+        const qint64 xDistance = static_cast<qint64>(point.x()) - candidate.x();
+        const qint64 yDistance = static_cast<qint64>(point.y()) - candidate.y();
+        const qint64 distanceSquare = xDistance * xDistance + yDistance * yDistance;
+        if (distanceSquare < bestDistanceSquare) {
+            bestDistanceSquare = distanceSquare;
+            result = candidate;
+        }
+    }
+    return result;
+}
+
+/** @brief Memory usage.
+ *
+ * @returns The approximate number of bytes that this object uses. */
+int GamutSlice::sizeInBytes() const
+{
+    const auto bytes = sizeof(GamutSlice) //
+        + static_cast<std::size_t>(m_boundary.count()) * sizeof(QPoint) //
+        + static_cast<std::size_t>(m_nearestPixel.count()) * sizeof(int);
+    return static_cast<int>(bytes);
+}
+
+/** @brief The width of the raster.
+ *
+ * @returns The width of the raster. */
+int GamutSlice::width() const
+{
+    return m_width;
+}
+
+} // namespace PerceptualColor
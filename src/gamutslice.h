@@ -0,0 +1,108 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GAMUTSLICE_H
+#define GAMUTSLICE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QPoint>
+#include <QVector>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief A precomputed nearest-neighbor lookup for a gamut slice.
+ *
+ * A gamut slice is a two-dimensional raster (for example the
+ * chroma-lightness plane at a given hue) where each pixel is either
+ * in-gamut or out-of-gamut. This class answers the question “Which is
+ * the nearest in-gamut pixel?” for arbitrary points.
+ *
+ * The constructor calculates an exact Euclidean feature transform of
+ * the raster: For each pixel, it stores the nearest in-gamut pixel.
+ * This is done with the algorithm of Felzenszwalb and Huttenlocher
+ * (<a href="https://doi.org/10.4086/toc.2012.v008a019">Distance
+ * Transforms of Sampled Functions</a>) in linear time. Afterwards,
+ * queries for points within the raster cost <em>O(1)</em>. Queries for
+ * points outside the raster (which are rare) only need to check the
+ * in-gamut pixels at the boundary of the gamut, because the nearest
+ * in-gamut pixel is always a boundary pixel.
+ *
+ * The results are exact: They are identical to what a brute-force
+ * search over all pixels would return (except that for various nearest
+ * pixels at the same distance, it is undefined which one is returned).
+ *
+ * Objects of this class are immutable and can therefore be used from
+ * various threads at the same time.
+ *
+ * @snippet test/testgamutslice.cpp GamutSlice usage */
+class GamutSlice final
+{
+public:
+    GamutSlice(const int width, const int height, const QVector<bool> &inGamutMask);
+    /** @brief Default destructor
+     *
+     * The destructor is non-<tt>virtual</tt> because
+     * the class as a whole is <tt>final</tt>. */
+    ~GamutSlice() noexcept = default;
+    int height() const;
+    bool isEmpty() const;
+    QPoint nearestInGamutPixel(const QPoint point) const;
+    int sizeInBytes() const;
+    int width() const;
+
+private:
+    Q_DISABLE_COPY(GamutSlice)
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestGamutSlice;
+
+    /** @brief Internal value for “no pixel”. */
+    static constexpr int noPixel = -1;
+
+    /** @brief The in-gamut pixels at the boundary of the gamut.
+     *
+     * These are the in-gamut pixels that have at least one out-of-gamut
+     * neighbor (or that are at the edge of the raster). */
+    QVector<QPoint> m_boundary;
+    /** @brief The height of the raster. */
+    int m_height = 0;
+    /** @brief The nearest in-gamut pixel for each pixel of the raster.
+     *
+     * Row-major. The value is the index of the nearest in-gamut pixel
+     * (<tt>y * @ref m_width + x</tt>), or @ref noPixel if there are
+     * no in-gamut pixels at all. */
+    QVector<int> m_nearestPixel;
+    /** @brief The width of the raster. */
+    int m_width = 0;
+};
+
+} // namespace PerceptualColor
+
+#endif // GAMUTSLICE_H
@@ -31,11 +31,18 @@
 // First the interface, which forces the header to be self-contained.
 #include "gradientimage.h"
 
+#include <cstring>
 #include <math.h>
 
+#include "PerceptualColor/sharedimagecache.h"
 #include "helper.h"
+#include "instrumentationscope.h"
+#include "rgbdouble.h"
+#include "scanlinewriter.h"
 
+#include <QDataStream>
 #include <QPainter>
+#include <QVector>
 
 namespace PerceptualColor
 {
@@ -132,6 +139,8 @@ QImage GradientImage::getImage()
         return m_image;
     }
 
+    const InstrumentationScope instrumentationScope("GradientImage::getImage");
+
     // If no cache is available (m_image.isNull()), render a new image.
 
     // Special case: zero-size-image
@@ -139,38 +148,162 @@ QImage GradientImage::getImage()
         return m_image;
     }
 
+    // Try the process-wide shared cache.
+    const QByteArray key = cacheKey();
+    m_image = SharedImageCache::find(key);
+    if (!m_image.isNull()) {
+        return m_image;
+    }
+
     // If no image is in cache, create a new one (in the cache) and return it.
 
     // First, create an image of the gradient with only one pixel thickness.
     // (Color management operations are expensive in CPU time; we try to
     // minimize this.)
     QImage temp(m_gradientLength, 1, QImage::Format_ARGB32_Premultiplied);
-    temp.fill(Qt::transparent); // Initialize the image with transparency.
-    LchaDouble color;
-    for (int i = 0; i < m_gradientLength; ++i) {
-        color = colorFromValue((i + 0.5) / static_cast<qreal>(m_gradientLength));
-        temp.setPixelColor(i, 0, m_rgbColorSpace->toQColorRgbBound(color));
+    QRgb *const row = ScanlineWriter::scanline(&temp, 0);
+    const bool isConstantColor = //
+        (m_firstColorCorrected.l == m_secondColorCorrectedAndAltered.l) //
+        && (m_firstColorCorrected.c == m_secondColorCorrectedAndAltered.c) //
+        && (m_firstColorCorrected.h == m_secondColorCorrectedAndAltered.h);
+    if (isConstantColor) {
+        // Typical for alpha gradients: Both colors differ only in alpha. The
+        // interpolated LCH values are identical for all pixels, so a single
+        // conversion is enough.
+        RgbDouble rgb;
+        const LchDouble lch {m_firstColorCorrected.l, //
+                             m_firstColorCorrected.c,
+                             m_firstColorCorrected.h};
+        m_rgbColorSpace->toRgbBound(&lch, &rgb, 1);
+        for (int i = 0; i < m_gradientLength; ++i) {
+            row[i] = ScanlineWriter::premultipliedArgb32( //
+                rgb,
+                colorFromValue((i + 0.5) / static_cast<qreal>(m_gradientLength)).a);
+        }
+    } else {
+        // All pixels of the gradient are converted within a single call
+        // to the color space.
+        LchaDouble color;
+        QVector<LchDouble> lchBuffer(m_gradientLength);
+        QVector<qreal> alphaBuffer(m_gradientLength);
+        QVector<RgbDouble> rgbBuffer(m_gradientLength);
+        for (int i = 0; i < m_gradientLength; ++i) {
+            color = colorFromValue((i + 0.5) / static_cast<qreal>(m_gradientLength));
+            lchBuffer[i].l = color.l;
+            lchBuffer[i].c = color.c;
+            lchBuffer[i].h = color.h;
+            alphaBuffer[i] = color.a;
+        }
+        m_rgbColorSpace->toRgbBound(lchBuffer.constData(), rgbBuffer.data(), m_gradientLength);
+        ScanlineWriter::writePremultiplied(row, //
+                                           rgbBuffer.constData(),
+                                           alphaBuffer.constData(),
+                                           m_gradientLength);
     }
 
     // Now, create a full image of the gradient
     m_image = QImage(m_gradientLength, m_gradientThickness, QImage::Format_ARGB32_Premultiplied);
-    QPainter painter(&m_image);
-    // Transparency background
-    if ((m_firstColorCorrected.a != 1) || (m_secondColorCorrectedAndAltered.a != 1)) {
-        // Fill the image with tiles. (QBrush will ignore
-        // the devicePixelRatioF of the image of the tile.)
-        painter.fillRect(0, 0, m_gradientLength, m_gradientThickness, QBrush(transparencyBackground(m_devicePixelRatioF)));
-    }
-    // Paint the gradient itself.
-    for (int i = 0; i < m_gradientThickness; ++i) {
-        painter.drawImage(0, i, temp);
+    const auto rowBytes = static_cast<size_t>(m_gradientLength) * sizeof(QRgb);
+    if ((m_firstColorCorrected.a == 1) && (m_secondColorCorrectedAndAltered.a == 1)) {
+        // Opaque: Painting over the background would not change anything,
+        // so the row can simply be copied.
+        for (int i = 0; i < m_gradientThickness; ++i) {
+            std::memcpy(ScanlineWriter::scanline(&m_image, i), row, rowBytes);
+        }
+    } else {
+        // Transparency background: The checkerboard has only two distinct
+        // rows. The gradient is composited over both of them only once;
+        // the result is copied into all rows of the image.
+        QImage composited = transparencyRows();
+        // The painter must work in physical pixels; otherwise it would
+        // scale the gradient row by the device pixel ratio.
+        composited.setDevicePixelRatio(1);
+        {
+            QPainter painter(&composited);
+            painter.drawImage(0, 0, temp);
+            painter.drawImage(0, 1, temp);
+        }
+        const int squareSize = transparencySquareSize(m_devicePixelRatioF);
+        for (int i = 0; i < m_gradientThickness; ++i) {
+            const int compositedRow = ((i % (2 * squareSize)) < squareSize) ? 0 : 1;
+            std::memcpy(ScanlineWriter::scanline(&m_image, i), //
+                        ScanlineWriter::scanline(&composited, compositedRow),
+                        rowBytes);
+        }
     }
 
     // Set the correct scaling information for the image and return
     m_image.setDevicePixelRatio(m_devicePixelRatioF);
+    SharedImageCache::insert(key, m_image);
     return m_image;
 }
 
+/** @brief The two distinct rows of the transparency background.
+ *
+ * The transparency background is a checkerboard made of squares of
+ * @ref transparencySquareSize() pixels. Within the background, there are
+ * only two distinct rows: Row 0 is the row at the top of the first row
+ * of squares, row 1 the row at the top of the second row of squares.
+ * All other rows of the background are identical to one of these.
+ *
+ * @returns An image of @ref m_gradientLength × 2 pixels. The result is
+ * cached and only recalculated if @ref m_gradientLength or
+ * @ref m_devicePixelRatioF change.
+ *
+ * @sa @ref m_transparencyRows */
+QImage GradientImage::transparencyRows()
+{
+    if (m_transparencyRows.width() == m_gradientLength //
+        && m_transparencyRows.devicePixelRatioF() == m_devicePixelRatioF) {
+        return m_transparencyRows;
+    }
+    m_transparencyRows = QImage(m_gradientLength, 2, QImage::Format_ARGB32_Premultiplied);
+    // Use exactly the same painting operation as for a full background,
+    // just for a smaller area. (QBrush will ignore the devicePixelRatioF
+    // of the image of the tile.)
+    QImage background(m_gradientLength, //
+                      2 * transparencySquareSize(m_devicePixelRatioF),
+                      QImage::Format_ARGB32_Premultiplied);
+    {
+        QPainter painter(&background);
+        painter.fillRect(0, 0, background.width(), background.height(), QBrush(transparencyBackground(m_devicePixelRatioF)));
+    }
+    const auto rowBytes = static_cast<size_t>(m_gradientLength) * sizeof(QRgb);
+    std::memcpy(ScanlineWriter::scanline(&m_transparencyRows, 0), //
+                ScanlineWriter::scanline(&background, 0),
+                rowBytes);
+    std::memcpy(ScanlineWriter::scanline(&m_transparencyRows, 1), //
+                ScanlineWriter::scanline(&background, transparencySquareSize(m_devicePixelRatioF)),
+                rowBytes);
+    m_transparencyRows.setDevicePixelRatio(m_devicePixelRatioF);
+    return m_transparencyRows;
+}
+
+/** @brief Key for caches.
+ *
+ * @returns A key that contains everything that influences the image
+ * content. Two objects with the same key render identical images. The
+ * key is used for example by @ref SharedImageCache. */
+QByteArray GradientImage::cacheKey() const
+{
+    QByteArray result;
+    QDataStream stream(&result, QIODevice::WriteOnly);
+    stream << QByteArrayLiteral("GradientImage") //
+           << m_rgbColorSpace->profileIdentifier() //
+           << m_gradientLength //
+           << m_gradientThickness //
+           << m_devicePixelRatioF //
+           << m_firstColorCorrected.l //
+           << m_firstColorCorrected.c //
+           << m_firstColorCorrected.h //
+           << m_firstColorCorrected.a //
+           << m_secondColorCorrectedAndAltered.l //
+           << m_secondColorCorrectedAndAltered.c //
+           << m_secondColorCorrectedAndAltered.h //
+           << m_secondColorCorrectedAndAltered.a;
+    return result;
+}
+
 /** @brief The color that the gradient has at a given position of the gradient.
  * @param value The position. Valid range: <tt>[0.0, 1.0]</tt>. <tt>0.0</tt>
  * means the first color, <tt>1.0</tt> means the second color, and everything
@@ -30,6 +30,7 @@
 #include "PerceptualColor/perceptualcolorglobal.h"
 #include "perceptualcolorinternal.h"
 
+#include <QByteArray>
 #include <QImage>
 #include <QSharedPointer>
 
@@ -86,6 +87,7 @@ class GradientImage final
 {
 public:
     explicit GradientImage(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace);
+    QByteArray cacheKey() const;
     LchaDouble colorFromValue(qreal value) const;
     QImage getImage();
     void setDevicePixelRatioF(const qreal newDevicePixelRatioF);
@@ -102,6 +104,7 @@ private:
 
     // Methods
     static LchaDouble completlyNormalizedAndBounded(const LchaDouble &color);
+    QImage transparencyRows();
     void updateSecondColor();
 
     // Data members
@@ -150,6 +153,10 @@ private:
      * @sa @ref completlyNormalizedAndBounded()
      * @sa @ref updateSecondColor() */
     LchaDouble m_secondColorCorrectedAndAltered;
+    /** @brief Cache for @ref transparencyRows()
+     *
+     * Does not depend on the colors, so it survives color changes. */
+    QImage m_transparencyRows;
 };
 
 } // namespace PerceptualColor
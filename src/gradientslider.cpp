@@ -40,6 +40,7 @@
 #include <QPainter>
 
 #include <helper.h>
+#include <instrumentationscope.h>
 
 namespace PerceptualColor
 {
@@ -177,11 +178,7 @@ void GradientSlider::setColors(const PerceptualColor::LchaDouble &newFirstColor,
 void GradientSlider::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
-    d_pointer->m_gradientImageCache.setGradientLength(d_pointer->physicalPixelLength());
-    d_pointer->m_gradientImageCache.setGradientThickness(
-        // Normally, this should not change, but maybe on Hight-DPI
-        // devices there might be some differences.
-        d_pointer->physicalPixelThickness());
+    d_pointer->updateGradientImageGeometry();
 }
 
 /** @brief Recommended size for the widget
@@ -430,11 +427,7 @@ void GradientSlider::GradientSliderPrivate::setOrientationWithoutSignalAndForceN
         q_pointer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     }
     m_orientation = newOrientation;
-    m_gradientImageCache.setGradientLength(physicalPixelLength());
-    m_gradientImageCache.setGradientThickness(
-        // Normally, this should not change, but maybe on Hight-DPI
-        // devices there are some differences.
-        physicalPixelThickness());
+    updateGradientImageGeometry();
     // Notify the layout system the the geometry has changed
     q_pointer->updateGeometry();
 }
@@ -450,6 +443,23 @@ void GradientSlider::setOrientation(Qt::Orientation newOrientation)
     }
 }
 
+/** @brief Applies the current widget geometry to
+ * @ref m_gradientImageCache.
+ *
+ * Sets the device pixel ratio, the length and the thickness of the
+ * gradient image. The setters of @ref GradientImage only invalidate
+ * the image if a value has actually changed, so calling this function
+ * is cheap as long as the geometry stays the same. */
+void GradientSlider::GradientSliderPrivate::updateGradientImageGeometry()
+{
+    m_gradientImageCache.setDevicePixelRatioF(q_pointer->devicePixelRatioF());
+    m_gradientImageCache.setGradientLength(physicalPixelLength());
+    m_gradientImageCache.setGradientThickness(
+        // Normally, this should not change, but maybe on Hight-DPI
+        // devices there are some differences.
+        physicalPixelThickness());
+}
+
 /** @brief The rounded length of the widget
  * measured in <em>physical pixels</em>.
  *
@@ -514,70 +524,20 @@ qreal GradientSlider::GradientSliderPrivate::fromWidgetPixelPositionToValue(QPoi
  * @param event the paint event */
 void GradientSlider::paintEvent(QPaintEvent *event)
 {
+    const InstrumentationScope instrumentationScope("GradientSlider::paintEvent");
     Q_UNUSED(event);
-    // We do not paint directly on the widget, but on a QImage buffer first:
-    // Render anti-aliased looks better. But as Qt documentation says:
-    //
-    //      “Renderhints are used to specify flags to QPainter that may or
-    //       may not be respected by any given engine.”
-    //
-    // Painting here directly on the widget might lead to different
-    // anti-aliasing results depending on the underlying window system. This
-    // is especially problematic as anti-aliasing might shift or not a pixel
-    // to the left or to the right. So we paint on a QImage first. As QImage
-    // (at difference to QPixmap and a QWidget) is independent of native
-    // platform rendering, it guarantees identical anti-aliasing results on
-    // all platforms. Here the quote from QPainter class documentation:
-    //
-    //      “To get the optimal rendering result using QPainter, you should
-    //       use the platform independent QImage as paint device; i.e. using
-    //       QImage will ensure that the result has an identical pixel
-    //       representation on any platform.”
-    QImage paintBuffer;
-
-    // Paint the gradient itself.
-    // Make sure the image will be correct. We set length and thicknes,
+
+    // Make sure the gradient image will be correct. We set the geometry,
     // just to be sure (we might have missed a resize event). Also,
     // the device pixel ratio float might have changed because the
     // window has been moved to another screen. We do not update the
     // first and the second color because we have complete control
     // about these values and are sure the any changes have yet been
-    // applied.
-    d_pointer->m_gradientImageCache.setDevicePixelRatioF(devicePixelRatioF());
-    d_pointer->m_gradientImageCache.setGradientLength(d_pointer->physicalPixelLength());
-    d_pointer->m_gradientImageCache.setGradientThickness(
-        // Normally, this should not change, but maybe on Hight-DPI
-        // devices there are some differences.
-        d_pointer->physicalPixelLength());
-    paintBuffer = d_pointer->m_gradientImageCache.getImage();
+    // applied. As long as nothing has changed, the cached image is
+    // used without rendering anything.
+    d_pointer->updateGradientImageGeometry();
+    const QImage gradientImage = d_pointer->m_gradientImageCache.getImage();
 
-    // Draw slider handle
-    QPainter bufferPainter(&paintBuffer);
-    // We use antialiasing. As our current handle is just a horizontal or
-    // vertical line, it might be slightly sharper without antialiasing.
-    // But all other widgets of this library WILL USE antialiasing because
-    // their handles are not perfectly horizontal or vertical and without
-    // antialiasing they might look terrible. Now, when antialiasing is NOT
-    // used, the line thickness is rounded. This would lead to a different
-    // thickness in this widget compared to the other widgets. This is not
-    // a good idea. Therefore, we USE antialiasing here. Anyway, in practical
-    // tests, it seems almost as sharp as without antialiasing, and
-    // additionally the position is more exact!
-    bufferPainter.setRenderHint(QPainter::Antialiasing, true);
-    QPen pen;
-    const qreal handleCoordinatePoint = d_pointer->physicalPixelLength() / devicePixelRatioF() * d_pointer->m_value;
-    if (hasFocus()) {
-        pen.setWidthF(handleOutlineThickness() * 3);
-        pen.setColor(focusIndicatorColor());
-        bufferPainter.setPen(pen);
-        bufferPainter.drawLine(QPointF(handleCoordinatePoint, 0), QPointF(handleCoordinatePoint, gradientThickness()));
-    }
-    pen.setWidthF(handleOutlineThickness());
-    pen.setColor(handleColorFromBackgroundLightness(d_pointer->m_gradientImageCache.colorFromValue(d_pointer->m_value).l));
-    bufferPainter.setPen(pen);
-    bufferPainter.drawLine(QPointF(handleCoordinatePoint, 0), QPointF(handleCoordinatePoint, gradientThickness()));
-
-    // Paint the buffer to the actual widget
     QTransform transform;
     // The m_gradientImageCache contains the gradient always
     // in a default form, independant of the actual orientation
@@ -606,7 +566,38 @@ void GradientSlider::paintEvent(QPaintEvent *event)
     }
     QPainter widgetPainter(this);
     widgetPainter.setTransform(transform);
-    widgetPainter.drawImage(0, 0, paintBuffer);
+
+    // Paint the gradient itself. The cached image is painted as-is:
+    // Painting the handle into it would force a deep copy of the
+    // image on each paint event.
+    widgetPainter.drawImage(0, 0, gradientImage);
+
+    // Draw slider handle as overlay, using the same transform as
+    // the gradient.
+    //
+    // We use antialiasing. As our current handle is just a horizontal or
+    // vertical line, it might be slightly sharper without antialiasing.
+    // But all other widgets of this library WILL USE antialiasing because
+    // their handles are not perfectly horizontal or vertical and without
+    // antialiasing they might look terrible. Now, when antialiasing is NOT
+    // used, the line thickness is rounded. This would lead to a different
+    // thickness in this widget compared to the other widgets. This is not
+    // a good idea. Therefore, we USE antialiasing here. Anyway, in practical
+    // tests, it seems almost as sharp as without antialiasing, and
+    // additionally the position is more exact!
+    widgetPainter.setRenderHint(QPainter::Antialiasing, true);
+    QPen pen;
+    const qreal handleCoordinatePoint = d_pointer->physicalPixelLength() / devicePixelRatioF() * d_pointer->m_value;
+    if (hasFocus()) {
+        pen.setWidthF(handleOutlineThickness() * 3);
+        pen.setColor(focusIndicatorColor());
+        widgetPainter.setPen(pen);
+        widgetPainter.drawLine(QPointF(handleCoordinatePoint, 0), QPointF(handleCoordinatePoint, gradientThickness()));
+    }
+    pen.setWidthF(handleOutlineThickness());
+    pen.setColor(handleColorFromBackgroundLightness(d_pointer->m_gradientImageCache.colorFromValue(d_pointer->m_value).l));
+    widgetPainter.setPen(pen);
+    widgetPainter.drawLine(QPointF(handleCoordinatePoint, 0), QPointF(handleCoordinatePoint, gradientThickness()));
 
     //     // TODO Draw a focus rectangle like this?:
     //     widgetPainter.setTransform(QTransform());
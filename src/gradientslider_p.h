@@ -58,6 +58,7 @@ public:
     void setOrientationWithoutSignalAndForceNewSizePolicy(Qt::Orientation newOrientation);
     int physicalPixelLength() const;
     int physicalPixelThickness() const;
+    void updateGradientImageGeometry();
 
     // Data members
     /** @brief Internal storage for property @ref firstColor */
@@ -128,8 +128,7 @@ QImage transparencyBackground(qreal devicePixelRatioF)
     constexpr int lightnessDistance = 15;
     constexpr int lightnessOne = 127 - lightnessDistance;
     constexpr int lightnessTwo = 128 + lightnessDistance;
-    constexpr int squareSizeInLogicalPixel = 10;
-    const int squareSize = qRound(squareSizeInLogicalPixel * devicePixelRatioF);
+    const int squareSize = transparencySquareSize(devicePixelRatioF);
 
     QImage temp(squareSize * 2, squareSize * 2, QImage::Format_RGB32);
     temp.fill(QColor(lightnessOne, lightnessOne, lightnessOne));
@@ -141,6 +140,20 @@ QImage transparencyBackground(qreal devicePixelRatioF)
     return temp;
 }
 
+/** @internal
+ *
+ * @brief Size of the squares of the @ref transparencyBackground()
+ *
+ * @param devicePixelRatioF the device pixel ratio
+ * @returns The side length of a single square of the checkerboard,
+ * measured in physical pixels. The checkerboard tile has twice this
+ * size. */
+int transparencySquareSize(qreal devicePixelRatioF)
+{
+    constexpr int squareSizeInLogicalPixel = 10;
+    return qRound(squareSizeInLogicalPixel * devicePixelRatioF);
+}
+
 /** @internal
  *
  * @brief Round floating point numbers to a certain number of digits
@@ -95,6 +95,17 @@ template<typename T> bool isInRange(const T &low, const T &x, const T &high)
  * to be sure. */
 constexpr int overlap = 2;
 
+/** @internal
+ *
+ * @brief Resolution divisor for images that are rendered while an
+ * interaction is in progress.
+ *
+ * A divisor of <tt>2</tt> means half of the resolution in each
+ * direction, so only a quarter of the pixels has to be calculated.
+ *
+ * @sa @ref AbstractDiagram::isInteractionInProgress() */
+constexpr int interactiveResolutionDivisor = 2;
+
 /** @internal
  *
  * @brief Proposed scale factor for gradients
@@ -247,6 +258,8 @@ LchDouble toLchDouble(const cmsCIELCh &value);
 
 QImage transparencyBackground(qreal devicePixelRatioF);
 
+int transparencySquareSize(qreal devicePixelRatioF);
+
 } // namespace PerceptualColor
 
 #endif // HELPER_H
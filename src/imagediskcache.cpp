@@ -0,0 +1,337 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "PerceptualColor/imagediskcache.h"
+
+#include "instrumentationscope.h"
+#include "version.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+
+namespace PerceptualColor
+{
+namespace
+{
+/** @internal @brief Identifies the cache files of this library. */
+constexpr quint32 fileMagicNumber = 0x50434943;
+/** @internal @brief Version of the file format.
+ *
+ * Increment this value when the file format changes. */
+constexpr quint32 fileFormatVersion = 1;
+/** @internal @brief Default value for @ref ImageDiskCache::maximumSize(). */
+constexpr qint64 defaultMaximumSize = 64 * 1024 * 1024;
+
+/** @internal @brief Global state of @ref ImageDiskCache. */
+struct ImageDiskCacheState {
+    /** @brief Protects all other members.
+     *
+     * Reading, writing and (de)compressing the images happens without
+     * holding this lock. This is safe because files are replaced
+     * atomically (see <tt>QSaveFile</tt>) and the key is stored and
+     * checked within each file. */
+    QMutex mutex;
+    /** @brief Store for @ref ImageDiskCache::isEnabled() */
+    bool isEnabled = false;
+    /** @brief Store for @ref ImageDiskCache::maximumSize() */
+    qint64 maximumSize = defaultMaximumSize;
+    /** @brief Estimated total size of the cache files, measured in
+     * bytes, or <tt>-1</tt> if unknown.
+     *
+     * Updated when files are stored, so that the directory has only to
+     * be scanned (see @ref ImageDiskCache::prune()) when the estimate
+     * exceeds the maximum size. The estimate might be too big (for
+     * example when a file is replaced), but that only leads to an
+     * earlier scan, which recalculates the actual value. */
+    qint64 totalSize = -1;
+};
+
+/** @internal @brief The global state of @ref ImageDiskCache.
+ *
+ * @returns The global state. */
+ImageDiskCacheState &state()
+{
+    static ImageDiskCacheState globalState;
+    return globalState;
+}
+
+/** @internal @brief The file suffix of the cache files. */
+QString fileSuffix()
+{
+    return QStringLiteral("perceptualcolorimage");
+}
+
+} // namespace
+
+/** @brief Removes all images from the cache.
+ *
+ * This works also when the cache is disabled. */
+void ImageDiskCache::clear()
+{
+    QMutexLocker locker(&state().mutex);
+    QDir cacheDirectory(directory());
+    const QStringList files = cacheDirectory.entryList( //
+        QStringList(QStringLiteral("*.") + fileSuffix()),
+        QDir::Files);
+    for (const QString &file : files) {
+        cacheDirectory.remove(file);
+    }
+    state().totalSize = 0;
+}
+
+/** @brief The directory of the cache.
+ *
+ * @returns The directory where the cache files are stored. It is located
+ * within <tt>QStandardPaths::CacheLocation</tt>. */
+QString ImageDiskCache::directory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) //
+        + QStringLiteral("/perceptualcolor");
+}
+
+/** @brief If the disk cache is enabled.
+ *
+ * @returns If the disk cache is enabled. Default value: <tt>false</tt>
+ *
+ * @sa @ref setEnabled() */
+bool ImageDiskCache::isEnabled()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().isEnabled;
+}
+
+/** @brief Maximum total size of the cache files.
+ *
+ * @returns The maximum total size of the cache files, measured in bytes.
+ * Default value: 64 MiB.
+ *
+ * @sa @ref setMaximumSize() */
+qint64 ImageDiskCache::maximumSize()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().maximumSize;
+}
+
+/** @brief Setter for @ref isEnabled().
+ *
+ * @param enabled The new value. */
+void ImageDiskCache::setEnabled(const bool enabled)
+{
+    QMutexLocker locker(&state().mutex);
+    state().isEnabled = enabled;
+}
+
+/** @brief Setter for @ref maximumSize().
+ *
+ * If the cache is enabled and yet bigger than the new maximum size, the
+ * least recently used images are deleted immediately.
+ *
+ * @param newMaximumSize The new maximum size, measured in bytes.
+ * Negative values are treated as <tt>0</tt>. */
+void ImageDiskCache::setMaximumSize(const qint64 newMaximumSize)
+{
+    QMutexLocker locker(&state().mutex);
+    state().maximumSize = qMax<qint64>(newMaximumSize, 0);
+    if (state().isEnabled) {
+        prune();
+    }
+}
+
+/** @brief The file name for a cache key.
+ *
+ * @param key The cache key.
+ * @returns The absolute file name. The library version is part of the
+ * file name, so that images of other versions (which might render
+ * differently) are never used. */
+QString ImageDiskCache::fileName(const QByteArray &key)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(perceptualColorRunTimeVersion().toString().toUtf8());
+    hash.addData(key);
+    return directory() //
+        + QStringLiteral("/") //
+        + QString::fromLatin1(hash.result().toHex()) //
+        + QStringLiteral(".") //
+        + fileSuffix();
+}
+
+/** @brief Loads an image from the cache.
+ *
+ * @param key The cache key. It must contain everything that influences
+ * the image content: The profile and all image parameters.
+ * @returns The image, in the format
+ * <tt>QImage::Format_ARGB32_Premultiplied</tt>, if it is available in
+ * the cache. A null image otherwise, and also when the cache
+ * is disabled. */
+QImage ImageDiskCache::load(const QByteArray &key)
+{
+    if (!isEnabled()) {
+        return QImage();
+    }
+    const InstrumentationScope instrumentationScope("ImageDiskCache::load");
+
+    QFile file(fileName(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        InstrumentationScope::count("ImageDiskCache miss");
+        return QImage();
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magicNumber = 0;
+    quint32 formatVersion = 0;
+    QByteArray storedKey;
+    qint32 width = 0;
+    qint32 height = 0;
+    qint32 bytesPerLine = 0;
+    QByteArray compressedData;
+    stream >> magicNumber >> formatVersion >> storedKey;
+    // Check the key itself, and not only its hash (which is the file name).
+    if ((stream.status() != QDataStream::Ok) //
+        || (magicNumber != fileMagicNumber) //
+        || (formatVersion != fileFormatVersion) //
+        || (storedKey != key)) {
+        InstrumentationScope::count("ImageDiskCache miss");
+        return QImage();
+    }
+    stream >> width >> height >> bytesPerLine >> compressedData;
+    if ((stream.status() != QDataStream::Ok) || (width <= 0) || (height <= 0)) {
+        InstrumentationScope::count("ImageDiskCache miss");
+        return QImage();
+    }
+    QImage result(width, height, QImage::Format_ARGB32_Premultiplied);
+    const QByteArray data = qUncompress(compressedData);
+    if (result.isNull() //
+        || (result.bytesPerLine() != bytesPerLine) //
+        || (data.size() != bytesPerLine * height)) {
+        InstrumentationScope::count("ImageDiskCache miss");
+        return QImage();
+    }
+    std::memcpy(result.bits(), data.constData(), static_cast<std::size_t>(data.size()));
+
+    // Mark as recently used. (This requires an open file.)
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    InstrumentationScope::count("ImageDiskCache hit");
+    return result;
+}
+
+/** @brief Deletes the least recently used images until the cache
+ * is not bigger than @ref maximumSize().
+ *
+ * Also updates the estimated total size.
+ *
+ * @pre The caller holds the lock. */
+void ImageDiskCache::prune()
+{
+    QDir cacheDirectory(directory());
+    // Sorted by modification time, the most recently used first.
+    const QFileInfoList files = cacheDirectory.entryInfoList( //
+        QStringList(QStringLiteral("*.") + fileSuffix()),
+        QDir::Files,
+        QDir::Time);
+    qint64 totalSize = 0;
+    bool isFull = false;
+    for (const QFileInfo &file : files) {
+        isFull = isFull || (totalSize + file.size() > state().maximumSize);
+        if (isFull) {
+            cacheDirectory.remove(file.fileName());
+        } else {
+            totalSize += file.size();
+        }
+    }
+    state().totalSize = totalSize;
+}
+
+/** @brief Stores an image in the cache.
+ *
+ * Does nothing when the cache is disabled.
+ *
+ * @param key The cache key. It must contain everything that influences
+ * the image content: The profile and all image parameters.
+ * @param image The image. Must have the format
+ * <tt>QImage::Format_ARGB32_Premultiplied</tt>. */
+void ImageDiskCache::store(const QByteArray &key, const QImage &image)
+{
+    if (!isEnabled() || image.isNull()) {
+        return;
+    }
+    Q_ASSERT(image.format() == QImage::Format_ARGB32_Premultiplied);
+
+    if (!QDir().mkpath(directory())) {
+        return;
+    }
+    // QSaveFile writes to a temporary file and renames it only when
+    // everything has been written. So other threads and processes
+    // never see incomplete files.
+    QSaveFile file(fileName(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    const int byteCount = image.bytesPerLine() * image.height();
+    stream << fileMagicNumber //
+           << fileFormatVersion //
+           << key //
+           << static_cast<qint32>(image.width()) //
+           << static_cast<qint32>(image.height()) //
+           << static_cast<qint32>(image.bytesPerLine()) //
+           << qCompress(reinterpret_cast<const uchar *>(image.constBits()), byteCount);
+    if (stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return;
+    }
+    if (!file.commit()) {
+        return;
+    }
+    const qint64 fileSize = QFileInfo(file.fileName()).size();
+
+    QMutexLocker locker(&state().mutex);
+    if (state().totalSize >= 0) {
+        state().totalSize += fileSize;
+    }
+    // Scan the directory only if necessary: If the size is not yet
+    // known, or if the cache is probably too big.
+    if ((state().totalSize < 0) || (state().totalSize > state().maximumSize)) {
+        prune();
+    }
+}
+
+} // namespace PerceptualColor
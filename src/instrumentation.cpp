@@ -0,0 +1,400 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "PerceptualColor/instrumentation.h"
+
+#include "instrumentationscope.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QVector>
+
+namespace PerceptualColor
+{
+Q_LOGGING_CATEGORY(instrumentationCategory, "perceptualcolor.instrumentation")
+
+namespace
+{
+/** @internal @brief Value for @ref Instrumentation::maximumEventCount(). */
+constexpr int maximumEvents = 1000000;
+
+/** @internal @brief A recorded timing scope. */
+struct TraceEvent {
+    /** @brief The name of the scope. */
+    const char *name;
+    /** @brief Start time, measured in microseconds. */
+    qint64 startMicroseconds;
+    /** @brief Duration, measured in microseconds. */
+    qint64 durationMicroseconds;
+    /** @brief The thread, as returned by @ref currentThreadNumber(). */
+    int threadNumber;
+};
+
+/** @internal @brief The counters of a single thread. */
+struct ThreadCounters {
+    /** @brief Protects @ref values.
+     *
+     * Only the owning thread writes, so this mutex is contended only
+     * while the counters are read or reset. */
+    QMutex mutex;
+    /** @brief The counter values.
+     *
+     * The key is the address of the name. Identical names at different
+     * addresses are merged when the counters are read. */
+    QHash<const char *, quint64> values;
+};
+
+/** @internal @brief Global state of @ref Instrumentation. */
+struct InstrumentationState {
+    InstrumentationState();
+    /** @brief Store for @ref Instrumentation::isEnabled()
+     *
+     * Atomic, so that it can be read without locking the mutex. */
+    QAtomicInt isEnabled {0};
+    /** @brief Reference clock for all timestamps. */
+    QElapsedTimer clock;
+    /** @brief Protects all following members. */
+    QMutex mutex;
+    /** @brief The counters of all threads that have counted something.
+     *
+     * The entries are kept when their thread finishes, so that its
+     * counts are not lost. */
+    QVector<QSharedPointer<ThreadCounters>> counters;
+    /** @brief The recorded timing scopes. */
+    QVector<TraceEvent> events;
+    /** @brief Store for @ref Instrumentation::traceFileName() */
+    QString traceFileName;
+};
+
+/** @internal @brief Writes the trace when the application exits.
+ *
+ * Registered with <tt>qAddPostRoutine()</tt>. */
+void writeTraceAtExit()
+{
+    const QString fileName = Instrumentation::traceFileName();
+    if (Instrumentation::isEnabled() && !fileName.isEmpty()) {
+        Instrumentation::writeTrace(fileName);
+    }
+}
+
+/** @internal @brief Constructor
+ *
+ * Reads the environment variables. */
+InstrumentationState::InstrumentationState()
+{
+    clock.start();
+    traceFileName = QString::fromLocal8Bit(qgetenv("PERCEPTUALCOLOR_TRACE_FILE"));
+    const bool enabled = //
+        (qEnvironmentVariableIntValue("PERCEPTUALCOLOR_INSTRUMENTATION") != 0) //
+        || !traceFileName.isEmpty();
+    isEnabled.storeRelease(enabled ? 1 : 0);
+    qAddPostRoutine(writeTraceAtExit);
+}
+
+/** @internal @brief The global state of @ref Instrumentation.
+ *
+ * @returns The global state. */
+InstrumentationState &state()
+{
+    static InstrumentationState globalState;
+    return globalState;
+}
+
+/** @internal @brief A small number that identifies the current thread.
+ *
+ * @returns A number that identifies the current thread. Unlike
+ * <tt>QThread::currentThreadId()</tt>, it is small and portable, which
+ * makes the trace more readable. The first thread that asks gets
+ * <tt>1</tt>. */
+int currentThreadNumber()
+{
+    static QAtomicInt lastThreadNumber {0};
+    thread_local const int threadNumber = lastThreadNumber.fetchAndAddOrdered(1) + 1;
+    return threadNumber;
+}
+
+/** @internal @brief The counters of the current thread.
+ *
+ * @returns The counters of the current thread. They are registered
+ * in @ref InstrumentationState::counters when the thread asks the
+ * first time. */
+ThreadCounters &currentThreadCounters()
+{
+    thread_local const QSharedPointer<ThreadCounters> threadCounters = []() {
+        QSharedPointer<ThreadCounters> newCounters(new ThreadCounters);
+        QMutexLocker locker(&state().mutex);
+        state().counters.append(newCounters);
+        return newCounters;
+    }();
+    return *threadCounters;
+}
+
+} // namespace
+
+/** @brief The counters.
+ *
+ * @returns The current value of all counters that have been incremented
+ * since the last @ref reset(), by name. Available counters:
+ * | Name                            | Description
+ * | :------------------------------ | :----------
+ * | <tt>cmsDoTransform</tt>         | Calls of the LittleCMS transform function
+ * | <tt>SharedImageCache hit</tt>   | Images found in the @ref SharedImageCache
+ * | <tt>SharedImageCache miss</tt>  | Images not found in the @ref SharedImageCache
+ * | <tt>ImageDiskCache hit</tt>     | Images found in the @ref ImageDiskCache
+ * | <tt>ImageDiskCache miss</tt>    | Images not found in the enabled @ref ImageDiskCache
+ * | <tt>GamutSlice cache hit</tt>   | Gamut slices reused for gamut mapping
+ * | <tt>GamutSlice cache miss</tt>  | Gamut slices calculated for gamut mapping */
+QMap<QString, quint64> Instrumentation::counters()
+{
+    QMutexLocker locker(&state().mutex);
+    QMap<QString, quint64> result;
+    for (const QSharedPointer<ThreadCounters> &threadCounters : qAsConst(state().counters)) {
+        QMutexLocker threadLocker(&threadCounters->mutex);
+        for (auto it = threadCounters->values.constBegin(); it != threadCounters->values.constEnd(); ++it) {
+            result[QString::fromUtf8(it.key())] += it.value();
+        }
+    }
+    return result;
+}
+
+/** @brief Number of recorded timing scopes.
+ *
+ * @returns The number of timing scopes that have been recorded
+ * since the last @ref reset().
+ *
+ * @sa @ref maximumEventCount() */
+int Instrumentation::eventCount()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().events.count();
+}
+
+/** @brief If the instrumentation is enabled.
+ *
+ * @returns If the instrumentation is enabled. The default value depends
+ * on the environment variables (see class documentation).
+ *
+ * @sa @ref setEnabled() */
+bool Instrumentation::isEnabled()
+{
+    return state().isEnabled.loadAcquire() != 0;
+}
+
+/** @brief Maximum number of recorded timing scopes.
+ *
+ * @returns The maximum number of timing scopes that are recorded. This
+ * limits the memory usage of long-running applications to some
+ * dozens of MiB.
+ *
+ * @sa @ref eventCount() */
+int Instrumentation::maximumEventCount()
+{
+    return maximumEvents;
+}
+
+/** @brief Removes all recorded timing scopes and resets all counters. */
+void Instrumentation::reset()
+{
+    QMutexLocker locker(&state().mutex);
+    for (const QSharedPointer<ThreadCounters> &threadCounters : qAsConst(state().counters)) {
+        QMutexLocker threadLocker(&threadCounters->mutex);
+        threadCounters->values.clear();
+    }
+    state().events.clear();
+}
+
+/** @brief Setter for @ref isEnabled().
+ *
+ * Timing scopes that have started before enabling are not recorded.
+ * Already recorded data is kept when disabling; use @ref reset() to
+ * remove it.
+ *
+ * @param enabled The new value. */
+void Instrumentation::setEnabled(const bool enabled)
+{
+    state().isEnabled.storeRelease(enabled ? 1 : 0);
+}
+
+/** @brief Setter for @ref traceFileName().
+ *
+ * @param fileName The new file name. */
+void Instrumentation::setTraceFileName(const QString &fileName)
+{
+    QMutexLocker locker(&state().mutex);
+    state().traceFileName = fileName;
+}
+
+/** @brief The file to which the trace is written automatically.
+ *
+ * @returns The file to which the trace is written automatically
+ * when the <tt>QCoreApplication</tt> object is destroyed. An empty
+ * string means that the trace is not written automatically. The
+ * default value is the value of the environment variable
+ * <tt>PERCEPTUALCOLOR_TRACE_FILE</tt>.
+ *
+ * @sa @ref setTraceFileName()
+ * @sa @ref writeTrace() */
+QString Instrumentation::traceFileName()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().traceFileName;
+}
+
+/** @brief Writes the recorded data as Chrome trace.
+ *
+ * The timing scopes are written as complete events (<tt>"ph": "X"</tt>),
+ * the counters as counter events (<tt>"ph": "C"</tt>). All timestamps
+ * are measured in microseconds since the library has been used the
+ * first time.
+ *
+ * Also logs a summary of the counters to the logging category
+ * <tt>perceptualcolor.instrumentation</tt> at info level.
+ *
+ * This works also when the instrumentation is disabled.
+ *
+ * @param fileName The name of the JSON file. An existing file is
+ * overwritten.
+ * @returns <tt>true</tt> on success, <tt>false</tt> otherwise. */
+bool Instrumentation::writeTrace(const QString &fileName)
+{
+    const QMap<QString, quint64> counterValues = counters();
+    QVector<TraceEvent> events;
+    {
+        QMutexLocker locker(&state().mutex);
+        events = state().events;
+    }
+    const double processId = static_cast<double>(QCoreApplication::applicationPid());
+    const double now = static_cast<double>(timestampMicroseconds());
+
+    QJsonArray traceEvents;
+    QJsonObject processName;
+    processName.insert(QStringLiteral("name"), QStringLiteral("process_name"));
+    processName.insert(QStringLiteral("ph"), QStringLiteral("M"));
+    processName.insert(QStringLiteral("pid"), processId);
+    QJsonObject processNameArguments;
+    processNameArguments.insert(QStringLiteral("name"), QStringLiteral("PerceptualColor"));
+    processName.insert(QStringLiteral("args"), processNameArguments);
+    traceEvents.append(processName);
+    for (const TraceEvent &event : qAsConst(events)) {
+        QJsonObject object;
+        object.insert(QStringLiteral("name"), QString::fromUtf8(event.name));
+        object.insert(QStringLiteral("cat"), QStringLiteral("perceptualcolor"));
+        object.insert(QStringLiteral("ph"), QStringLiteral("X"));
+        object.insert(QStringLiteral("ts"), static_cast<double>(event.startMicroseconds));
+        object.insert(QStringLiteral("dur"), static_cast<double>(event.durationMicroseconds));
+        object.insert(QStringLiteral("pid"), processId);
+        object.insert(QStringLiteral("tid"), event.threadNumber);
+        traceEvents.append(object);
+    }
+    for (auto it = counterValues.constBegin(); it != counterValues.constEnd(); ++it) {
+        QJsonObject object;
+        object.insert(QStringLiteral("name"), it.key());
+        object.insert(QStringLiteral("cat"), QStringLiteral("perceptualcolor"));
+        object.insert(QStringLiteral("ph"), QStringLiteral("C"));
+        object.insert(QStringLiteral("ts"), now);
+        object.insert(QStringLiteral("pid"), processId);
+        QJsonObject arguments;
+        arguments.insert(QStringLiteral("value"), static_cast<double>(it.value()));
+        object.insert(QStringLiteral("args"), arguments);
+        traceEvents.append(object);
+        qCInfo(instrumentationCategory).nospace() << qUtf8Printable(it.key()) << ": " << it.value();
+    }
+    QJsonObject root;
+    root.insert(QStringLiteral("traceEvents"), traceEvents);
+    root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(instrumentationCategory) << "Could not open trace file" << fileName;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qCWarning(instrumentationCategory) << "Could not write trace file" << fileName;
+        return false;
+    }
+    qCInfo(instrumentationCategory) << "Trace with" << events.count() << "timing scopes written to" << fileName;
+    return true;
+}
+
+/** @brief Records a timing scope.
+ *
+ * Also logs the scope at debug level.
+ *
+ * @param name The name of the scope
+ * @param startMicroseconds The start time, as returned by
+ * @ref timestampMicroseconds()
+ * @param durationMicroseconds The duration */
+void Instrumentation::addEvent(const char *name, const qint64 startMicroseconds, const qint64 durationMicroseconds)
+{
+    const int threadNumber = currentThreadNumber();
+    {
+        QMutexLocker locker(&state().mutex);
+        if (state().events.count() < maximumEvents) {
+            state().events.append(TraceEvent {name, startMicroseconds, durationMicroseconds, threadNumber});
+        }
+    }
+    qCDebug(instrumentationCategory).nospace() << name << ": " << durationMicroseconds << " µs";
+}
+
+/** @brief Increments a counter.
+ *
+ * Each thread has its own counters, so that threads that count at the
+ * same time do not block each other. @ref counters() merges them.
+ *
+ * @param name The name of the counter
+ * @param increment The value to add to the counter. */
+void Instrumentation::addToCounter(const char *name, const quint64 increment)
+{
+    ThreadCounters &threadCounters = currentThreadCounters();
+    QMutexLocker locker(&threadCounters.mutex);
+    threadCounters.values[name] += increment;
+}
+
+/** @brief The current time.
+ *
+ * @returns The time since the library has been used the first time,
+ * measured in microseconds. */
+qint64 Instrumentation::timestampMicroseconds()
+{
+    return state().clock.nsecsElapsed() / 1000;
+}
+
+} // namespace PerceptualColor
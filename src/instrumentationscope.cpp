@@ -0,0 +1,78 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "instrumentationscope.h"
+
+#include "PerceptualColor/instrumentation.h"
+
+namespace PerceptualColor
+{
+/** @brief Constructor
+ *
+ * Starts the timing scope.
+ *
+ * @param name The name of the scope. See the class documentation for
+ * the lifetime requirements. */
+InstrumentationScope::InstrumentationScope(const char *name)
+{
+    if (Instrumentation::isEnabled()) {
+        m_name = name;
+        m_startMicroseconds = Instrumentation::timestampMicroseconds();
+    }
+}
+
+/** @brief Destructor
+ *
+ * Ends the timing scope and records it. */
+InstrumentationScope::~InstrumentationScope() noexcept
+{
+    if (m_name == nullptr) {
+        return;
+    }
+    const qint64 duration = Instrumentation::timestampMicroseconds() - m_startMicroseconds;
+    Instrumentation::addEvent(m_name, m_startMicroseconds, duration);
+}
+
+/** @brief Increments a counter of @ref Instrumentation.
+ *
+ * Does nothing if @ref Instrumentation is disabled.
+ *
+ * @param name The name of the counter. See the class documentation for
+ * the lifetime requirements.
+ * @param increment The value to add to the counter. */
+void InstrumentationScope::count(const char *name, const quint64 increment)
+{
+    if (Instrumentation::isEnabled()) {
+        Instrumentation::addToCounter(name, increment);
+    }
+}
+
+} // namespace PerceptualColor
@@ -0,0 +1,78 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INSTRUMENTATIONSCOPE_H
+#define INSTRUMENTATIONSCOPE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QLoggingCategory>
+#include <QtGlobal>
+
+namespace PerceptualColor
+{
+/** @internal @brief Logging category of @ref Instrumentation. */
+Q_DECLARE_LOGGING_CATEGORY(instrumentationCategory)
+
+/** @internal
+ *
+ * @brief Records a timing scope for @ref Instrumentation.
+ *
+ * The time between construction and destruction of an object of this
+ * class is recorded as a timing scope:
+ *
+ * @snippet test/testinstrumentation.cpp InstrumentationScope usage
+ *
+ * If @ref Instrumentation is disabled at construction time, nothing is
+ * recorded and the overhead is a single atomic load.
+ *
+ * @note The name is not copied. It must be a string literal (or
+ * otherwise stay valid until the end of the program). */
+class InstrumentationScope final
+{
+public:
+    explicit InstrumentationScope(const char *name);
+    ~InstrumentationScope() noexcept;
+    static void count(const char *name, const quint64 increment = 1);
+
+private:
+    Q_DISABLE_COPY(InstrumentationScope)
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestInstrumentation;
+
+    /** @brief The name of the scope, or <tt>nullptr</tt> if nothing
+     * is recorded. */
+    const char *m_name = nullptr;
+    /** @brief Start time, as returned by
+     * @ref Instrumentation::timestampMicroseconds(). */
+    qint64 m_startMicroseconds = 0;
+};
+
+} // namespace PerceptualColor
+
+#endif // INSTRUMENTATIONSCOPE_H
@@ -35,6 +35,8 @@
 #include <QFile>
 #include <QtGlobal>
 
+#include <cstring>
+
 #include <lcms2_plugin.h>
 
 #include "helper.h"
@@ -52,12 +54,28 @@ namespace PerceptualColor
  * been read), <tt>0</tt> is returned. */
 cmsUInt32Number IOHandlerFactory::read(cmsIOHANDLER *iohandler, void *Buffer, cmsUInt32Number size, cmsUInt32Number count)
 {
-    QFile *const myFile = static_cast<QFile *>(iohandler->stream);
-    const cmsUInt32Number numberOfBytesRequested = size * count;
-    const qint64 numberOfBytesRead = myFile->read( //
+    Stream *const myStream = static_cast<Stream *>(iohandler->stream);
+    // Calculate with 64 bit to avoid overflows:
+    const quint64 numberOfBytesRequested = static_cast<quint64>(size) * count;
+    if (myStream->mappedData != nullptr) {
+        const bool isInRange = //
+            (myStream->position <= myStream->size) //
+            && (numberOfBytesRequested <= myStream->size - myStream->position);
+        if (!isInRange) {
+            return 0;
+        }
+        std::memcpy(Buffer, //
+                    myStream->mappedData + myStream->position,
+                    static_cast<std::size_t>(numberOfBytesRequested));
+        // static_cast is okay because we have tested yet that
+        // the value is not bigger than the file size.
+        myStream->position += static_cast<cmsUInt32Number>(numberOfBytesRequested);
+        return count;
+    }
+    const qint64 numberOfBytesRead = myStream->file.read( //
         static_cast<char *>(Buffer),
-        size * count);
-    if (numberOfBytesRead != numberOfBytesRequested) {
+        static_cast<qint64>(numberOfBytesRequested));
+    if (numberOfBytesRead != static_cast<qint64>(numberOfBytesRequested)) {
         return 0;
     }
     return count;
@@ -71,8 +89,14 @@ cmsUInt32Number IOHandlerFactory::read(cmsIOHANDLER *iohandler, void *Buffer, cm
  * occurred. */
 cmsBool IOHandlerFactory::seek(cmsIOHANDLER *iohandler, cmsUInt32Number offset)
 {
-    QFile *const myFile = static_cast<QFile *>(iohandler->stream);
-    const bool seekSucceeded = myFile->seek(offset);
+    Stream *const myStream = static_cast<Stream *>(iohandler->stream);
+    if (myStream->mappedData != nullptr) {
+        // Behave like QFile::seek(), which allows to seek beyond the end
+        // of the file. Subsequent reads will fail then.
+        myStream->position = offset;
+        return true;
+    }
+    const bool seekSucceeded = myStream->file.seek(offset);
     if (!seekSucceeded) {
         qDebug() << QStringLiteral("Seek error; probably corrupted file");
         return false;
@@ -85,8 +109,11 @@ cmsBool IOHandlerFactory::seek(cmsIOHANDLER *iohandler, cmsUInt32Number offset)
  * @returns The position that data is written to or read from. */
 cmsUInt32Number IOHandlerFactory::tell(cmsIOHANDLER *iohandler)
 {
-    const QFile *const myFile = static_cast<QFile *>(iohandler->stream);
-    return static_cast<cmsUInt32Number>(myFile->pos());
+    const Stream *const myStream = static_cast<Stream *>(iohandler->stream);
+    if (myStream->mappedData != nullptr) {
+        return myStream->position;
+    }
+    return static_cast<cmsUInt32Number>(myStream->file.pos());
 }
 
 /** @brief Writes data to stream.
@@ -113,8 +140,8 @@ cmsBool IOHandlerFactory::write(cmsIOHANDLER *iohandler, cmsUInt32Number size, c
  * @returns <tt>true</tt> on success. */
 cmsBool IOHandlerFactory::close(cmsIOHANDLER *iohandler)
 {
-    QFile *const myFile = static_cast<QFile *>(iohandler->stream);
-    delete myFile; // This will also close the file.
+    Stream *const myStream = static_cast<Stream *>(iohandler->stream);
+    delete myStream; // This will also unmap and close the file.
     iohandler->stream = nullptr;
     _cmsFree(iohandler->ContextID, iohandler);
     return true;
@@ -130,6 +157,7 @@ cmsBool IOHandlerFactory::close(cmsIOHANDLER *iohandler)
  * @param fileName Name of the file. See QFile::setFileName() for
  * the valid format. This format is portable, has standardized directory
  * separators and supports Unicode file names on all platforms.
+ * @param access How the file content is accessed.
  * @returns On success, a pointer to a new IO handler. On fail,
  * <tt>nullptr</tt>. The function might fail when the file does not
  * exist or cannot be opened for reading.
@@ -137,7 +165,7 @@ cmsBool IOHandlerFactory::close(cmsIOHANDLER *iohandler)
  * @note The type of the return value is not fully defined
  * in <tt>lcms2.h</tt> but in <tt>lcms2_plugin.h</tt>. However, as
  * the return value is just a pointer, this should make any problems. */
-cmsIOHANDLER *IOHandlerFactory::createReadOnly(cmsContext ContextID, const QString &fileName)
+cmsIOHANDLER *IOHandlerFactory::createReadOnly(cmsContext ContextID, const QString &fileName, const FileAccess access)
 {
     cmsIOHANDLER *const result = static_cast<cmsIOHANDLER *>( //
         _cmsMallocZero(ContextID, sizeof(cmsIOHANDLER))       //
@@ -146,13 +174,11 @@ cmsIOHANDLER *IOHandlerFactory::createReadOnly(cmsContext ContextID, const QStri
         return nullptr;
     }
 
-    QFile *const fileObject = new QFile(fileName);
-    if (fileObject == nullptr) {
-        return nullptr;
-    }
+    Stream *const streamObject = new Stream;
+    streamObject->file.setFileName(fileName);
 
-    const bool openSucceeded = fileObject->open(QIODevice::ReadOnly);
-    const qint64 fileSize = fileObject->size();
+    const bool openSucceeded = streamObject->file.open(QIODevice::ReadOnly);
+    const qint64 fileSize = streamObject->file.size();
     // Check if the size is not negative (this might be an error indicator)
     // neither too big for LittleCMS’s data types:
     const bool isFileSizeOkay = PerceptualColor::isInRange<qint64>( //
@@ -160,17 +186,75 @@ cmsIOHANDLER *IOHandlerFactory::createReadOnly(cmsContext ContextID, const QStri
         fileSize,
         std::numeric_limits<cmsInt32Number>::max());
     if ((!openSucceeded) || (!isFileSizeOkay)) {
-        delete fileObject;
+        delete streamObject;
         _cmsFree(ContextID, result);
         return nullptr;
     }
 
+    if ((access == FileAccess::MemoryMapped) && (fileSize > 0)) {
+        // If the mapping fails, mappedData stays nullptr, and
+        // the buffered reads are used instead.
+        streamObject->mappedData = streamObject->file.map(0, fileSize);
+        // static_cast is okay because we have tested yet that
+        // the file is not that big.
+        streamObject->size = static_cast<cmsUInt32Number>(fileSize);
+    }
+
     // Initialize data members
     result->ContextID = ContextID;
     // static_cast loses integer precision: 'qint64' to 'cmsInt32Number'.
     // This is okay because we have tested yet that the file is not that big.
     result->ReportedSize = static_cast<cmsUInt32Number>(fileSize);
-    result->stream = static_cast<void *>(fileObject);
+    result->stream = static_cast<void *>(streamObject);
+    result->UsedSpace = 0;
+    result->PhysicalFile[0] = 0;
+
+    // Initialize function pointers
+    result->Read = read;
+    result->Seek = seek;
+    result->Close = close;
+    result->Tell = tell;
+    result->Write = write;
+
+    return result;
+}
+
+/** @brief Create a read-only LittleCMS IO handler for in-memory data.
+ *
+ * Unlike <tt>cmsOpenIOhandlerFromMem()</tt>, which copies the data, this
+ * handler reads the data in place.
+ *
+ * The handler has to be deleted with <tt>cmsCloseIOhandler</tt>
+ * to free memory once it is not used anymore.
+ *
+ * @param ContextID Handle to user-defined context, or <tt>nullptr</tt> for
+ * the global context
+ * @param data The data. The handler keeps a shallow copy, so the data
+ * stays valid as long as the handler exists. (For data created with
+ * <tt>QByteArray::fromRawData()</tt>, the caller has to guarantee this.)
+ * @returns On success, a pointer to a new IO handler. On fail,
+ * <tt>nullptr</tt>. */
+cmsIOHANDLER *IOHandlerFactory::createReadOnly(cmsContext ContextID, const QByteArray &data)
+{
+    cmsIOHANDLER *const result = static_cast<cmsIOHANDLER *>( //
+        _cmsMallocZero(ContextID, sizeof(cmsIOHANDLER))       //
+    );
+    if (result == nullptr) {
+        return nullptr;
+    }
+
+    Stream *const streamObject = new Stream;
+    streamObject->data = data;
+    streamObject->mappedData = reinterpret_cast<const uchar *>( //
+        streamObject->data.constData());
+    // QByteArray::size() is an int, so it always fits into
+    // cmsUInt32Number and is never negative.
+    streamObject->size = static_cast<cmsUInt32Number>(data.size());
+
+    // Initialize data members
+    result->ContextID = ContextID;
+    result->ReportedSize = streamObject->size;
+    result->stream = static_cast<void *>(streamObject);
     result->UsedSpace = 0;
     result->PhysicalFile[0] = 0;
 
@@ -32,6 +32,9 @@
 
 #include "lcms2.h"
 
+#include <QByteArray>
+#include <QFile>
+
 namespace PerceptualColor
 {
 /** @internal
@@ -90,16 +93,60 @@ namespace PerceptualColor
  *
  * Therefore, this class provides a custom LittleCMS IO handler which
  * internally (but invisible for LittleCMS) relies on QFile. This gives
- * us Qt’s portability without the above-mentioned disadvantages. */
+ * us Qt’s portability without the above-mentioned disadvantages.
+ *
+ * LittleCMS parses big LUT-based profiles with many small reads and
+ * seeks. By default, the file is therefore mapped into memory with
+ * <tt>QFile::map()</tt>, so that reads and seeks are served directly
+ * from the mapping instead of going through <tt>QIODevice</tt>. Like
+ * the buffered reads, the mapping does not load the whole file into
+ * memory: The operating system loads only the pages that are actually
+ * accessed. See @ref FileAccess for details.
+ *
+ * The same IO handler can also read in-memory ICC data in place. (The
+ * IO handlers of LittleCMS itself copy the data before reading it.) */
 class IOHandlerFactory
 {
 public:
-    static cmsIOHANDLER *createReadOnly(cmsContext ContextID, const QString &fileName);
+    /** @brief How the file content is accessed. */
+    enum class FileAccess {
+        Buffered, /**< Read through <tt>QFile::read()</tt>. */
+        MemoryMapped /**< Map the file into memory with
+            <tt>QFile::map()</tt> and serve the reads directly from the
+            mapping. Falls back to <tt>Buffered</tt> if the file cannot
+            be mapped (for example because it is empty, or because it
+            is not a regular file). */
+    };
+    static cmsIOHANDLER *createReadOnly(cmsContext ContextID, const QString &fileName, const FileAccess access = FileAccess::MemoryMapped);
+    static cmsIOHANDLER *createReadOnly(cmsContext ContextID, const QByteArray &data);
 
 private:
     IOHandlerFactory() = delete;
     Q_DISABLE_COPY(IOHandlerFactory)
 
+    /** @internal @brief Only for unit tests. */
+    friend class TestIOHandlerFactory;
+
+    /** @brief The data behind the <tt>stream</tt> member of the
+     * IO handlers. */
+    struct Stream {
+        /** @brief The file, if reading from a file. */
+        QFile file;
+        /** @brief The in-memory data, if reading from memory.
+         *
+         * This is a shallow copy, which keeps the data alive. */
+        QByteArray data;
+        /** @brief The mapped file content or the in-memory data.
+         * <tt>nullptr</tt> if the file is read with buffered reads.
+         *
+         * The mapping is released when @ref file is destroyed. */
+        const uchar *mappedData = nullptr;
+        /** @brief The current position within @ref mappedData. */
+        cmsUInt32Number position = 0;
+        /** @brief The size of @ref mappedData. */
+        cmsUInt32Number size = 0;
+    };
+
     static cmsBool close(cmsIOHANDLER *iohandler);
     static cmsUInt32Number read(cmsIOHANDLER *iohandler, void *Buffer, cmsUInt32Number size, cmsUInt32Number count);
     static cmsBool seek(cmsIOHANDLER *iohandler, cmsUInt32Number offset);
@@ -0,0 +1,135 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "parallelrows.h"
+
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief The state that is shared between the calling thread and
+ * the helper threads.
+ *
+ * Helper threads might start only after the calling thread has yet
+ * finished all rows and returned. Therefore, this state is reference
+ * counted and not stored on the stack of the calling thread. */
+struct ParallelRows::SharedState {
+    /** @brief The function that processes a single row. */
+    std::function<void(int)> rowFunction;
+    /** @brief The number of rows. */
+    int rowCount = 0;
+    /** @brief The next row that has not yet been handed out to a thread. */
+    QAtomicInt nextRow {0};
+    /** @brief Is released once for each row that has been finished. */
+    QSemaphore finishedRows;
+};
+
+/** @internal
+ *
+ * @brief A helper thread task that processes rows until no row is left. */
+class ParallelRows::RowRunnable final : public QRunnable
+{
+public:
+    /** @brief Constructor
+     * @param state The shared state */
+    explicit RowRunnable(const QSharedPointer<SharedState> &state)
+        : m_state(state)
+    {
+    }
+    /** @brief Processes rows until no row is left. */
+    virtual void run() override
+    {
+        ParallelRows::processRows(m_state.data());
+    }
+
+private:
+    Q_DISABLE_COPY(RowRunnable)
+    /** @brief The shared state */
+    QSharedPointer<SharedState> m_state;
+};
+
+/** @brief Processes rows until no row is left.
+ *
+ * @param state The shared state */
+void ParallelRows::processRows(SharedState *state)
+{
+    int row = state->nextRow.fetchAndAddRelaxed(1);
+    while (row < state->rowCount) {
+        state->rowFunction(row);
+        state->finishedRows.release();
+        row = state->nextRow.fetchAndAddRelaxed(1);
+    }
+}
+
+/** @brief Calls a function for each row, using various threads.
+ *
+ * @param rowCount The number of rows.
+ * @param threadCount The maximum number of threads, including the calling
+ * thread. With <tt>1</tt> (or less), all rows are processed sequentially
+ * within the calling thread, in ascending order.
+ * @param rowFunction The function that will be called once for each row,
+ * with the row number as argument. It will be called concurrently from
+ * various threads, so it must be thread-safe. Different rows must
+ * not depend on each other.
+ *
+ * @post This function returns only after all rows have been processed. */
+void ParallelRows::forEachRow(const int rowCount, const int threadCount, const std::function<void(int)> &rowFunction)
+{
+    if (rowCount <= 0) {
+        return;
+    }
+    // Do not start more helper threads than there are rows to share with.
+    const int helperThreadCount = qBound(0, threadCount - 1, rowCount - 1);
+    if (helperThreadCount == 0) {
+        for (int row = 0; row < rowCount; ++row) {
+            rowFunction(row);
+        }
+        return;
+    }
+
+    QSharedPointer<SharedState> state {new SharedState};
+    state->rowFunction = rowFunction;
+    state->rowCount = rowCount;
+    for (int i = 0; i < helperThreadCount; ++i) {
+        QThreadPool::globalInstance()->start(new RowRunnable(state));
+    }
+    processRows(state.data());
+    // Wait for rows that are still in progress within helper threads.
+    state->finishedRows.acquire(rowCount);
+}
+
+} // namespace PerceptualColor
@@ -0,0 +1,71 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PARALLELROWS_H
+#define PARALLELROWS_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <functional>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief Distributes the rows of an image across threads.
+ *
+ * Rendering the diagram images is expensive, but each row can be
+ * calculated independently of all other rows. This class processes
+ * the rows in parallel on <tt>QThreadPool::globalInstance()</tt>.
+ *
+ * The rows are handed out dynamically, one by one, to the threads. The
+ * calling thread participates in the work. Therefore, the work is
+ * always finished, even if the thread pool is busy with other tasks and
+ * none of the helper threads can start. As long as the row function
+ * calculates each row independently of the other rows, the result does
+ * <em>not</em> depend on the number of threads or on the scheduling:
+ * It is deterministic.
+ *
+ * Example:
+ * @snippet test/testparallelrows.cpp ParallelRows usage */
+class ParallelRows
+{
+public:
+    static void forEachRow(const int rowCount, const int threadCount, const std::function<void(int)> &rowFunction);
+
+private:
+    ParallelRows() = delete;
+    Q_DISABLE_COPY(ParallelRows)
+
+    class RowRunnable;
+    struct SharedState;
+    static void processRows(SharedState *state);
+};
+
+} // namespace PerceptualColor
+
+#endif // PARALLELROWS_H
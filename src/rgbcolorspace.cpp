@@ -34,16 +34,31 @@
 #include "rgbcolorspace_p.h"
 
 #include "helper.h"
+#include "instrumentationscope.h"
 #include "iohandlerfactory.h"
 #include "polarpointf.h"
 
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QMutexLocker>
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
 
 // TODO There should be no dependency on Posix headers, but only on standard C++.
 #include <unistd.h> // Posix header
 
 namespace PerceptualColor
 {
+namespace
+{
+/** @internal
+ *
+ * @brief Source for @ref RgbColorSpace::RgbColorSpacePrivate::m_serialNumber */
+std::atomic<quint64> serialNumberCounter {0};
+} // namespace
+
 /** @internal
  *
  * @brief Constructor
@@ -61,6 +76,8 @@ RgbColorSpace::RgbColorSpace(QObject *parent)
  * @returns A shared pointer to a newly created color space object. */
 QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createSrgb()
 {
+    const InstrumentationScope instrumentationScope("RgbColorSpace::createSrgb");
+
     // Create an invalid object:
     QSharedPointer<PerceptualColor::RgbColorSpace> result {new RgbColorSpace()};
 
@@ -92,17 +109,49 @@ QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createSrgb()
  * A shared pointer to <tt>nullptr</tt> otherwise. */
 QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createFromFile(const QString &fileName)
 {
-    cmsIOHANDLER *myIOHandler = IOHandlerFactory::createReadOnly(nullptr, fileName);
-    if (myIOHandler == nullptr) {
+    const InstrumentationScope instrumentationScope("RgbColorSpace::createFromFile");
+    return createFromIOHandler(IOHandlerFactory::createReadOnly(nullptr, fileName));
+}
+
+/** @brief Create a color space object for given ICC data.
+ *
+ * This function may fail to create the color space object when the
+ * data cannot be interpreted by LittleCMS.
+ *
+ * @param data The ICC data. It is read in place, without a copy. Use
+ * <tt>QByteArray::fromRawData()</tt> to pass a raw memory buffer without
+ * a copy; the buffer has to stay valid until this function returns.
+ *
+ * @returns A shared pointer to a newly created color space object on success.
+ * A shared pointer to <tt>nullptr</tt> otherwise. */
+QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createFromMemory(const QByteArray &data)
+{
+    const InstrumentationScope instrumentationScope("RgbColorSpace::createFromMemory");
+    return createFromIOHandler(IOHandlerFactory::createReadOnly(nullptr, data));
+}
+
+/** @brief Create a color space object from a LittleCMS IO handler.
+ *
+ * Code that is shared between @ref createFromFile() and
+ * @ref createFromMemory().
+ *
+ * @param ioHandler The IO handler, or <tt>nullptr</tt>. This function
+ * takes ownership.
+ *
+ * @returns A shared pointer to a newly created color space object on success.
+ * A shared pointer to <tt>nullptr</tt> otherwise. */
+QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createFromIOHandler(cmsIOHANDLER *ioHandler)
+{
+    if (ioHandler == nullptr) {
         return nullptr;
     }
 
     cmsHPROFILE myProfileHandle = cmsOpenProfileFromIOhandlerTHR( //
         nullptr,                                                  // ContextID
-        myIOHandler                                               // IO handler
+        ioHandler                                                 // IO handler
     );
     if (myProfileHandle == nullptr) {
-        // We do not have to delete myIOHandler manually.
+        // We do not have to delete ioHandler manually.
         // (cmsOpenProfileFromIOhandlerTHR did that when
         // failing to open the profile handle.)
         return nullptr;
@@ -114,7 +163,7 @@ QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createFromFile(con
     const bool success = newObject->d_pointer->initialize(myProfileHandle);
     // Clean up
     cmsCloseProfile(myProfileHandle);
-    // We do not have to delete myIOHandler manually.
+    // We do not have to delete ioHandler manually.
     // (myCmsProfileHandle did  that when cmsCloseProfile() was invoked.)
 
     // Return
@@ -138,27 +187,540 @@ QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createFromFile(con
  * be used, but only be destoyed. */
 bool RgbColorSpace::RgbColorSpacePrivate::initialize(cmsHPROFILE rgbProfileHandle)
 {
+    const InstrumentationScope instrumentationScope("RgbColorSpacePrivate::initialize");
+
     m_cmsInfoDescription = getInformationFromProfile(rgbProfileHandle, cmsInfoDescription);
     m_cmsInfoCopyright = getInformationFromProfile(rgbProfileHandle, cmsInfoCopyright);
     m_cmsInfoManufacturer = getInformationFromProfile(rgbProfileHandle, cmsInfoManufacturer);
     m_cmsInfoModel = getInformationFromProfile(rgbProfileHandle, cmsInfoModel);
 
+    // Keep a serialized copy of the profile. From this copy, each thread
+    // creates its own transforms within its own LittleCMS context.
+    cmsUInt32Number profileSize = 0;
+    if (!cmsSaveProfileToMem(rgbProfileHandle, nullptr, &profileSize)) {
+        return false;
+    }
+    m_profileData.resize(static_cast<int>(profileSize));
+    if (!cmsSaveProfileToMem(rgbProfileHandle, m_profileData.data(), &profileSize)) {
+        return false;
+    }
+
+    // The identifier is a hash of the profile data, but without the
+    // creation date and the profile ID of the ICC header: Both change
+    // each time a profile like sRGB is created in memory, while the
+    // profile itself stays the same.
+    QByteArray normalizedProfileData = m_profileData;
+    constexpr int dateTimeOffset = 24;
+    constexpr int dateTimeSize = 12;
+    constexpr int profileIdOffset = 84;
+    constexpr int profileIdSize = 16;
+    if (normalizedProfileData.size() >= profileIdOffset + profileIdSize) {
+        normalizedProfileData.replace(dateTimeOffset, dateTimeSize, QByteArray(dateTimeSize, 0));
+        normalizedProfileData.replace(profileIdOffset, profileIdSize, QByteArray(profileIdSize, 0));
+    }
+    m_profileIdentifier = QCryptographicHash::hash(normalizedProfileData, QCryptographicHash::Sha256);
+
+    // Create the transforms for the current thread. This tests also
+    // if the profile can actually be used.
+    if (!threadData()->isValid()) {
+        return false;
+    }
+
+    // Maximum chroma:
+    // TODO m_maximumChroma should depend on the actual profile.
+    // m_maximumChroma = LchValues::humanMaximumChroma;
+    // m_maximumChroma = 350;
+
+    // Blackpoint and whitepoint: Search on the gray axis, starting from
+    // an in-gamut gray. Usually, the medium gray is in-gamut; otherwise
+    // fall back to a coarse scan of the gray axis.
+    LchDouble gray {50, 0, 0};
+    if (!q_pointer->isInGamut(gray)) {
+        for (int lightness = 0; lightness <= 100; ++lightness) {
+            gray.l = lightness;
+            if (q_pointer->isInGamut(gray)) {
+                break;
+            }
+        }
+    }
+    if (!q_pointer->isInGamut(gray)) {
+        qCritical() << "Unable to find blackpoint and whitepoint on gray axis.";
+        throw 0;
+    }
+    m_blackpointL = grayAxisBoundary(gray.l, 0);
+    m_whitepointL = grayAxisBoundary(gray.l, 100);
+    if (m_whitepointL <= m_blackpointL) {
+        qCritical() << "Unable to find blackpoint and whitepoint on gray axis.";
+        throw 0;
+    }
+
+    // Maximum chroma tables: Only allocate them. The rows
+    // are calculated lazily on first use.
+    m_maximumChromaTable.resize(maximumChromaTableLightnessCount * maximumChromaTableHueCount);
+    m_maximumChromaRowReady.fill(false, maximumChromaTableLightnessCount);
+    m_maximumChromaErrorTable.resize((maximumChromaTableLightnessCount - 1) * (maximumChromaTableHueCount - 1));
+    m_maximumChromaCellRowReady.resize(maximumChromaTableLightnessCount - 1);
+
+    return true;
+}
+
+/** @brief Searches the boundary of the gamut on the gray axis.
+ *
+ * This is a bisection search, so it needs only a logarithmic number of
+ * color conversions.
+ *
+ * @param inGamutLightness A lightness where gray is in-gamut.
+ * @param limit The end of the gray axis where to search the boundary:
+ * <tt>0</tt> for the blackpoint, <tt>100</tt> for the whitepoint.
+ * @returns The in-gamut lightness that is nearest to <tt>limit</tt>,
+ * with a precision of @ref gamutPrecision. */
+qreal RgbColorSpace::RgbColorSpacePrivate::grayAxisBoundary(const qreal inGamutLightness, const qreal limit) const
+{
+    LchDouble inGamut {inGamutLightness, 0, 0};
+    LchDouble outOfGamut {limit, 0, 0};
+    if (q_pointer->isInGamut(outOfGamut)) {
+        return limit;
+    }
+    LchDouble candidate = inGamut;
+    while (qAbs(outOfGamut.l - inGamut.l) > gamutPrecision) {
+        candidate.l = (inGamut.l + outOfGamut.l) / 2;
+        if (q_pointer->isInGamut(candidate)) {
+            inGamut = candidate;
+        } else {
+            outOfGamut = candidate;
+        }
+    }
+    return inGamut.l;
+}
+
+/** @brief Makes sure that a cell row of the maximum chroma tables is ready.
+ *
+ * A cell row is the area between two neighboring rows of
+ * @ref m_maximumChromaTable. It is ready when both rows of
+ * @ref m_maximumChromaTable and the corresponding row of
+ * @ref m_maximumChromaErrorTable have been calculated. If not,
+ * they are calculated now. This function is thread-safe.
+ *
+ * @param lightnessIndex The cell row. Range:
+ * <tt>[0, @ref maximumChromaTableLightnessCount - 2]</tt> */
+void RgbColorSpace::RgbColorSpacePrivate::ensureMaximumChromaCellRow(const int lightnessIndex) const
+{
+    if (m_maximumChromaCellRowReady.at(lightnessIndex).loadAcquire() != 0) {
+        return;
+    }
+    QMutexLocker locker(&m_maximumChromaTableMutex);
+    // Another thread might have calculated the cell row in the meantime.
+    if (m_maximumChromaCellRowReady.at(lightnessIndex).loadAcquire() != 0) {
+        return;
+    }
+    for (int lightness = lightnessIndex; lightness <= lightnessIndex + 1; ++lightness) {
+        if (!m_maximumChromaRowReady.at(lightness)) {
+            calculateMaximumChromaRow( //
+                lightness,
+                m_maximumChromaTable.data() + lightness * maximumChromaTableHueCount);
+            m_maximumChromaRowReady[lightness] = true;
+        }
+    }
+    calculateMaximumChromaErrorRow( //
+        lightnessIndex,
+        m_maximumChromaErrorTable.data() + lightnessIndex * (maximumChromaTableHueCount - 1));
+    m_maximumChromaCellRowReady[lightnessIndex].storeRelease(1);
+}
+
+/** @brief Searches the maximum in-gamut chroma of many colors at once.
+ *
+ * For all colors, a bisection search is done in parallel: Each
+ * bisection step converts all colors within a single batch conversion.
+ *
+ * @param points Pointer to the first of <tt>count</tt> colors. Only
+ * lightness and hue are used.
+ * @param result Pointer to a buffer for at least <tt>count</tt> values.
+ * Receives the maximum chroma that is still in-gamut, with a precision
+ * of @ref gamutPrecision. <tt>0</tt> where gray itself is out-of-gamut.
+ * @param count The number of colors. */
+void RgbColorSpace::RgbColorSpacePrivate::calculateMaximumChroma(const LchDouble *points, qreal *result, const int count) const
+{
+    QVector<LchDouble> lchBuffer(count);
+    QVector<RgbDouble> rgbBuffer(count);
+    QVector<bool> isInGamutBuffer(count);
+    QVector<qreal> lowerChroma(count, 0);
+    QVector<qreal> upperChroma(count, m_maximumChroma);
+
+    // Special case: Gray is out-of-gamut (beyond the blackpoint or the
+    // whitepoint). There is no in-gamut chroma at all.
+    for (int i = 0; i < count; ++i) {
+        lchBuffer[i] = points[i];
+        lchBuffer[i].c = 0;
+    }
+    q_pointer->toRgbUnbound(lchBuffer.constData(), rgbBuffer.data(), isInGamutBuffer.data(), count);
+    for (int i = 0; i < count; ++i) {
+        if (!isInGamutBuffer.at(i)) {
+            upperChroma[i] = 0;
+        }
+    }
+
+    // Special case: Chroma is in-gamut up to the maximum chroma.
+    for (int i = 0; i < count; ++i) {
+        lchBuffer[i].c = upperChroma.at(i);
+    }
+    q_pointer->toRgbUnbound(lchBuffer.constData(), rgbBuffer.data(), isInGamutBuffer.data(), count);
+    for (int i = 0; i < count; ++i) {
+        if (isInGamutBuffer.at(i)) {
+            lowerChroma[i] = upperChroma.at(i);
+        }
+    }
+
+    // Bisection. All colors start with the same interval width,
+    // so they all need the same number of steps.
+    qreal intervalWidth = m_maximumChroma;
+    while (intervalWidth > gamutPrecision) {
+        for (int i = 0; i < count; ++i) {
+            lchBuffer[i].c = (lowerChroma.at(i) + upperChroma.at(i)) / 2;
+        }
+        q_pointer->toRgbUnbound(lchBuffer.constData(), rgbBuffer.data(), isInGamutBuffer.data(), count);
+        for (int i = 0; i < count; ++i) {
+            if (lowerChroma.at(i) == upperChroma.at(i)) {
+                // Special cases from above: Nothing to search.
+                continue;
+            }
+            if (isInGamutBuffer.at(i)) {
+                lowerChroma[i] = lchBuffer.at(i).c;
+            } else {
+                upperChroma[i] = lchBuffer.at(i).c;
+            }
+        }
+        intervalWidth /= 2;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        result[i] = lowerChroma.at(i);
+    }
+}
+
+/** @brief Calculates a row of @ref m_maximumChromaTable.
+ *
+ * @param lightness The lightness of the row. Range: <tt>[0, 100]</tt>
+ * @param row Pointer to the first element of the row. */
+void RgbColorSpace::RgbColorSpacePrivate::calculateMaximumChromaRow(const int lightness, float *row) const
+{
+    constexpr int count = maximumChromaTableHueCount;
+    QVector<LchDouble> points(count);
+    for (int hue = 0; hue < count; ++hue) {
+        points[hue] = LchDouble {static_cast<qreal>(lightness), 0, static_cast<qreal>(hue)};
+    }
+    QVector<qreal> result(count);
+    calculateMaximumChroma(points.constData(), result.data(), count);
+    for (int hue = 0; hue < count; ++hue) {
+        row[hue] = static_cast<float>(result.at(hue));
+    }
+}
+
+/** @brief Calculates a row of @ref m_maximumChromaErrorTable.
+ *
+ * For each cell, the interpolation error is measured at the center and
+ * at the midpoints of the four edges, where bilinear interpolation is
+ * farthest from the exactly known corners.
+ *
+ * @pre The rows <tt>lightnessIndex</tt> and <tt>lightnessIndex + 1</tt>
+ * of @ref m_maximumChromaTable are ready.
+ *
+ * @param lightnessIndex The cell row. Range:
+ * <tt>[0, @ref maximumChromaTableLightnessCount - 2]</tt>
+ * @param errorRow Pointer to the first element of the row. */
+void RgbColorSpace::RgbColorSpacePrivate::calculateMaximumChromaErrorRow(const int lightnessIndex, float *errorRow) const
+{
+    constexpr int cellCount = maximumChromaTableHueCount - 1;
+    // Four samples per cell: center, lower edge, upper edge, left edge.
+    // The right edge of a cell is the left edge of the next cell.
+    constexpr int samplesPerCell = 4;
+    const qreal lightness = lightnessIndex;
+    QVector<LchDouble> points(cellCount * samplesPerCell);
+    for (int hueIndex = 0; hueIndex < cellCount; ++hueIndex) {
+        LchDouble *cellPoints = points.data() + hueIndex * samplesPerCell;
+        cellPoints[0] = LchDouble {lightness + 0.5, 0, hueIndex + 0.5};
+        cellPoints[1] = LchDouble {lightness, 0, hueIndex + 0.5};
+        cellPoints[2] = LchDouble {lightness + 1, 0, hueIndex + 0.5};
+        cellPoints[3] = LchDouble {lightness + 0.5, 0, static_cast<qreal>(hueIndex)};
+    }
+    QVector<qreal> actual(points.count());
+    calculateMaximumChroma(points.constData(), actual.data(), points.count());
+
+    for (int hueIndex = 0; hueIndex < cellCount; ++hueIndex) {
+        const int first = hueIndex * samplesPerCell;
+        const int rightEdge = ((hueIndex + 1) % cellCount) * samplesPerCell + 3;
+        const qreal maximumError = std::max({
+            qAbs(interpolatedMaximumChromaInCell(lightnessIndex, hueIndex, 0.5, 0.5) - actual.at(first)),
+            qAbs(interpolatedMaximumChromaInCell(lightnessIndex, hueIndex, 0, 0.5) - actual.at(first + 1)),
+            qAbs(interpolatedMaximumChromaInCell(lightnessIndex, hueIndex, 1, 0.5) - actual.at(first + 2)),
+            qAbs(interpolatedMaximumChromaInCell(lightnessIndex, hueIndex, 0.5, 0) - actual.at(first + 3)),
+            qAbs(interpolatedMaximumChromaInCell(lightnessIndex, hueIndex, 0.5, 1) - actual.at(rightEdge)) //
+        });
+        // The table entries themselves have a precision of gamutPrecision.
+        errorRow[hueIndex] = static_cast<float>( //
+            maximumChromaErrorSafetyFactor * maximumError + gamutPrecision);
+    }
+}
+
+/** @brief Bilinear interpolation within a cell of
+ * @ref m_maximumChromaTable.
+ *
+ * @pre The rows <tt>lightnessIndex</tt> and <tt>lightnessIndex + 1</tt>
+ * of @ref m_maximumChromaTable are ready.
+ *
+ * @param lightnessIndex The lower row of the cell.
+ * @param hueIndex The left column of the cell.
+ * @param lightnessFraction The position within the cell. Range: <tt>[0, 1]</tt>
+ * @param hueFraction The position within the cell. Range: <tt>[0, 1]</tt>
+ * @returns The interpolated maximum chroma. */
+qreal RgbColorSpace::RgbColorSpacePrivate::interpolatedMaximumChromaInCell(const int lightnessIndex,
+                                                                          const int hueIndex,
+                                                                          const qreal lightnessFraction,
+                                                                          const qreal hueFraction) const
+{
+    const float *lowerRow = m_maximumChromaTable.constData() + lightnessIndex * maximumChromaTableHueCount;
+    const float *upperRow = lowerRow + maximumChromaTableHueCount;
+    const qreal lower = lowerRow[hueIndex] + (lowerRow[hueIndex + 1] - lowerRow[hueIndex]) * hueFraction;
+    const qreal upper = upperRow[hueIndex] + (upperRow[hueIndex + 1] - upperRow[hueIndex]) * hueFraction;
+    return lower + (upper - lower) * lightnessFraction;
+}
+
+/** @brief Maximum in-gamut chroma, interpolated from
+ * @ref m_maximumChromaTable.
+ *
+ * This is fast: It is a bilinear interpolation without any color
+ * conversion. (Only the very first call for a given lightness range
+ * calculates the needed table rows, see @ref ensureMaximumChromaCellRow().)
+ * The result is an approximation; near to edges and cusps of the gamut
+ * body, it might be slightly different from the actual maximum chroma.
+ * Use @ref refinedMaximumChroma() if you need more precision.
+ *
+ * @param lightness The lightness. Is bound to <tt>[0, 100]</tt>.
+ * @param hue The hue. Is normalized to <tt>[0, 360[</tt>.
+ * @param errorBound Optional. Receives the error bound of the result,
+ * as measured for the table cell (see @ref m_maximumChromaErrorTable).
+ * @returns The approximate maximum chroma. */
+qreal RgbColorSpace::RgbColorSpacePrivate::interpolatedMaximumChroma(const qreal lightness, const qreal hue, qreal *errorBound) const
+{
+    const qreal boundLightness = qBound<qreal>(0, lightness, maximumChromaTableLightnessCount - 1);
+    const qreal normalizedHue = PolarPointF::normalizedAngleDegree(hue);
+    const int lightnessIndex = qMin(static_cast<int>(boundLightness), maximumChromaTableLightnessCount - 2);
+    const int hueIndex = qMin(static_cast<int>(normalizedHue), maximumChromaTableHueCount - 2);
+    ensureMaximumChromaCellRow(lightnessIndex);
+    if (errorBound != nullptr) {
+        *errorBound = m_maximumChromaErrorTable.at( //
+            lightnessIndex * (maximumChromaTableHueCount - 1) + hueIndex);
+    }
+    return interpolatedMaximumChromaInCell(lightnessIndex, //
+                                           hueIndex,
+                                           boundLightness - lightnessIndex,
+                                           normalizedHue - hueIndex);
+}
+
+/** @brief Maximum in-gamut chroma, with full precision.
+ *
+ * Starts with @ref interpolatedMaximumChroma() and refines the result
+ * locally with a bisection search within the error bound of the table
+ * cell. Usually, this bound is small, so the search needs only a few
+ * color conversions. If the bound does not hold, the search falls
+ * back to the remaining chroma range.
+ *
+ * @param lightness The lightness.
+ * @param hue The hue.
+ * @returns The maximum chroma that is in-gamut, with a precision
+ * of @ref gamutPrecision. <tt>0</tt> if gray itself is out-of-gamut. */
+qreal RgbColorSpace::RgbColorSpacePrivate::refinedMaximumChroma(const qreal lightness, const qreal hue) const
+{
+    qreal errorBound = 0;
+    const qreal estimate = interpolatedMaximumChroma(lightness, hue, &errorBound);
+    LchDouble lowerChroma {lightness, qMax<qreal>(0, estimate - errorBound), hue};
+    LchDouble upperChroma {lightness, qMin<qreal>(m_maximumChroma, estimate + errorBound), hue};
+    if (!q_pointer->isInGamut(lowerChroma)) {
+        if (lowerChroma.c <= 0) {
+            return 0;
+        }
+        upperChroma = lowerChroma;
+        lowerChroma.c = 0;
+        if (!q_pointer->isInGamut(lowerChroma)) {
+            return 0;
+        }
+    } else if (q_pointer->isInGamut(upperChroma)) {
+        if (upperChroma.c >= m_maximumChroma) {
+            return m_maximumChroma;
+        }
+        lowerChroma = upperChroma;
+        upperChroma.c = m_maximumChroma;
+        if (q_pointer->isInGamut(upperChroma)) {
+            return m_maximumChroma;
+        }
+    }
+    LchDouble candidate = lowerChroma;
+    while (upperChroma.c - lowerChroma.c > gamutPrecision) {
+        candidate.c = (lowerChroma.c + upperChroma.c) / 2;
+        if (q_pointer->isInGamut(candidate)) {
+            lowerChroma = candidate;
+        } else {
+            upperChroma = candidate;
+        }
+    }
+    return lowerChroma.c;
+}
+
+/** @brief Destructor */
+RgbColorSpace::~RgbColorSpace() noexcept
+{
+    d_pointer->releaseAllThreadData();
+}
+
+/** @brief Constructor
+ *
+ * @param backLink Pointer to the object from which <em>this</em> object
+ * is the private implementation. */
+RgbColorSpace::RgbColorSpacePrivate::RgbColorSpacePrivate(RgbColorSpace *backLink)
+    : m_serialNumber(serialNumberCounter.fetch_add(1))
+    , q_pointer(backLink)
+{
+    m_gamutSliceCache.setMaxCost(defaultGamutSliceCacheBudget);
+}
+
+/** @brief Destructor
+ *
+ * Calls @ref release(). */
+RgbColorSpace::RgbColorSpacePrivate::ThreadData::~ThreadData() noexcept
+{
+    release();
+}
+
+/** @brief Whether the transforms have been created successfully.
+ *
+ * @returns <tt>true</tt> if all transforms are available.
+ * <tt>false</tt> otherwise. */
+bool RgbColorSpace::RgbColorSpacePrivate::ThreadData::isValid() const
+{
+    return (m_transformLabToRgbHandle != nullptr)      //
+        && (m_transformLabToRgb16Handle != nullptr) //
+        && (m_transformRgbToLabHandle != nullptr);
+}
+
+/** @brief Frees all resources.
+ *
+ * @post All transforms, the context and the cache are freed.
+ * The object is not valid anymore, and @ref m_isReleased is set. */
+void RgbColorSpace::RgbColorSpacePrivate::ThreadData::release()
+{
+    RgbColorSpacePrivate::deleteTransform(m_transformLabToRgb16Handle);
+    RgbColorSpacePrivate::deleteTransform(m_transformLabToRgbHandle);
+    RgbColorSpacePrivate::deleteTransform(m_transformRgbToLabHandle);
+    if (m_context != nullptr) {
+        cmsDeleteContext(m_context);
+        m_context = nullptr;
+    }
+    m_isReleased.storeRelease(1);
+}
+
+/** @brief The registry of the current thread.
+ *
+ * @returns A reference to the registry of the current thread. It contains
+ * the @ref ThreadData of all color space objects that have been used
+ * within the current thread, indexed by their @ref m_serialNumber. The
+ * registry owns the data; it is freed when the thread exits. Entries of
+ * color space objects that have been destroyed meanwhile are removed by
+ * @ref threadData(). */
+QHash<quint64, QSharedPointer<RgbColorSpace::RgbColorSpacePrivate::ThreadData>> &RgbColorSpace::RgbColorSpacePrivate::threadLocalRegistry()
+{
+    thread_local QHash<quint64, QSharedPointer<ThreadData>> registry;
+    return registry;
+}
+
+/** @brief The @ref ThreadData of the current thread.
+ *
+ * This function is thread-safe. It is called on the hot path of
+ * color conversion. Only the very first call within a given thread
+ * locks a mutex.
+ *
+ * @returns The data of the current thread for <em>this</em> object. It
+ * is created on the first call within a given thread. The pointer is
+ * valid as long as both, <em>this</em> object and the current thread,
+ * exist. */
+RgbColorSpace::RgbColorSpacePrivate::ThreadData *RgbColorSpace::RgbColorSpacePrivate::threadData() const
+{
+    QHash<quint64, QSharedPointer<ThreadData>> &registry = threadLocalRegistry();
+    const auto iterator = registry.constFind(m_serialNumber);
+    if (iterator != registry.constEnd()) {
+        return iterator.value().data();
+    }
+
+    // Long-lived threads use many color space objects over time. Remove
+    // the entries of objects that have been destroyed meanwhile. (This
+    // is done only here, off the hot path.)
+    for (auto it = registry.begin(); it != registry.end();) {
+        if (it.value()->m_isReleased.loadAcquire() != 0) {
+            it = registry.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QSharedPointer<ThreadData> newData {createThreadData()};
+    registry.insert(m_serialNumber, newData);
+    QMutexLocker locker(&m_threadDataMutex);
+    // Clean up the entries of threads that have yet exited:
+    m_threadDataList.erase( //
+        std::remove_if(m_threadDataList.begin(),
+                       m_threadDataList.end(),
+                       [](const QWeakPointer<ThreadData> &pointer) {
+                           return pointer.isNull();
+                       }),
+        m_threadDataList.end());
+    m_threadDataList.append(newData);
+    return newData.data();
+}
+
+/** @brief Creates a new @ref ThreadData object.
+ *
+ * @pre @ref m_profileData contains the RGB profile.
+ *
+ * @returns A new object, created within a new LittleCMS context. The
+ * caller takes ownership. If the transforms cannot be created, the
+ * object is not valid (see @ref ThreadData::isValid()). */
+RgbColorSpace::RgbColorSpacePrivate::ThreadData *RgbColorSpace::RgbColorSpacePrivate::createThreadData() const
+{
+    const InstrumentationScope instrumentationScope("RgbColorSpacePrivate::createThreadData");
+    ThreadData *result = new ThreadData;
+    result->m_context = cmsCreateContext(nullptr, nullptr);
+    if (result->m_context == nullptr) {
+        return result;
+    }
+    cmsHPROFILE rgbProfileHandle = cmsOpenProfileFromMemTHR( //
+        result->m_context,
+        m_profileData.constData(),
+        static_cast<cmsUInt32Number>(m_profileData.size()));
+    if (rgbProfileHandle == nullptr) {
+        return result;
+    }
+
     // Create an ICC v4 profile object for the Lab color space.
-    cmsHPROFILE labProfileHandle = cmsCreateLab4Profile(
+    cmsHPROFILE labProfileHandle = cmsCreateLab4ProfileTHR(
+        // The context of this thread:
+        result->m_context,
         // nullptr means: Default white point (D50)
         // TODO Does this make sense? sRGB white point is D65!
         nullptr);
+    if (labProfileHandle == nullptr) {
+        cmsCloseProfile(rgbProfileHandle);
+        return result;
+    }
 
     // Create the transforms
     // We use the flag cmsFLAGS_NOCACHE which disables the 1-pixel-cache
-    // which is normally used in the transforms. We do this because transforms
-    // that use the 1-pixel-cache are not thread-save. And disabling it
+    // which is normally used in the transforms. Each thread has its own
+    // transforms, so the cache would be thread-safe, but disabling it
     // should not have negative impacts as we usually work with gradients,
     // so anyway it is not likely to have two consecutive pixels with
     // the same color, which is the only situation where the 1-pixel-cache
     // makes processing faster.
-    m_transformLabToRgbHandle = cmsCreateTransform(
+    result->m_transformLabToRgbHandle = cmsCreateTransformTHR(
         // Create a transform function and get a handle to this function:
+        result->m_context,            // context
         labProfileHandle,             // input profile handle
         TYPE_Lab_DBL,                 // input buffer format
         rgbProfileHandle,             // output profile handle
@@ -166,8 +728,9 @@ bool RgbColorSpace::RgbColorSpacePrivate::initialize(cmsHPROFILE rgbProfileHandl
         INTENT_ABSOLUTE_COLORIMETRIC, // rendering intent
         cmsFLAGS_NOCACHE              // flags
     );
-    m_transformLabToRgb16Handle = cmsCreateTransform(
+    result->m_transformLabToRgb16Handle = cmsCreateTransformTHR(
         // Create a transform function and get a handle to this function:
+        result->m_context,            // context
         labProfileHandle,             // input profile handle
         TYPE_Lab_DBL,                 // input buffer format
         rgbProfileHandle,             // output profile handle
@@ -175,8 +738,9 @@ bool RgbColorSpace::RgbColorSpacePrivate::initialize(cmsHPROFILE rgbProfileHandl
         INTENT_ABSOLUTE_COLORIMETRIC, // rendering intent
         cmsFLAGS_NOCACHE              // flags
     );
-    m_transformRgbToLabHandle = cmsCreateTransform(
+    result->m_transformRgbToLabHandle = cmsCreateTransformTHR(
         // Create a transform function and get a handle to this function:
+        result->m_context,            // context
         rgbProfileHandle,             // input profile handle
         TYPE_RGB_DBL,                 // input buffer format
         labProfileHandle,             // output profile handle
@@ -186,75 +750,27 @@ bool RgbColorSpace::RgbColorSpacePrivate::initialize(cmsHPROFILE rgbProfileHandl
     );
     // It is mandatory to close the profiles to prevent memory leaks:
     cmsCloseProfile(labProfileHandle);
+    cmsCloseProfile(rgbProfileHandle);
 
-    // After having closed the profiles, we can now return
-    // (if appropriate) without having memory leaks:
-    if ((m_transformLabToRgbHandle == nullptr)      //
-        || (m_transformLabToRgb16Handle == nullptr) //
-        || (m_transformRgbToLabHandle == nullptr)   //
-    ) {
-        RgbColorSpacePrivate::deleteTransform(m_transformLabToRgb16Handle);
-        RgbColorSpacePrivate::deleteTransform(m_transformLabToRgbHandle);
-        RgbColorSpacePrivate::deleteTransform(m_transformRgbToLabHandle);
-        return false;
-    }
-
-    // Maximum chroma:
-    // TODO m_maximumChroma should depend on the actual profile.
-    // m_maximumChroma = LchValues::humanMaximumChroma;
-    // m_maximumChroma = 350;
-
-    // Now we know for sure that lowerChroma is in-gamut and upperChroma is
-    // out-of-gamut…
-    LchDouble candidate;
-    candidate.l = 0;
-    candidate.c = 0;
-    candidate.h = 0;
-    while (!q_pointer->isInGamut(candidate) && (candidate.l < 100)) {
-        candidate.l += gamutPrecision;
-    }
-    m_blackpointL = candidate.l;
-    candidate.l = 100;
-    while (!q_pointer->isInGamut(candidate) && (candidate.l > 0)) {
-        candidate.l -= gamutPrecision;
-    }
-    m_whitepointL = candidate.l;
-    if (m_whitepointL <= m_blackpointL) {
-        qCritical() << "Unable to find blackpoint and whitepoint on gray axis.";
-        throw 0;
-    }
-
-    // Dirty hacks:
-    QSharedPointer<PerceptualColor::RgbColorSpace> pointerToMainObject;
-    pointerToMainObject.reset(q_pointer);
-    // TODO Self-reference is always a bad idea…
-    m_nearestNeighborSearchImage = new ChromaLightnessImage(pointerToMainObject);
-    const QSize nearestNeighborImageSize = QSize(
-        // width:
-        qRound(nearestNeighborSearchImageHeight / 100.0 * LchValues::humanMaximumChroma) + 1,
-        // height:
-        nearestNeighborSearchImageHeight);
-    m_nearestNeighborSearchImage->setImageSize(nearestNeighborImageSize);
-    m_nearestNeighborSearchImage->setBackgroundColor(Qt::transparent);
-
-    return true;
-}
-
-/** @brief Destructor */
-RgbColorSpace::~RgbColorSpace() noexcept
-{
-    RgbColorSpacePrivate::deleteTransform(d_pointer->m_transformLabToRgb16Handle);
-    RgbColorSpacePrivate::deleteTransform(d_pointer->m_transformLabToRgbHandle);
-    RgbColorSpacePrivate::deleteTransform(d_pointer->m_transformRgbToLabHandle);
+    return result;
 }
 
-/** @brief Constructor
+/** @brief Releases the @ref ThreadData of all threads.
  *
- * @param backLink Pointer to the object from which <em>this</em> object
- * is the private implementation. */
-RgbColorSpace::RgbColorSpacePrivate::RgbColorSpacePrivate(RgbColorSpace *backLink)
-    : q_pointer(backLink)
+ * To be called when <em>this</em> object is destroyed. The resources
+ * of threads that are still running are released immediately instead
+ * of waiting for the thread to exit. */
+void RgbColorSpace::RgbColorSpacePrivate::releaseAllThreadData()
 {
+    threadLocalRegistry().remove(m_serialNumber);
+    QMutexLocker locker(&m_threadDataMutex);
+    for (const QWeakPointer<ThreadData> &pointer : qAsConst(m_threadDataList)) {
+        const QSharedPointer<ThreadData> data = pointer.toStrongRef();
+        if (!data.isNull()) {
+            data->release();
+        }
+    }
+    m_threadDataList.clear();
 }
 
 /** @brief Conveniance function for deleting LittleCMS transforms
@@ -338,10 +854,11 @@ PerceptualColor::LchDouble RgbColorSpace::toLch(const QColor &rgbColor) const
 cmsCIELab RgbColorSpace::RgbColorSpacePrivate::colorLab(const RgbDouble &rgb) const
 {
     cmsCIELab lab;
-    cmsDoTransform(m_transformRgbToLabHandle, // handle to transform function
-                   &rgb,                      // input
-                   &lab,                      // output
-                   1                          // convert exactly 1 value
+    InstrumentationScope::count("cmsDoTransform");
+    cmsDoTransform(threadData()->m_transformRgbToLabHandle, // handle to transform function
+                   &rgb,                                    // input
+                   &lab,                                    // output
+                   1                                        // convert exactly 1 value
     );
     return lab;
 }
@@ -356,12 +873,13 @@ QColor RgbColorSpace::toQColorRgbUnbound(const cmsCIELab &Lab) const
 {
     QColor temp; // By default, without initialization this is an invalid color
     RgbDouble rgb;
+    InstrumentationScope::count("cmsDoTransform");
     cmsDoTransform(
         // Parameters:
-        d_pointer->m_transformLabToRgbHandle, // handle to transform function
-        &Lab,                                 // input
-        &rgb,                                 // output
-        1                                     // convert exactly 1 value
+        d_pointer->threadData()->m_transformLabToRgbHandle, // handle to transform function
+        &Lab,                                               // input
+        &rgb,                                               // output
+        1                                                   // convert exactly 1 value
     );
     if (isInRange<cmsFloat64Number>(0, rgb.red, 1)      //
         && isInRange<cmsFloat64Number>(0, rgb.green, 1) //
@@ -392,15 +910,141 @@ QColor RgbColorSpace::toQColorRgbUnbound(const LchDouble &lch) const
     return toQColorRgbUnbound(temp);
 }
 
+/** @brief Converts many colors at once to RGB.
+ *
+ * This is the batch version of @ref toQColorRgbUnbound(). All colors are
+ * converted within a <em>single</em> call to LittleCMS, which avoids the
+ * per-call overhead that makes per-pixel conversion expensive when
+ * rendering images.
+ *
+ * @param labBuffer Pointer to the first of <tt>count</tt> L*a*b* colors.
+ * @param rgbBuffer Pointer to a buffer for at least <tt>count</tt> values.
+ * Receives the RGB values. For colors that are out-of-gamut, the value
+ * is undefined.
+ * @param isInGamutBuffer Pointer to a buffer for at least <tt>count</tt>
+ * values. Receives for each color <tt>true</tt> if it is in-gamut,
+ * <tt>false</tt> otherwise.
+ * @param count The number of colors to convert. If <tt>0</tt> or smaller,
+ * nothing happens.
+ *
+ * @note The in-gamut status and the RGB values are identical to what
+ * @ref toQColorRgbUnbound() would return for each single color. */
+void RgbColorSpace::toRgbUnbound(const cmsCIELab *labBuffer, RgbDouble *rgbBuffer, bool *isInGamutBuffer, const int count) const
+{
+    if (count <= 0) {
+        return;
+    }
+    InstrumentationScope::count("cmsDoTransform");
+    cmsDoTransform(
+        // Parameters:
+        d_pointer->threadData()->m_transformLabToRgbHandle, // handle to transform function
+        labBuffer,                                          // input
+        rgbBuffer,                                          // output
+        static_cast<cmsUInt32Number>(count)                 // number of values to convert
+    );
+    for (int i = 0; i < count; ++i) {
+        isInGamutBuffer[i] = isInRange<cmsFloat64Number>(0, rgbBuffer[i].red, 1) //
+            && isInRange<cmsFloat64Number>(0, rgbBuffer[i].green, 1)             //
+            && isInRange<cmsFloat64Number>(0, rgbBuffer[i].blue, 1);
+    }
+}
+
+/** @brief Converts many colors at once to RGB.
+ *
+ * This is the batch version of @ref toQColorRgbUnbound(). For details
+ * see @ref toRgbUnbound(const cmsCIELab *, RgbDouble *, bool *, const int) const
+ *
+ * @param lchBuffer Pointer to the first of <tt>count</tt> LCh colors.
+ * @param rgbBuffer Pointer to a buffer for at least <tt>count</tt> values.
+ * @param isInGamutBuffer Pointer to a buffer for at least <tt>count</tt>
+ * values.
+ * @param count The number of colors to convert. */
+void RgbColorSpace::toRgbUnbound(const PerceptualColor::LchDouble *lchBuffer, RgbDouble *rgbBuffer, bool *isInGamutBuffer, const int count) const
+{
+    if (count <= 0) {
+        return;
+    }
+    const QVector<cmsCIELab> labBuffer = d_pointer->toLab(lchBuffer, count);
+    toRgbUnbound(labBuffer.constData(), rgbBuffer, isInGamutBuffer, count);
+}
+
+/** @brief Converts many colors at once to RGB.
+ *
+ * This is the batch version of @ref toQColorRgbBound(). All colors are
+ * converted within a <em>single</em> call to LittleCMS.
+ *
+ * @param labBuffer Pointer to the first of <tt>count</tt> L*a*b* colors.
+ * @param rgbBuffer Pointer to a buffer for at least <tt>count</tt> values.
+ * Receives the RGB values. Out-of-gamut colors are replaced by a nearby
+ * in-gamut color, exactly like @ref toQColorRgbBound() does.
+ * @param count The number of colors to convert. If <tt>0</tt> or smaller,
+ * nothing happens. */
+void RgbColorSpace::toRgbBound(const cmsCIELab *labBuffer, RgbDouble *rgbBuffer, const int count) const
+{
+    if (count <= 0) {
+        return;
+    }
+    // The 16-bit transform writes three integer values per color.
+    QVector<cmsUInt16Number> rgb16(count * 3);
+    InstrumentationScope::count("cmsDoTransform");
+    cmsDoTransform(
+        // Parameters:
+        d_pointer->threadData()->m_transformLabToRgb16Handle, // handle to transform function
+        labBuffer,                                            // input
+        rgb16.data(),                                         // output
+        static_cast<cmsUInt32Number>(count)                   // number of values to convert
+    );
+    for (int i = 0; i < count; ++i) {
+        rgbBuffer[i].red = rgb16.at(i * 3) / static_cast<qreal>(65535);
+        rgbBuffer[i].green = rgb16.at(i * 3 + 1) / static_cast<qreal>(65535);
+        rgbBuffer[i].blue = rgb16.at(i * 3 + 2) / static_cast<qreal>(65535);
+    }
+}
+
+/** @brief Converts many colors at once to RGB.
+ *
+ * This is the batch version of @ref toQColorRgbBound(). For details
+ * see @ref toRgbBound(const cmsCIELab *, RgbDouble *, const int) const
+ *
+ * @param lchBuffer Pointer to the first of <tt>count</tt> LCh colors.
+ * @param rgbBuffer Pointer to a buffer for at least <tt>count</tt> values.
+ * @param count The number of colors to convert. */
+void RgbColorSpace::toRgbBound(const PerceptualColor::LchDouble *lchBuffer, RgbDouble *rgbBuffer, const int count) const
+{
+    if (count <= 0) {
+        return;
+    }
+    const QVector<cmsCIELab> labBuffer = d_pointer->toLab(lchBuffer, count);
+    toRgbBound(labBuffer.constData(), rgbBuffer, count);
+}
+
+/** @brief Converts many LCh colors to Lab.
+ *
+ * @param lchBuffer Pointer to the first of <tt>count</tt> LCh colors.
+ * @param count The number of colors.
+ * @returns The corresponding Lab colors, in the same order. */
+QVector<cmsCIELab> RgbColorSpace::RgbColorSpacePrivate::toLab(const LchDouble *lchBuffer, const int count)
+{
+    QVector<cmsCIELab> result(qMax(count, 0));
+    cmsCIELab *resultData = result.data();
+    cmsCIELCh myCmsCieLch;
+    for (int i = 0; i < result.count(); ++i) {
+        myCmsCieLch = toCmsCieLch(lchBuffer[i]);
+        cmsLCh2Lab(resultData + i, &myCmsCieLch);
+    }
+    return result;
+}
+
 RgbDouble RgbColorSpace::RgbColorSpacePrivate::colorRgbBoundSimple(const cmsCIELab &Lab) const
 {
     cmsUInt16Number rgb_int[3];
+    InstrumentationScope::count("cmsDoTransform");
     cmsDoTransform(
         // Parameters:
-        m_transformLabToRgb16Handle, // handle to transform function
-        &Lab,                        // input
-        rgb_int,                     // output
-        1                            // convert exactly 1 value
+        threadData()->m_transformLabToRgb16Handle, // handle to transform function
+        &Lab,                                      // input
+        rgb_int,                                   // output
+        1                                          // convert exactly 1 value
     );
     RgbDouble temp;
     temp.red = rgb_int[0] / static_cast<qreal>(65535);
@@ -483,12 +1127,13 @@ bool RgbColorSpace::isInGamut(const cmsCIELab &lab) const
 {
     RgbDouble rgb;
 
+    InstrumentationScope::count("cmsDoTransform");
     cmsDoTransform(
         // Parameters:
-        d_pointer->m_transformLabToRgbHandle, // handle to transform function
-        &lab,                                 // input
-        &rgb,                                 // output
-        1                                     // convert exactly 1 value
+        d_pointer->threadData()->m_transformLabToRgbHandle, // handle to transform function
+        &lab,                                               // input
+        &rgb,                                               // output
+        1                                                   // convert exactly 1 value
     );
 
     return (isInRange<cmsFloat64Number>(0, rgb.red, 1) && isInRange<cmsFloat64Number>(0, rgb.green, 1) && isInRange<cmsFloat64Number>(0, rgb.blue, 1));
@@ -526,6 +1171,43 @@ QString RgbColorSpace::profileInfoModel() const
     return d_pointer->m_cmsInfoModel;
 }
 
+/** @brief Calculates the data that is otherwise calculated lazily
+ * on first use.
+ *
+ * Some data, like the table of the maximum chroma, is calculated lazily
+ * on first use. This function calculates it now, so that the first use
+ * is fast. This is useful on a worker thread before handing the object
+ * to the GUI thread. Calling this function more than once is cheap.
+ *
+ * @param callback Optional. Called after each step; see
+ * @ref PrecalculationCallback.
+ *
+ * @returns <tt>true</tt> if the calculation has finished. <tt>false</tt>
+ * if it has been aborted by the callback. */
+bool RgbColorSpace::precalculate(const PrecalculationCallback &callback) const
+{
+    const InstrumentationScope instrumentationScope("RgbColorSpace::precalculate");
+    constexpr int totalSteps = RgbColorSpacePrivate::maximumChromaTableLightnessCount - 1;
+    for (int lightnessIndex = 0; lightnessIndex < totalSteps; ++lightnessIndex) {
+        d_pointer->ensureMaximumChromaCellRow(lightnessIndex);
+        if (callback && !callback(lightnessIndex + 1, totalSteps)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Identifier of the profile.
+ *
+ * @returns A hash value of the profile. Two color space objects that are
+ * created from the same profile have the same identifier, even if they
+ * are created in different processes. Different profiles have different
+ * identifiers. This is useful as a key for persistent caches. */
+QByteArray RgbColorSpace::profileIdentifier() const
+{
+    return d_pointer->m_profileIdentifier;
+}
+
 /** @returns A <em>normalized</em> (this is guaranteed!) in-gamut color,
  * maybe with different chroma (and even lightness??)
  *
@@ -545,42 +1227,27 @@ PerceptualColor::LchDouble RgbColorSpace::nearestInGamutColorByAdjustingChroma(c
     }
 
     // Now we know: We are out-of-gamut…
-    LchDouble lowerChroma {result.l, 0, result.h};
-    LchDouble upperChroma {result};
-    LchDouble candidate;
-    if (isInGamut(lowerChroma)) {
-        // Now we know for sure that lowerChroma is in-gamut
-        // and upperChroma is out-of-gamut…
-        candidate = upperChroma;
-        while (upperChroma.c - lowerChroma.c > gamutPrecision) {
-            // Our test candidate is half the way between lowerChroma
-            // and upperChroma:
-            candidate.c = ((lowerChroma.c + upperChroma.c) / 2);
-            if (isInGamut(candidate)) {
-                lowerChroma = candidate;
-            } else {
-                upperChroma = candidate;
-            }
-        }
-        result = lowerChroma;
+    if ((result.l >= d_pointer->m_blackpointL) && (result.l <= d_pointer->m_whitepointL)) {
+        // Gray is in-gamut, so there is an in-gamut chroma. The maximum
+        // chroma table gives the starting interval, which is refined
+        // to full precision within the error bound of the table cell.
+        result.c = qMin(result.c, d_pointer->refinedMaximumChroma(result.l, result.h));
     } else {
         if (result.l < d_pointer->m_blackpointL) {
             result.l = d_pointer->m_blackpointL;
             result.c = 0;
         } else {
-            if (result.l > d_pointer->m_whitepointL) {
-                result.l = d_pointer->m_blackpointL;
-                result.c = 0;
-            }
+            result.l = d_pointer->m_whitepointL;
+            result.c = 0;
         }
     }
 
     return result;
 }
 
-PerceptualColor::LchDouble RgbColorSpace::nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble &color)
+PerceptualColor::LchDouble RgbColorSpace::nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble &color) const
 {
-    // TODO Would be great if this function could be const
+    const InstrumentationScope instrumentationScope("RgbColorSpace::nearestInGamutColorByAdjustingChromaLightness");
 
     // Initialization
     LchDouble temp = color;
@@ -592,81 +1259,91 @@ PerceptualColor::LchDouble RgbColorSpace::nearestInGamutColorByAdjustingChromaLi
         return temp;
     }
 
+    // Nearest-neighbor search in the raster of the gamut slice.
+    constexpr qreal pixelsPerUnit = (RgbColorSpacePrivate::gamutSliceHeight - 1) / 100.0;
     QPoint myPixelPosition( //
-        qRound(temp.c * (d_pointer->nearestNeighborSearchImageHeight - 1) / 100.0),
-        qRound(d_pointer->nearestNeighborSearchImageHeight - 1 - temp.l * (d_pointer->nearestNeighborSearchImageHeight - 1) / 100.0));
-    d_pointer->m_nearestNeighborSearchImage->setHue(temp.h);
-    myPixelPosition = d_pointer->nearestNeighborSearch( //
-        myPixelPosition,
-        d_pointer->m_nearestNeighborSearchImage->getImage());
+        qRound(temp.c * pixelsPerUnit),
+        qRound((100 - temp.l) * pixelsPerUnit));
+    myPixelPosition = d_pointer->gamutSlice(temp.h)->nearestInGamutPixel(myPixelPosition);
     LchDouble result = temp;
-    result.c = myPixelPosition.x() * 100.0 / (d_pointer->nearestNeighborSearchImageHeight - 1);
-    result.l = 100 - myPixelPosition.y() * 100.0 / (d_pointer->nearestNeighborSearchImageHeight - 1);
+    result.c = myPixelPosition.x() / pixelsPerUnit;
+    result.l = 100 - myPixelPosition.y() / pixelsPerUnit;
     return result;
 }
 
-/** @brief Search the nearest non-transparent neighbor pixel
- *
- * This implements a
- * <a href="https://en.wikipedia.org/wiki/Nearest_neighbor_search">
- * Nearest-neighbor-search</a>.
- *
- * @note This code is an inefficient implementation. See
- * <a href="https://stackoverflow.com/questions/307445/finding-closest-non-black-pixel-in-an-image-fast">here</a>
- * for a better approach.
- *
- * @param originalPoint The point for which you search the nearest neighbor,
- * expressed in the coordinate system of the image. This point may be within
- * or outside the image.
- * @param image The image in which the nearest neighbor is searched.
- * Must contain at least one pixel with an alpha value that is fully opaque.
- * @returns
- * \li If originalPoint itself is within the image and a
- *     non-transparent pixel, it returns originalPoint.
- * \li Else, if there is are non-transparent pixels in the image, the nearest
- *     non-transparent pixel is returned. (If there are various nearest
- *     neighbors at the same distance, it is undefined which one is returned.)
- * \li Else there are no non-transparent pixels, and simply the point
- *     <tt>0, 0</tt> is returned, but this is a very slow case.
- *
- * TODO Do not use nearest neighbor or other pixel based search algorithms,
- * but work directly with LittleCMS, maybe with a limited, but well-defined,
- * precision… */
-QPoint RgbColorSpace::RgbColorSpacePrivate::nearestNeighborSearch(const QPoint originalPoint, const QImage &image)
-{
-    // Test for special case:
-    // originalPoint itself is within the image and non-transparent
-    if (image.valid(originalPoint)) {
-        if (image.pixelColor(originalPoint).alpha() == 255) {
-            return originalPoint;
+/** @brief Gamut slice for the nearest-neighbor search.
+ *
+ * This function is thread-safe. The slices are kept in
+ * @ref m_gamutSliceCache, which is shared by all threads. The
+ * calculation itself is done without holding the lock, so that other
+ * threads are not blocked in the meantime.
+ *
+ * @param hue The hue. It is quantized with @ref gamutSliceKey(): All hues
+ * that have the same key get the same slice.
+ * @returns The chroma-lightness plane at the given hue, with the height
+ * @ref gamutSliceHeight. The pixel <tt>(x, y)</tt> corresponds to
+ * chroma <tt>x * 100 / (height - 1)</tt> and lightness
+ * <tt>100 - y * 100 / (height - 1)</tt>. The width covers the chroma
+ * range up to @ref LchValues::humanMaximumChroma. */
+QSharedPointer<const GamutSlice> RgbColorSpace::RgbColorSpacePrivate::gamutSlice(const qreal hue) const
+{
+    const int key = gamutSliceKey(hue);
+    {
+        QMutexLocker locker(&m_gamutSliceCacheMutex);
+        const QSharedPointer<const GamutSlice> *cachedSlice = m_gamutSliceCache.object(key);
+        if (cachedSlice != nullptr) {
+            ++m_gamutSliceCacheHits;
+            InstrumentationScope::count("GamutSlice cache hit");
+            return *cachedSlice;
         }
+        ++m_gamutSliceCacheMisses;
+        InstrumentationScope::count("GamutSlice cache miss");
     }
+    const InstrumentationScope instrumentationScope("RgbColorSpacePrivate::gamutSlice calculation");
 
-    // No special case. So we have to actually perform
-    // a nearest-neighbor-search.
-    int x;
-    int y;
-    int currentBestX = 0; // 0 is the fallback value
-    int currentBestY = 0; // 0 is the fallback value
-    int currentBestDistanceSquare = std::numeric_limits<int>::max();
-    int x_distance;
-    int y_distance;
-    int temp;
-    for (x = 0; x < image.width(); x++) {
-        for (y = 0; y < image.height(); y++) {
-            if (image.pixelColor(x, y).alpha() == 255) {
-                x_distance = originalPoint.x() - x;
-                y_distance = originalPoint.y() - y;
-                temp = x_distance * x_distance + y_distance * y_distance;
-                if (temp < currentBestDistanceSquare) {
-                    currentBestX = x;
-                    currentBestY = y;
-                    currentBestDistanceSquare = temp;
-                }
-            }
+    constexpr int height = gamutSliceHeight;
+    constexpr qreal pixelsPerUnit = (height - 1) / 100.0;
+    const int width = qRound(LchValues::humanMaximumChroma * pixelsPerUnit) + 1;
+    QVector<bool> inGamutMask(width * height);
+    QVector<LchDouble> lchBuffer(width);
+    QVector<RgbDouble> rgbBuffer(width);
+    LchDouble lch;
+    lch.h = static_cast<qreal>(key) / gamutSliceHueResolution;
+    for (int y = 0; y < height; ++y) {
+        lch.l = 100 - y / pixelsPerUnit;
+        for (int x = 0; x < width; ++x) {
+            lch.c = x / pixelsPerUnit;
+            lchBuffer[x] = lch;
         }
+        q_pointer->toRgbUnbound(lchBuffer.constData(), //
+                                rgbBuffer.data(),
+                                inGamutMask.data() + y * width,
+                                width);
     }
-    return QPoint(currentBestX, currentBestY);
+    const QSharedPointer<const GamutSlice> result(new GamutSlice(width, height, inGamutMask));
+
+    {
+        QMutexLocker locker(&m_gamutSliceCacheMutex);
+        // If the slice is bigger than the budget, QCache refuses to
+        // insert it and deletes the (shared) pointer immediately. This
+        // does not affect “result”.
+        m_gamutSliceCache.insert(key, //
+                                 new QSharedPointer<const GamutSlice>(result),
+                                 result->sizeInBytes());
+    }
+    return result;
+}
+
+/** @brief Key for @ref m_gamutSliceCache.
+ *
+ * @param hue The hue.
+ * @returns The normalized hue, quantized to
+ * @ref gamutSliceHueResolution steps per degree. Range:
+ * <tt>[0, 360 * gamutSliceHueResolution[</tt> */
+int RgbColorSpace::RgbColorSpacePrivate::gamutSliceKey(const qreal hue)
+{
+    constexpr int keyCount = 360 * gamutSliceHueResolution;
+    return qRound(PolarPointF::normalizedAngleDegree(hue) * gamutSliceHueResolution) % keyCount;
 }
 
 /** @brief Get information from an ICC profile via LittleCMS
@@ -797,4 +1474,60 @@ int RgbColorSpace::maximumChroma() const
     return d_pointer->m_maximumChroma;
 }
 
+/** @brief Memory budget of the gamut slice cache.
+ *
+ * @ref nearestInGamutColorByAdjustingChromaLightness() needs a gamut
+ * slice for the hue of the color. Calculating a gamut slice is
+ * expensive, therefore the most recently used slices are cached (hues
+ * are quantized to 0.01°). The cache is shared by all threads.
+ *
+ * @returns The maximum memory usage of the cache, measured in bytes.
+ *
+ * @sa @ref setGamutSliceCacheBudget()
+ * @sa @ref gamutSliceCacheHits()
+ * @sa @ref gamutSliceCacheMisses() */
+int RgbColorSpace::gamutSliceCacheBudget() const
+{
+    QMutexLocker locker(&d_pointer->m_gamutSliceCacheMutex);
+    return d_pointer->m_gamutSliceCache.maxCost();
+}
+
+/** @brief Number of cache hits of the gamut slice cache.
+ *
+ * @returns The number of requests that have been served from the
+ * cache since this object has been created.
+ *
+ * @sa @ref gamutSliceCacheBudget() */
+quint64 RgbColorSpace::gamutSliceCacheHits() const
+{
+    QMutexLocker locker(&d_pointer->m_gamutSliceCacheMutex);
+    return d_pointer->m_gamutSliceCacheHits;
+}
+
+/** @brief Number of cache misses of the gamut slice cache.
+ *
+ * @returns The number of requests that required to calculate a new
+ * gamut slice since this object has been created.
+ *
+ * @sa @ref gamutSliceCacheBudget() */
+quint64 RgbColorSpace::gamutSliceCacheMisses() const
+{
+    QMutexLocker locker(&d_pointer->m_gamutSliceCacheMutex);
+    return d_pointer->m_gamutSliceCacheMisses;
+}
+
+/** @brief Setter for @ref gamutSliceCacheBudget().
+ *
+ * If the new budget is smaller than the current memory usage, the least
+ * recently used slices are removed from the cache immediately.
+ *
+ * @param newBudget The new memory budget, measured in bytes. <tt>0</tt>
+ * disables the cache. Negative values are treated as <tt>0</tt>. A single
+ * gamut slice of the default size needs roughly 1.3 MB. */
+void RgbColorSpace::setGamutSliceCacheBudget(const int newBudget)
+{
+    QMutexLocker locker(&d_pointer->m_gamutSliceCacheMutex);
+    d_pointer->m_gamutSliceCache.setMaxCost(qMax(newBudget, 0));
+}
+
 } // namespace PerceptualColor
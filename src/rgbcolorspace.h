@@ -30,20 +30,27 @@
 #include "PerceptualColor/perceptualcolorglobal.h"
 #include "perceptualcolorinternal.h"
 
+#include <QByteArray>
 #include <QObject>
 
 #include "PerceptualColor/constpropagatinguniquepointer.h"
 #include "PerceptualColor/lchadouble.h"
 #include "PerceptualColor/lchdouble.h"
+#include "rgbdouble.h"
 
 #include <lcms2.h>
 
+#include <functional>
+
 namespace PerceptualColor
 {
 /** @internal
  *
  * @brief Provides access to LittleCMS color management library
  *
+ * All functions of this class are thread-safe: They can be called
+ * concurrently from various threads.
+ *
  * @todo We return double precision values. But doesn’t use LittleCMS
  *       only 16-bit-integer internally? On the other hand: Using double
  *       precision allows to filter out out-of-range values… */
@@ -57,30 +64,50 @@ class RgbColorSpace : public QObject
     Q_PROPERTY(QString profileInfoModel READ profileInfoModel CONSTANT)
 
 public:
+    /** @brief A callback for @ref precalculate().
+     *
+     * The arguments are the number of finished steps and the total number
+     * of steps. When the callback returns <tt>false</tt>, the calculation
+     * is aborted. */
+    using PrecalculationCallback = std::function<bool(const int finishedSteps, const int totalSteps)>;
+
     Q_INVOKABLE static QSharedPointer<PerceptualColor::RgbColorSpace> createFromFile(const QString &fileName);
+    Q_INVOKABLE static QSharedPointer<PerceptualColor::RgbColorSpace> createFromMemory(const QByteArray &data);
     Q_INVOKABLE static QSharedPointer<PerceptualColor::RgbColorSpace> createSrgb();
     virtual ~RgbColorSpace() noexcept override;
+    int gamutSliceCacheBudget() const;
+    quint64 gamutSliceCacheHits() const;
+    quint64 gamutSliceCacheMisses() const;
     Q_INVOKABLE bool isInGamut(const cmsCIELab &lab) const;
     Q_INVOKABLE bool isInGamut(const PerceptualColor::LchDouble &lch) const;
     Q_INVOKABLE int maximumChroma() const;
     Q_INVOKABLE PerceptualColor::LchDouble nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble &color) const;
-    Q_INVOKABLE PerceptualColor::LchDouble nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble &color);
+    Q_INVOKABLE PerceptualColor::LchDouble nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble &color) const;
+    bool precalculate(const PrecalculationCallback &callback = PrecalculationCallback()) const;
+    QByteArray profileIdentifier() const;
     QString profileInfoCopyright() const;
     QString profileInfoDescription() const;
     QString profileInfoManufacturer() const;
     QString profileInfoModel() const;
+    void setGamutSliceCacheBudget(const int newBudget);
     Q_INVOKABLE PerceptualColor::LchDouble toLch(const cmsCIELab &lab) const;
     Q_INVOKABLE PerceptualColor::LchDouble toLch(const QColor &rgbColor) const;
     Q_INVOKABLE QColor toQColorRgbBound(const PerceptualColor::LchDouble &lch) const;
     Q_INVOKABLE QColor toQColorRgbBound(const PerceptualColor::LchaDouble &lcha) const;
     Q_INVOKABLE QColor toQColorRgbUnbound(const cmsCIELab &Lab) const;                  // TODO Isn’t QColor _always_ bound??? No: Unbound means, out-of-gamut color create an INVALID QColor.
     Q_INVOKABLE QColor toQColorRgbUnbound(const PerceptualColor::LchDouble &lch) const; // TODO Isn’t QColor _always_ bound???
+    void toRgbBound(const cmsCIELab *labBuffer, RgbDouble *rgbBuffer, const int count) const;
+    void toRgbBound(const PerceptualColor::LchDouble *lchBuffer, RgbDouble *rgbBuffer, const int count) const;
+    void toRgbUnbound(const cmsCIELab *labBuffer, RgbDouble *rgbBuffer, bool *isInGamutBuffer, const int count) const;
+    void toRgbUnbound(const PerceptualColor::LchDouble *lchBuffer, RgbDouble *rgbBuffer, bool *isInGamutBuffer, const int count) const;
 
 private:
     Q_DISABLE_COPY(RgbColorSpace)
 
     RgbColorSpace(QObject *parent = nullptr);
 
+    static QSharedPointer<PerceptualColor::RgbColorSpace> createFromIOHandler(cmsIOHANDLER *ioHandler);
+
     class RgbColorSpacePrivate;
     /** @internal
      *
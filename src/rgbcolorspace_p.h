@@ -33,17 +33,39 @@
 // Include the header of the public class of this private implementation.
 #include "rgbcolorspace.h"
 
-#include "chromalightnessimage.h"
 #include "constpropagatingrawpointer.h"
+#include "gamutslice.h"
 #include "lchvalues.h"
 #include "rgbdouble.h"
 
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+#include <QWeakPointer>
+
 namespace PerceptualColor
 {
 /** @internal
  *
  *  @brief Private implementation within the <em>Pointer to
- *  implementation</em> idiom */
+ *  implementation</em> idiom
+ *
+ * <b>Thread safety</b>
+ *
+ * All functions of @ref RgbColorSpace can be called from various threads
+ * at the same time. To make this possible without a lock on the hot path
+ * of color conversion, each thread gets its own LittleCMS context, its own
+ * transforms and its own scratch memory (see @ref ThreadData). They are
+ * created from @ref m_profileData the first time a thread uses this color
+ * space (see @ref threadData()). All other data members are immutable
+ * after @ref initialize() has finished, except the data that is
+ * calculated lazily on first use (@ref m_gamutSliceCache,
+ * @ref m_maximumChromaTable), which is protected by its own mutex. */
 class RgbColorSpace::RgbColorSpacePrivate final
 {
 public:
@@ -54,6 +76,38 @@ public:
      * the class as a whole is <tt>final</tt>. */
     ~RgbColorSpacePrivate() noexcept = default;
 
+    /** @internal
+     *
+     * @brief Resources that are used exclusively by a single thread.
+     *
+     * LittleCMS contexts and transforms are not shared between threads. */
+    class ThreadData final
+    {
+    public:
+        /** @brief Default constructor */
+        ThreadData() = default;
+        ~ThreadData() noexcept;
+        bool isValid() const;
+        void release();
+        /** @brief The LittleCMS context of this thread. */
+        cmsContext m_context = nullptr;
+        /** @brief If @ref release() has been called.
+         *
+         * Atomic because @ref release() might be called by another
+         * thread than the owning thread. Released entries are removed
+         * from @ref threadLocalRegistry() by the owning thread. */
+        QAtomicInt m_isReleased {0};
+        /** @brief Transform of this thread. */
+        cmsHTRANSFORM m_transformLabToRgb16Handle = nullptr;
+        /** @brief Transform of this thread. */
+        cmsHTRANSFORM m_transformLabToRgbHandle = nullptr;
+        /** @brief Transform of this thread. */
+        cmsHTRANSFORM m_transformRgbToLabHandle = nullptr;
+
+    private:
+        Q_DISABLE_COPY(ThreadData)
+    };
+
     // Data members:
     /** @brief The darkest in-gamut point on the L* axis.
      * @sa whitepointL */
@@ -62,36 +116,149 @@ public:
     QString m_cmsInfoDescription;
     QString m_cmsInfoManufacturer;
     QString m_cmsInfoModel;
+    /** @brief Cache for @ref gamutSlice().
+     *
+     * Least-recently-used cache. The key is the hue, quantized with
+     * @ref gamutSliceKey(). The cost is the memory usage in bytes,
+     * so the maximum cost is the memory budget.
+     *
+     * Protected by @ref m_gamutSliceCacheMutex. */
+    mutable QCache<int, QSharedPointer<const GamutSlice>> m_gamutSliceCache;
+    /** @brief Number of cache hits of @ref m_gamutSliceCache.
+     *
+     * Protected by @ref m_gamutSliceCacheMutex. */
+    mutable quint64 m_gamutSliceCacheHits = 0;
+    /** @brief Number of cache misses of @ref m_gamutSliceCache.
+     *
+     * Protected by @ref m_gamutSliceCacheMutex. */
+    mutable quint64 m_gamutSliceCacheMisses = 0;
+    /** @brief Protects @ref m_gamutSliceCache and its counters. */
+    mutable QMutex m_gamutSliceCacheMutex;
     int m_maximumChroma = LchValues::humanMaximumChroma;
-    cmsHTRANSFORM m_transformLabToRgb16Handle = nullptr;
-    cmsHTRANSFORM m_transformLabToRgbHandle = nullptr;
-    cmsHTRANSFORM m_transformRgbToLabHandle = nullptr;
+    /** @brief For each cell row (the area between two neighboring rows
+     * of @ref m_maximumChromaTable), if it is ready.
+     *
+     * <tt>0</tt> means “not yet calculated”, <tt>1</tt> means “ready”:
+     * Both rows of @ref m_maximumChromaTable and the row of
+     * @ref m_maximumChromaErrorTable have been calculated. Once a cell row
+     * is ready, it is never written again, so it can be read
+     * without locking.
+     *
+     * @sa @ref ensureMaximumChromaCellRow() */
+    mutable QVector<QAtomicInt> m_maximumChromaCellRowReady;
+    /** @brief Error bounds of the interpolation of
+     * @ref m_maximumChromaTable.
+     *
+     * Row-major table with one entry per cell: <tt>100</tt> rows and
+     * <tt>360</tt> columns. The entry for the cell with the lower left
+     * corner at lightness <tt>l</tt> and hue <tt>h</tt> is the maximum
+     * difference between the interpolated and the actual maximum chroma
+     * within this cell, as measured at the center and at the midpoints of
+     * the edges, with a safety margin.
+     *
+     * Rows that are not ready (see @ref m_maximumChromaCellRowReady)
+     * contain garbage.
+     *
+     * @sa @ref refinedMaximumChroma() */
+    mutable QVector<float> m_maximumChromaErrorTable;
+    /** @brief For each row of @ref m_maximumChromaTable, if it has
+     * already been calculated.
+     *
+     * Protected by @ref m_maximumChromaTableMutex. Readers without the
+     * lock use @ref m_maximumChromaCellRowReady instead. */
+    mutable QVector<bool> m_maximumChromaRowReady;
+    /** @brief Table of the maximum in-gamut chroma.
+     *
+     * Row-major table with @ref maximumChromaTableLightnessCount rows
+     * (lightness <tt>0</tt>, <tt>1</tt>, …, <tt>100</tt>) and
+     * @ref maximumChromaTableHueCount columns (hue <tt>0°</tt>, <tt>1°</tt>,
+     * …, <tt>360°</tt>; the last column repeats the first one to simplify
+     * the interpolation). Each entry is the maximum chroma that is still
+     * in-gamut, with a precision of @ref gamutPrecision.
+     *
+     * The rows are calculated lazily, on first use. Rows that are not
+     * ready (see @ref m_maximumChromaCellRowReady) contain garbage.
+     *
+     * @sa @ref interpolatedMaximumChroma() */
+    mutable QVector<float> m_maximumChromaTable;
+    /** @brief Serializes the calculation of rows of
+     * @ref m_maximumChromaTable and @ref m_maximumChromaErrorTable. */
+    mutable QMutex m_maximumChromaTableMutex;
+    /** @brief Store for @ref RgbColorSpace::profileIdentifier() */
+    QByteArray m_profileIdentifier;
+    /** @brief The RGB profile, serialized as ICC data.
+     *
+     * This is used to create the transforms of each thread. */
+    QByteArray m_profileData;
+    /** @brief Unique number of this object.
+     *
+     * Unlike the address of this object, this number is never reused
+     * within the same process. It identifies this object within
+     * @ref threadLocalRegistry(). */
+    const quint64 m_serialNumber;
+    /** @brief Protects @ref m_threadDataList. */
+    mutable QMutex m_threadDataMutex;
+    /** @brief The @ref ThreadData of all threads that use this object.
+     *
+     * The data is owned by the threads; it is freed when the thread
+     * exits. This list allows to release the resources when <em>this</em>
+     * object is destroyed while the threads are still running.
+     *
+     * Protected by @ref m_threadDataMutex. */
+    mutable QList<QWeakPointer<ThreadData>> m_threadDataList;
     /** @brief The lightest in-gamut point on the L* axis.
      * @sa blackpointL() */
     qreal m_whitepointL;
 
+    // Constants:
+    /** @brief Default value for the memory budget of
+     * @ref m_gamutSliceCache, measured in bytes.
+     *
+     * This is enough for about a dozen slices. */
+    static constexpr int defaultGamutSliceCacheBudget = 16 * 1024 * 1024;
+    /** @brief Resolution of the hue quantization for
+     * @ref m_gamutSliceCache, measured in steps per degree. */
+    static constexpr int gamutSliceHueResolution = 100;
+    /** @brief Number of rows of @ref m_maximumChromaTable */
+    static constexpr int maximumChromaTableLightnessCount = 101;
+    /** @brief Number of columns of @ref m_maximumChromaTable */
+    static constexpr int maximumChromaTableHueCount = 361;
+    /** @brief Factor between the measured interpolation error and the
+     * entries of @ref m_maximumChromaErrorTable.
+     *
+     * The error is only measured at some points of each cell; this
+     * margin covers the points in between. */
+    static constexpr qreal maximumChromaErrorSafetyFactor = 2;
+
     // Functions:
+    void calculateMaximumChroma(const LchDouble *points, qreal *result, const int count) const;
+    void calculateMaximumChromaErrorRow(const int lightnessIndex, float *errorRow) const;
+    void calculateMaximumChromaRow(const int lightness, float *row) const;
     cmsCIELab colorLab(const RgbDouble &rgb) const;
+    void ensureMaximumChromaCellRow(const int lightnessIndex) const;
     RgbDouble colorRgbBoundSimple(const cmsCIELab &Lab) const;
+    ThreadData *createThreadData() const;
     static void deleteTransform(cmsHTRANSFORM &transformHandle);
     static QString getInformationFromProfile(cmsHPROFILE profileHandle, cmsInfoType infoType);
+    qreal grayAxisBoundary(const qreal inGamutLightness, const qreal limit) const;
     bool initialize(cmsHPROFILE rgbProfileHandle);
+    qreal interpolatedMaximumChroma(const qreal lightness, const qreal hue, qreal *errorBound = nullptr) const;
+    qreal interpolatedMaximumChromaInCell(const int lightnessIndex, const int hueIndex, const qreal lightnessFraction, const qreal hueFraction) const;
+    qreal refinedMaximumChroma(const qreal lightness, const qreal hue) const;
+    void releaseAllThreadData();
+    ThreadData *threadData() const;
+    static QHash<quint64, QSharedPointer<ThreadData>> &threadLocalRegistry();
     cmsCIELab toLab(const QColor &rgbColor) const;
+    static QVector<cmsCIELab> toLab(const LchDouble *lchBuffer, const int count);
     QColor toQColorRgbBound(const cmsCIELab &Lab) const;
 
-    // Dirty hacks:
-    static QPoint nearestNeighborSearch(const QPoint originalPoint, const QImage &image);
-    /** TODO WARNING This is a memory leak. This member is not deleted in
-     * the desctuctor of the class. This is because ChromaLightnessImage has
-     * a shared pointer to _this_ object. If nearestNeighborSearchImage
-     * would be on the heap, deleting in when _this_ object is deleted will
-     * call again deleting _this_ object, and this recursive destructor
-     * call will crash the library. Therefore, we implement
-     * nearestNeighborSearchImage as a pointer with memory leak to avoid
-     * the crash. This memory leak is not fixed currently, because
-     * anyway we need to re-write all the code for nearest-neigbor search. */
-    ChromaLightnessImage *m_nearestNeighborSearchImage;
-    static constexpr int nearestNeighborSearchImageHeight = 400;
+    // Nearest-neighbor search:
+    QSharedPointer<const GamutSlice> gamutSlice(const qreal hue) const;
+    static int gamutSliceKey(const qreal hue);
+    /** @brief Height of the raster of @ref gamutSlice().
+     *
+     * The raster covers the lightness range <tt>[0, 100]</tt>. */
+    static constexpr int gamutSliceHeight = 400;
 
 private:
     Q_DISABLE_COPY(RgbColorSpacePrivate)
@@ -31,10 +31,305 @@
 // First the interface, which forces the header to be self-contained.
 #include "PerceptualColor/rgbcolorspacefactory.h"
 
+#include "instrumentationscope.h"
 #include "rgbcolorspace.h"
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureInterface>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QWeakPointer>
+
+#include <limits>
+
 namespace PerceptualColor
 {
+namespace
+{
+/** @internal @brief What is known about a profile file. */
+struct ProfileFileEntry {
+    /** @brief The file size at the time of the last check. */
+    qint64 size = 0;
+    /** @brief The modification time at the time of the last check. */
+    QDateTime lastModified;
+    /** @brief The profile ID of the file content at the time of
+     * the last check. */
+    QByteArray profileId;
+};
+
+/** @internal @brief Global state of @ref RgbColorSpaceFactory. */
+struct RgbColorSpaceFactoryState {
+    /** @brief Protects all other members. */
+    QMutex mutex;
+    /** @brief The profile files that have been loaded, by canonical path.
+     *
+     * If size and modification time of a file are unchanged, and the
+     * color space with its profile ID is still alive, that color space
+     * is returned without reading the file again. */
+    QHash<QString, ProfileFileEntry> files;
+    /** @brief The color spaces, by profile ID.
+     *
+     * The references are weak: The cache does not keep color spaces
+     * alive that are not used anymore elsewhere. */
+    QHash<QByteArray, QWeakPointer<RgbColorSpace>> colorSpaces;
+};
+
+/** @internal @brief The global state of @ref RgbColorSpaceFactory.
+ *
+ * @returns The global state. */
+RgbColorSpaceFactoryState &state()
+{
+    static RgbColorSpaceFactoryState globalState;
+    return globalState;
+}
+
+/** @internal @brief Removes the entries of color spaces that have
+ * been deleted.
+ *
+ * @pre The caller holds the mutex of @ref state(). */
+void removeExpiredEntries()
+{
+    RgbColorSpaceFactoryState &myState = state();
+    auto colorSpaceIterator = myState.colorSpaces.begin();
+    while (colorSpaceIterator != myState.colorSpaces.end()) {
+        if (colorSpaceIterator.value().isNull()) {
+            colorSpaceIterator = myState.colorSpaces.erase(colorSpaceIterator);
+        } else {
+            ++colorSpaceIterator;
+        }
+    }
+    auto fileIterator = myState.files.begin();
+    while (fileIterator != myState.files.end()) {
+        if (myState.colorSpaces.contains(fileIterator.value().profileId)) {
+            ++fileIterator;
+        } else {
+            fileIterator = myState.files.erase(fileIterator);
+        }
+    }
+}
+
+/** @internal @brief Hands a newly created color space object over to
+ * the main thread.
+ *
+ * Color space objects might be created on worker threads, which might
+ * exit while the object is still in use. Therefore, objects are moved to
+ * the thread of <tt>QCoreApplication</tt>, which outlives the worker
+ * threads. This has to happen before the object is published to other
+ * threads, because an object can only be moved by its own thread.
+ *
+ * @param colorSpace The color space object. Must have been created
+ * by the current thread. */
+void moveToMainThread(const QSharedPointer<RgbColorSpace> &colorSpace)
+{
+    QCoreApplication *application = QCoreApplication::instance();
+    const bool isMovable = (application != nullptr) //
+        && (!colorSpace.isNull()) //
+        && (colorSpace->thread() == QThread::currentThread());
+    if (isMovable) {
+        colorSpace->moveToThread(application->thread());
+    }
+}
+
+/** @internal @brief The progress value of the asynchronous creation
+ * when the color space object has been created.
+ *
+ * The remaining progress is used for @ref RgbColorSpace::precalculate().
+ * The range of the progress value is <tt>[0, 100]</tt>. */
+constexpr int createdProgressValue = 20;
+
+/** @internal
+ *
+ * @brief Worker thread task for the asynchronous creation of color
+ * space objects. */
+class CreationRunnable final : public QRunnable
+{
+public:
+    /** @brief Constructor
+     *
+     * @param futureInterface The interface that receives the progress
+     * and the result.
+     * @param createFunction The function that creates the color
+     * space object. */
+    CreationRunnable(const QFutureInterface<QSharedPointer<RgbColorSpace>> &futureInterface,
+                     const std::function<QSharedPointer<RgbColorSpace>()> &createFunction)
+        : m_createFunction(createFunction)
+        , m_futureInterface(futureInterface)
+    {
+    }
+    /** @brief Creates the color space object and calculates
+     * its derived data. */
+    virtual void run() override
+    {
+        if (m_futureInterface.isCanceled()) {
+            m_futureInterface.reportFinished();
+            return;
+        }
+        // Objects that go through the cache have already been moved to
+        // the main thread; others (sRGB) are moved here, before any
+        // early return.
+        const QSharedPointer<RgbColorSpace> colorSpace = m_createFunction();
+        moveToMainThread(colorSpace);
+        if (m_futureInterface.isCanceled()) {
+            m_futureInterface.reportFinished();
+            return;
+        }
+        m_futureInterface.setProgressValue(createdProgressValue);
+        if (!colorSpace.isNull()) {
+            QFutureInterface<QSharedPointer<RgbColorSpace>> &myInterface = //
+                m_futureInterface;
+            const auto callback = [&myInterface](const int finishedSteps, const int totalSteps) {
+                if (myInterface.isCanceled()) {
+                    return false;
+                }
+                myInterface.setProgressValue( //
+                    createdProgressValue //
+                    + (100 - createdProgressValue) * finishedSteps / totalSteps);
+                return true;
+            };
+            if (!colorSpace->precalculate(callback)) {
+                m_futureInterface.reportFinished();
+                return;
+            }
+        }
+        m_futureInterface.reportResult(colorSpace);
+        m_futureInterface.reportFinished();
+    }
+
+private:
+    Q_DISABLE_COPY(CreationRunnable)
+    /** @brief The function that creates the color space object. */
+    std::function<QSharedPointer<RgbColorSpace>()> m_createFunction;
+    /** @brief The interface that receives the progress and the result. */
+    QFutureInterface<QSharedPointer<RgbColorSpace>> m_futureInterface;
+};
+
+} // namespace
+
+/** @internal @brief Calculates the profile ID of ICC data.
+ *
+ * The profile ID is calculated as defined by the ICC specification: The
+ * MD5 hash of the whole profile, with the profile flags, the rendering
+ * intent and the profile ID fields of the header set to zero.
+ *
+ * The profile ID field in the header itself is not used: Many profiles
+ * leave it empty, and some tools do not update it when modifying a
+ * profile.
+ *
+ * @param data The ICC data. The data is not copied.
+ * @param size The size of the ICC data, measured in bytes.
+ * @returns The profile ID. An empty byte array if the data is too small
+ * to be an ICC profile. */
+QByteArray RgbColorSpaceFactory::profileId(const char *data, const qint64 size)
+{
+    constexpr int headerSize = 128;
+    constexpr int profileFlagsOffset = 44;
+    constexpr int renderingIntentOffset = 64;
+    constexpr int profileIdOffset = 84;
+    constexpr int profileIdSize = 16;
+    if ((data == nullptr) || (size < headerSize)) {
+        return QByteArray();
+    }
+    const QByteArray zeros(profileIdSize, 0);
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(data, profileFlagsOffset);
+    hash.addData(zeros.constData(), 4);
+    hash.addData(data + profileFlagsOffset + 4, //
+                 renderingIntentOffset - profileFlagsOffset - 4);
+    hash.addData(zeros.constData(), 4);
+    hash.addData(data + renderingIntentOffset + 4, //
+                 profileIdOffset - renderingIntentOffset - 4);
+    hash.addData(zeros.constData(), profileIdSize);
+    // QCryptographicHash::addData() takes an int as size. Profiles
+    // of more than 2 GiB are not supported by LittleCMS anyway.
+    const qint64 remainingSize = size - profileIdOffset - profileIdSize;
+    if (remainingSize > std::numeric_limits<int>::max()) {
+        return QByteArray();
+    }
+    hash.addData(data + profileIdOffset + profileIdSize, //
+                 static_cast<int>(remainingSize));
+    return hash.result();
+}
+
+/** @internal @brief Returns a cached color space.
+ *
+ * @param profileId The profile ID of the color space.
+ * @returns The color space with the given profile ID, if there is one
+ * alive. A shared pointer to <tt>nullptr</tt> otherwise. */
+QSharedPointer<RgbColorSpace> RgbColorSpaceFactory::cachedColorSpace(const QByteArray &profileId)
+{
+    QMutexLocker locker(&state().mutex);
+    return state().colorSpaces.value(profileId).toStrongRef();
+}
+
+/** @internal @brief Adds a color space to the cache.
+ *
+ * @param profileId The profile ID of the color space.
+ * @param colorSpace The color space.
+ * @returns If meanwhile another thread has added a color space with the
+ * same profile ID, that color space. Otherwise, <tt>colorSpace</tt>. */
+QSharedPointer<RgbColorSpace> RgbColorSpaceFactory::addToCache(const QByteArray &profileId, const QSharedPointer<RgbColorSpace> &colorSpace)
+{
+    QMutexLocker locker(&state().mutex);
+    const QSharedPointer<RgbColorSpace> existing = //
+        state().colorSpaces.value(profileId).toStrongRef();
+    if (!existing.isNull()) {
+        return existing;
+    }
+    removeExpiredEntries();
+    state().colorSpaces.insert(profileId, colorSpace);
+    return colorSpace;
+}
+
+/** @internal @brief Creates a color space object on a worker thread.
+ *
+ * @param createFunction The function that creates the color space
+ * object. It is called on a worker thread.
+ * @returns See @ref createFromFileAsync(). */
+QFuture<QSharedPointer<PerceptualColor::RgbColorSpace>> RgbColorSpaceFactory::createAsync(const std::function<QSharedPointer<PerceptualColor::RgbColorSpace>()> &createFunction)
+{
+    QFutureInterface<QSharedPointer<RgbColorSpace>> futureInterface;
+    futureInterface.reportStarted();
+    futureInterface.setProgressRange(0, 100);
+    futureInterface.setProgressValue(0);
+    const QFuture<QSharedPointer<RgbColorSpace>> result = futureInterface.future();
+    QThreadPool::globalInstance()->start( //
+        new CreationRunnable(futureInterface, createFunction));
+    return result;
+}
+
+/** @internal @brief Returns a shared color space object.
+ *
+ * @param profileId The profile ID of the color space.
+ * @param createFunction The function that creates a new color space
+ * object if there is none alive for the given profile ID.
+ * @returns The color space object. A shared pointer to <tt>nullptr</tt>
+ * if it had to be created, but the creation failed. */
+QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpaceFactory::createShared(const QByteArray &profileId, const std::function<QSharedPointer<PerceptualColor::RgbColorSpace>()> &createFunction)
+{
+    const QSharedPointer<RgbColorSpace> cached = cachedColorSpace(profileId);
+    if (!cached.isNull()) {
+        InstrumentationScope::count("RgbColorSpaceFactory cache hit");
+        return cached;
+    }
+    InstrumentationScope::count("RgbColorSpaceFactory cache miss");
+
+    const QSharedPointer<RgbColorSpace> newColorSpace = createFunction();
+    if (newColorSpace.isNull()) {
+        return nullptr;
+    }
+    // Before publishing the object to other threads:
+    moveToMainThread(newColorSpace);
+    return addToCache(profileId, newColorSpace);
+}
+
 /** @brief Create an sRGB color space object.
  *
  * This is a build-in profile that does not require any external ICC file.
@@ -45,19 +340,157 @@ QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpaceFactory::createSrgb(
     return RgbColorSpace::createSrgb();
 }
 
+/** @brief Create an sRGB color space object on a worker thread.
+ *
+ * @returns A future for the color space object. See
+ * @ref createFromFileAsync() for details. */
+QFuture<QSharedPointer<PerceptualColor::RgbColorSpace>> RgbColorSpaceFactory::createSrgbAsync()
+{
+    return createAsync(&RgbColorSpaceFactory::createSrgb);
+}
+
 /** @brief Create a color space object for a given ICC file.
  *
  * This function may fail to create the color space object when it cannot
  * open the given file, or when the file cannot be interpreted by LittleCMS.
  *
+ * Color space objects are shared: As long as a color space object for
+ * a given profile is alive, further requests for the same profile return
+ * the very same object instead of creating a new one. This is also the
+ * case when the profile is requested with another file name (for example
+ * a symbolic link, or simply a copy of the file). The profile is
+ * identified by its content, so when the file changes, the next request
+ * returns a new object that reflects the new content.
+ *
  * @param fileName The file name. TODO Must have a form that is compliant with
  * <tt>QFile</tt>.
  *
- * @returns A shared pointer to a newly created color space object on success.
+ * @returns A shared pointer to a color space object on success.
  * A shared pointer to <tt>nullptr</tt> otherwise. */
 QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpaceFactory::createFromFile(const QString &fileName)
 {
-    return RgbColorSpace::createFromFile(fileName);
+    const QFileInfo fileInfo(fileName);
+    const QString canonicalPath = fileInfo.canonicalFilePath();
+    if (canonicalPath.isEmpty()) {
+        // The file does not exist.
+        return nullptr;
+    }
+    const qint64 size = fileInfo.size();
+    const QDateTime lastModified = fileInfo.lastModified();
+
+    // If the file is unchanged since the last check, and its color space
+    // is still alive, the file does not have to be read at all.
+    {
+        QMutexLocker locker(&state().mutex);
+        const auto iterator = state().files.constFind(canonicalPath);
+        if (iterator != state().files.constEnd()) {
+            const bool isUnchanged = (iterator.value().size == size) //
+                && (iterator.value().lastModified == lastModified);
+            if (isUnchanged) {
+                const QSharedPointer<RgbColorSpace> colorSpace = //
+                    state().colorSpaces.value(iterator.value().profileId).toStrongRef();
+                if (!colorSpace.isNull()) {
+                    return colorSpace;
+                }
+            }
+        }
+    }
+
+    // Read the file only once. The profile ID and the color space object
+    // are both derived from this very content, so that they match even if
+    // the file is replaced meanwhile.
+    QFile file(canonicalPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    const QByteArray content = file.readAll();
+    file.close();
+    const QByteArray myProfileId = profileId(content.constData(), content.size());
+    if (myProfileId.isEmpty()) {
+        // This cannot be an ICC profile.
+        return nullptr;
+    }
+    {
+        QMutexLocker locker(&state().mutex);
+        ProfileFileEntry entry;
+        entry.size = size;
+        entry.lastModified = lastModified;
+        entry.profileId = myProfileId;
+        state().files.insert(canonicalPath, entry);
+    }
+
+    return createShared(myProfileId, [&content]() {
+        return RgbColorSpace::createFromMemory(content);
+    });
+}
+
+/** @brief Create a color space object for a given ICC file on a
+ * worker thread.
+ *
+ * Unlike @ref createFromFile(), this function returns immediately. The
+ * color space object is created on a worker thread of
+ * <tt>QThreadPool::globalInstance()</tt>. Also the data that a color
+ * space object otherwise calculates lazily on first use is calculated
+ * on the worker thread, so that the object is fast right from the start.
+ * The object is shared as described in @ref createFromFile().
+ *
+ * The returned future reports its progress within the range
+ * <tt>[0, 100]</tt>. Parsing the profile and creating the transforms
+ * cannot be interrupted; they cover the first part of the range. The
+ * precalculation of the derived data, which is slow for big LUT-based
+ * profiles, covers the rest in fine-grained steps.
+ *
+ * The creation can be cancelled with <tt>QFuture::cancel()</tt>. It
+ * stops then as soon as possible, and the future will not have a
+ * result. Therefore, check <tt>QFuture::isCanceled()</tt> before
+ * accessing <tt>QFuture::result()</tt>.
+ *
+ * @param fileName The file name. See @ref createFromFile().
+ *
+ * @returns A future for the color space object. Once finished (and if
+ * not cancelled), its result is a shared pointer to the color space
+ * object on success, and a shared pointer to <tt>nullptr</tt>
+ * otherwise. Use <tt>QFutureWatcher</tt> to get notified. The color
+ * space object lives in the thread of <tt>QCoreApplication</tt>. */
+QFuture<QSharedPointer<PerceptualColor::RgbColorSpace>> RgbColorSpaceFactory::createFromFileAsync(const QString &fileName)
+{
+    return createAsync([fileName]() {
+        return createFromFile(fileName);
+    });
+}
+
+/** @brief Create a color space object for given ICC data.
+ *
+ * This is useful for profiles that are embedded in images or that are
+ * received over IPC: There is no need to write them to a file first.
+ *
+ * This function may fail to create the color space object when the
+ * data cannot be interpreted by LittleCMS.
+ *
+ * Color space objects are shared like in @ref createFromFile(): As long
+ * as a color space object for a given profile is alive, further requests
+ * for the same profile return the very same object. This is also the
+ * case when the same profile is requested once from memory and once
+ * from a file.
+ *
+ * @param data The ICC data. It is read in place, without a copy. To
+ * pass a raw memory buffer without a copy, use
+ * <tt>QByteArray::fromRawData()</tt>; the buffer has to stay valid
+ * until this function returns.
+ *
+ * @returns A shared pointer to a color space object on success.
+ * A shared pointer to <tt>nullptr</tt> otherwise. */
+QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpaceFactory::createFromMemory(const QByteArray &data)
+{
+    const QByteArray myProfileId = profileId(data.constData(), data.size());
+    if (myProfileId.isEmpty()) {
+        // This cannot be an ICC profile.
+        return nullptr;
+    }
+
+    return createShared(myProfileId, [&data]() {
+        return RgbColorSpace::createFromMemory(data);
+    });
 }
 
 } // namespace PerceptualColor
@@ -0,0 +1,147 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "scanlinewriter.h"
+
+#include "helper.h"
+
+#include <QRgba64>
+
+namespace PerceptualColor
+{
+/** @brief Rounds a floating point channel value to 16 bit.
+ *
+ * This is the same rounding that <tt>QColor::fromRgbF()</tt> does.
+ *
+ * @param value The channel value. Valid range: <tt>[0, 1]</tt>.
+ * Out-of-range values are bound to the valid range.
+ * @returns The corresponding 16-bit value. */
+quint16 ScanlineWriter::toUint16(const double value)
+{
+    return static_cast<quint16>(qBound(0, qRound(value * 65535), 65535));
+}
+
+/** @brief Converts a color to the format of the image scanlines.
+ *
+ * @param rgb The color. Valid range for each channel: <tt>[0, 1]</tt>.
+ * @returns The fully opaque pixel value, as it is used within images of
+ * the format <tt>QImage::Format_ARGB32_Premultiplied</tt>. */
+QRgb ScanlineWriter::opaqueArgb32(const RgbDouble &rgb)
+{
+    return QRgba64::fromRgba64( //
+               toUint16(rgb.red),
+               toUint16(rgb.green),
+               toUint16(rgb.blue),
+               65535)
+        .toArgb32();
+}
+
+/** @brief Converts a color to the format of the image scanlines.
+ *
+ * @param rgb The color. Valid range for each channel: <tt>[0, 1]</tt>.
+ * @param alpha The alpha value. Valid range: <tt>[0, 1]</tt>.
+ * @returns The premultiplied pixel value, as it is used within images of
+ * the format <tt>QImage::Format_ARGB32_Premultiplied</tt>. */
+QRgb ScanlineWriter::premultipliedArgb32(const RgbDouble &rgb, const qreal alpha)
+{
+    return QRgba64::fromRgba64( //
+               toUint16(rgb.red),
+               toUint16(rgb.green),
+               toUint16(rgb.blue),
+               toUint16(alpha))
+        .premultiplied()
+        .toArgb32();
+}
+
+/** @brief Provides access to a scanline.
+ *
+ * @param image The image. Must have the format
+ * <tt>QImage::Format_ARGB32_Premultiplied</tt>.
+ * @param y The row. Must be a valid row within the image.
+ * @returns A pointer to the first pixel of the scanline. The
+ * image is detached if necessary. */
+QRgb *ScanlineWriter::scanline(QImage *image, const int y)
+{
+    Q_ASSERT(image->format() == QImage::Format_ARGB32_Premultiplied);
+    Q_ASSERT(isInRange(0, y, image->height() - 1));
+    return reinterpret_cast<QRgb *>(image->scanLine(y));
+}
+
+/** @brief Writes opaque pixels to a scanline.
+ *
+ * @param scanline Pointer to the first pixel that will be written.
+ * @param rgbBuffer Pointer to the first of <tt>count</tt> colors.
+ * @param maskBuffer Pointer to the first of <tt>count</tt> mask values.
+ * Only pixels with a mask value of <tt>true</tt> are written; all other
+ * pixels are left untouched.
+ * @param count The number of pixels. */
+void ScanlineWriter::writeMasked(QRgb *scanline, const RgbDouble *rgbBuffer, const bool *maskBuffer, const int count)
+{
+    for (int x = 0; x < count; ++x) {
+        if (maskBuffer[x]) {
+            scanline[x] = opaqueArgb32(rgbBuffer[x]);
+        }
+    }
+}
+
+/** @brief Writes opaque pixels to arbitrary positions of a scanline.
+ *
+ * @param scanline Pointer to the first pixel of the scanline.
+ * @param xBuffer Pointer to the first of <tt>count</tt> pixel positions
+ * within the scanline.
+ * @param rgbBuffer Pointer to the first of <tt>count</tt> colors.
+ * @param maskBuffer Pointer to the first of <tt>count</tt> mask values.
+ * Only pixels with a mask value of <tt>true</tt> are written; all other
+ * pixels are left untouched.
+ * @param count The number of pixels. */
+void ScanlineWriter::writeMasked(QRgb *scanline, const int *xBuffer, const RgbDouble *rgbBuffer, const bool *maskBuffer, const int count)
+{
+    for (int i = 0; i < count; ++i) {
+        if (maskBuffer[i]) {
+            scanline[xBuffer[i]] = opaqueArgb32(rgbBuffer[i]);
+        }
+    }
+}
+
+/** @brief Writes pixels with alpha channel to a scanline.
+ *
+ * @param scanline Pointer to the first pixel that will be written.
+ * @param rgbBuffer Pointer to the first of <tt>count</tt> colors.
+ * @param alphaBuffer Pointer to the first of <tt>count</tt> alpha values.
+ * @param count The number of pixels. */
+void ScanlineWriter::writePremultiplied(QRgb *scanline, const RgbDouble *rgbBuffer, const qreal *alphaBuffer, const int count)
+{
+    for (int x = 0; x < count; ++x) {
+        scanline[x] = premultipliedArgb32(rgbBuffer[x], alphaBuffer[x]);
+    }
+}
+
+} // namespace PerceptualColor
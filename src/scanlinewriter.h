@@ -0,0 +1,84 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SCANLINEWRITER_H
+#define SCANLINEWRITER_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QImage>
+#include <QRgb>
+
+#include "rgbdouble.h"
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief Writes the output of the color conversion directly
+ * into <tt>QImage</tt> scanlines.
+ *
+ * Writing pixel by pixel with <tt>QImage::setPixelColor()</tt> creates
+ * a <tt>QColor</tt> for every pixel and does format conversion and
+ * bounds checking for every single call. This class writes instead
+ * directly into the scanlines of images in the format
+ * <tt>QImage::Format_ARGB32_Premultiplied</tt>, which is the format
+ * that all images of this library use.
+ *
+ * The values that are written are <em>bit-identical</em> to what
+ * <tt>QImage::setPixelColor()</tt> would write for a color created with
+ * <tt>QColor::fromRgbF()</tt>: The floating point values are rounded
+ * to 16 bit (like <tt>QColor</tt> does), premultiplied with 16 bit
+ * precision and then rounded to 8 bit (like <tt>QImage</tt> does).
+ *
+ * Example:
+ * @snippet test/testscanlinewriter.cpp ScanlineWriter usage
+ *
+ * @note The functions that take a scanline pointer do not touch the
+ * <tt>QImage</tt> object itself. Therefore, different threads can
+ * write at the same time to different scanlines of the same image, as
+ * long as the image has been detached before (see @ref scanline()). */
+class ScanlineWriter
+{
+public:
+    static QRgb opaqueArgb32(const RgbDouble &rgb);
+    static QRgb premultipliedArgb32(const RgbDouble &rgb, const qreal alpha);
+    static QRgb *scanline(QImage *image, const int y);
+    static void writeMasked(QRgb *scanline, const RgbDouble *rgbBuffer, const bool *maskBuffer, const int count);
+    static void writeMasked(QRgb *scanline, const int *xBuffer, const RgbDouble *rgbBuffer, const bool *maskBuffer, const int count);
+    static void writePremultiplied(QRgb *scanline, const RgbDouble *rgbBuffer, const qreal *alphaBuffer, const int count);
+
+private:
+    ScanlineWriter() = delete;
+    Q_DISABLE_COPY(ScanlineWriter)
+
+    static quint16 toUint16(const double value);
+};
+
+} // namespace PerceptualColor
+
+#endif // SCANLINEWRITER_H
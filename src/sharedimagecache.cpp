@@ -0,0 +1,197 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "PerceptualColor/sharedimagecache.h"
+
+#include "instrumentationscope.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <limits>
+
+namespace PerceptualColor
+{
+namespace
+{
+/** @internal @brief Default value for @ref SharedImageCache::maximumSize(). */
+constexpr qint64 defaultMaximumSize = 32 * 1024 * 1024;
+
+/** @internal @brief The unit of the cost within <tt>QCache</tt>,
+ * measured in bytes.
+ *
+ * <tt>QCache</tt> uses <tt>int</tt> for the cost, which is not enough
+ * for byte counts. Therefore, the cost is measured in KiB. */
+constexpr qint64 costUnit = 1024;
+
+/** @internal @brief Global state of @ref SharedImageCache. */
+struct SharedImageCacheState {
+    /** @brief Protects all other members. */
+    QMutex mutex;
+    /** @brief The images.
+     *
+     * <tt>QCache</tt> evicts the least recently used images
+     * when the total cost exceeds the maximum cost. */
+    QCache<QByteArray, QImage> cache {static_cast<int>(defaultMaximumSize / costUnit)};
+    /** @brief Store for @ref SharedImageCache::hits() */
+    quint64 hits = 0;
+    /** @brief Store for @ref SharedImageCache::misses() */
+    quint64 misses = 0;
+};
+
+/** @internal @brief The global state of @ref SharedImageCache.
+ *
+ * @returns The global state. */
+SharedImageCacheState &state()
+{
+    static SharedImageCacheState globalState;
+    return globalState;
+}
+
+} // namespace
+
+/** @brief Removes all images from the cache.
+ *
+ * Images that are still used by widgets stay alive. The statistics
+ * (@ref hits(), @ref misses()) are reset. */
+void SharedImageCache::clear()
+{
+    QMutexLocker locker(&state().mutex);
+    state().cache.clear();
+    state().hits = 0;
+    state().misses = 0;
+}
+
+/** @brief Number of successful lookups.
+ *
+ * @returns The number of lookups that found an image in the cache.
+ *
+ * @sa @ref misses() */
+quint64 SharedImageCache::hits()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().hits;
+}
+
+/** @brief Maximum memory usage of the cache.
+ *
+ * @returns The maximum memory usage of the cache, measured in bytes.
+ * Default value: 32 MiB. <tt>0</tt> means that the cache is disabled.
+ *
+ * @sa @ref setMaximumSize() */
+qint64 SharedImageCache::maximumSize()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().cache.maxCost() * costUnit;
+}
+
+/** @brief Number of unsuccessful lookups.
+ *
+ * @returns The number of lookups that did not find an image in the
+ * cache, so that the image had to be rendered (or loaded from the
+ * @ref ImageDiskCache).
+ *
+ * @sa @ref hits() */
+quint64 SharedImageCache::misses()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().misses;
+}
+
+/** @brief Setter for @ref maximumSize().
+ *
+ * If the cache is yet bigger than the new maximum size, the least
+ * recently used images are removed immediately.
+ *
+ * @param newMaximumSize The new maximum size, measured in bytes.
+ * Negative values are treated as <tt>0</tt>. The value is rounded
+ * down to full KiB. */
+void SharedImageCache::setMaximumSize(const qint64 newMaximumSize)
+{
+    QMutexLocker locker(&state().mutex);
+    const qint64 cost = qBound<qint64>(0, newMaximumSize / costUnit, std::numeric_limits<int>::max());
+    state().cache.setMaxCost(static_cast<int>(cost));
+}
+
+/** @brief Current memory usage of the cache.
+ *
+ * @returns The current memory usage of the cache, measured in bytes
+ * (rounded up to full KiB per image). */
+qint64 SharedImageCache::size()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().cache.totalCost() * costUnit;
+}
+
+/** @brief Looks up an image.
+ *
+ * @param key The cache key. It must contain everything that influences
+ * the image content: The profile, the image type and all image
+ * parameters.
+ * @returns The image if it is available in the cache. A null
+ * image otherwise. */
+QImage SharedImageCache::find(const QByteArray &key)
+{
+    QMutexLocker locker(&state().mutex);
+    // QCache::object() marks the image as most recently used.
+    const QImage *const image = state().cache.object(key);
+    if (image == nullptr) {
+        ++state().misses;
+        InstrumentationScope::count("SharedImageCache miss");
+        return QImage();
+    }
+    ++state().hits;
+    InstrumentationScope::count("SharedImageCache hit");
+    return *image;
+}
+
+/** @brief Inserts an image into the cache.
+ *
+ * @param key The cache key. It must contain everything that influences
+ * the image content: The profile, the image type and all image
+ * parameters.
+ * @param image The image. Null images are ignored. Images that are
+ * bigger than @ref maximumSize() are not cached. */
+void SharedImageCache::insert(const QByteArray &key, const QImage &image)
+{
+    if (image.isNull()) {
+        return;
+    }
+    const qint64 cost = qMax<qint64>(1, (static_cast<qint64>(image.bytesPerLine()) * image.height() + costUnit - 1) / costUnit);
+    QMutexLocker locker(&state().mutex);
+    if (cost > state().cache.maxCost()) {
+        return;
+    }
+    state().cache.insert(key, new QImage(image), static_cast<int>(cost));
+}
+
+} // namespace PerceptualColor
@@ -86,6 +86,23 @@ WheelColorPicker::WheelColorPicker(const QSharedPointer<PerceptualColor::RgbColo
             // As value is stored anyway within ChromaLightnessDiagram member,
             // it’s enough to just emit the corresponding signal of this class:
             &WheelColorPicker::currentColorChanged);
+    connect(d_pointer->m_chromaLightnessDiagram,
+            &ChromaLightnessDiagram::currentColorChanged,
+            this,
+            [this](const LchDouble &newCurrentColor) {
+                LchaDouble throttleColor;
+                throttleColor.l = newCurrentColor.l;
+                throttleColor.c = newCurrentColor.c;
+                throttleColor.h = newCurrentColor.h;
+                throttleColor.a = 1;
+                d_pointer->m_colorChangeThrottle.registerChange(throttleColor);
+            });
+    connect(&d_pointer->m_colorChangeThrottle, &ColorChangeThrottle::throttledChange, this, [this]() {
+        Q_EMIT currentColorChangedThrottled(currentColor());
+    });
+    connect(&d_pointer->m_colorChangeThrottle, &ColorChangeThrottle::finished, this, [this]() {
+        Q_EMIT currentColorChangeFinished(currentColor());
+    });
     connect(
         // QWidget’s constructor requires a QApplication object. As this
         // is a class derived from QWidget, calling qApp is save here.
@@ -351,6 +368,46 @@ void WheelColorPicker::setCurrentColor(const LchDouble &newCurrentColor)
     d_pointer->m_colorWheel->setHue(d_pointer->m_chromaLightnessDiagram->currentColor().h);
 }
 
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal WheelColorPicker::throttledNotificationDeltaE() const
+{
+    return d_pointer->m_colorChangeThrottle.minimumDeltaE();
+}
+
+/** @brief Setter for the @ref throttledNotificationDeltaE property.
+ *
+ * @param newThrottledNotificationDeltaE the new value */
+void WheelColorPicker::setThrottledNotificationDeltaE(const qreal newThrottledNotificationDeltaE)
+{
+    const qreal oldValue = d_pointer->m_colorChangeThrottle.minimumDeltaE();
+    d_pointer->m_colorChangeThrottle.setMinimumDeltaE(newThrottledNotificationDeltaE);
+    if (d_pointer->m_colorChangeThrottle.minimumDeltaE() != oldValue) {
+        Q_EMIT throttledNotificationDeltaEChanged( //
+            d_pointer->m_colorChangeThrottle.minimumDeltaE());
+    }
+}
+
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal WheelColorPicker::throttledNotificationRate() const
+{
+    return d_pointer->m_colorChangeThrottle.maximumRate();
+}
+
+/** @brief Setter for the @ref throttledNotificationRate property.
+ *
+ * @param newThrottledNotificationRate the new value */
+void WheelColorPicker::setThrottledNotificationRate(const qreal newThrottledNotificationRate)
+{
+    const qreal oldValue = d_pointer->m_colorChangeThrottle.maximumRate();
+    d_pointer->m_colorChangeThrottle.setMaximumRate(newThrottledNotificationRate);
+    if (d_pointer->m_colorChangeThrottle.maximumRate() != oldValue) {
+        Q_EMIT throttledNotificationRateChanged( //
+            d_pointer->m_colorChangeThrottle.maximumRate());
+    }
+}
+
 /** @brief Recommended size for the widget
  *
  * Reimplemented from base class.
@@ -39,6 +39,7 @@
 
 #include "PerceptualColor/colorwheel.h"
 #include "chromalightnessdiagram.h"
+#include "colorchangethrottle.h"
 #include "lchvalues.h"
 
 namespace PerceptualColor
@@ -64,6 +65,11 @@ public:
     // Data members
     /** @brief A pointer to the @ref ChromaLightnessDiagram child widget. */
     QPointer<ChromaLightnessDiagram> m_chromaLightnessDiagram;
+    /** @brief Throttles the notifications about color changes.
+     *
+     * @sa @ref throttledNotificationRate
+     * @sa @ref throttledNotificationDeltaE */
+    ColorChangeThrottle m_colorChangeThrottle;
     /** @brief A pointer to the color space. */
     QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace;
     /** @brief A pointer to the @ref ColorWheel child widget. */
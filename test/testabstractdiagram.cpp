@@ -189,6 +189,88 @@ private Q_SLOTS:
         QCOMPARE(temp.handleColorFromBackgroundLightness(100), QColor(Qt::black));
         QCOMPARE(temp.handleColorFromBackgroundLightness(101), QColor(Qt::black));
     }
+
+    void testCircularHandleBoundingRect()
+    {
+        AbstractDiagram temp;
+        const QPointF center(50.5, 40.25);
+        const QRect rect = temp.circularHandleBoundingRect(center);
+        const qreal outerRadius = temp.handleRadius() + temp.handleOutlineThickness() / 2.0;
+        QVERIFY(rect.contains(QPointF(center.x() - outerRadius, center.y()).toPoint()));
+        QVERIFY(rect.contains(QPointF(center.x() + outerRadius, center.y()).toPoint()));
+        QVERIFY(rect.contains(QPointF(center.x(), center.y() - outerRadius).toPoint()));
+        QVERIFY(rect.contains(QPointF(center.x(), center.y() + outerRadius).toPoint()));
+        // Not much bigger than the handle itself
+        QVERIFY(rect.width() <= 2 * outerRadius + 4);
+    }
+
+    void testLineBoundingRect()
+    {
+        AbstractDiagram temp;
+        const QRect rect = temp.lineBoundingRect(QPointF(30, 10), QPointF(10, 20), 2);
+        QVERIFY(rect.contains(QPoint(9, 9)));
+        QVERIFY(rect.contains(QPoint(31, 21)));
+        QVERIFY(rect.width() <= 26);
+        QVERIFY(rect.height() <= 16);
+    }
+
+    void testCoalesceInput()
+    {
+        AbstractDiagram temp;
+        QVector<int> processed;
+        // The first input is processed immediately…
+        temp.coalesceInput([&processed]() {
+            processed.append(1);
+        });
+        QCOMPARE(processed, QVector<int>({1}));
+        // …further input within the same frame is delayed,
+        // and only the most recent one is processed.
+        temp.coalesceInput([&processed]() {
+            processed.append(2);
+        });
+        temp.coalesceInput([&processed]() {
+            processed.append(3);
+        });
+        QCOMPARE(processed, QVector<int>({1}));
+        QTRY_COMPARE(processed, QVector<int>({1, 3}));
+    }
+
+    void testDiscardPendingInput()
+    {
+        AbstractDiagram temp;
+        QVector<int> processed;
+        temp.coalesceInput([&processed]() {
+            processed.append(1);
+        });
+        temp.coalesceInput([&processed]() {
+            processed.append(2);
+        });
+        temp.discardPendingInput();
+        QTest::qWait(100);
+        QCOMPARE(processed, QVector<int>({1}));
+    }
+
+    void testInteraction()
+    {
+        AbstractDiagram temp;
+        QVERIFY(!temp.isInteractionInProgress());
+        temp.registerInteraction();
+        QVERIFY(temp.isInteractionInProgress());
+        // The interaction pauses after a short time:
+        QTRY_VERIFY(!temp.isInteractionInProgress());
+    }
+
+    void testImageParameterChange()
+    {
+        AbstractDiagram temp;
+        // A single change is not an interaction…
+        temp.registerImageParameterChange();
+        QVERIFY(!temp.isInteractionInProgress());
+        // …but quickly following changes are.
+        temp.registerImageParameterChange();
+        QVERIFY(temp.isInteractionInProgress());
+        QTRY_VERIFY(!temp.isInteractionInProgress());
+    }
 };
 
 } // namespace PerceptualColor
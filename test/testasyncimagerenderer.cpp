@@ -0,0 +1,229 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "asyncimagerenderer.h"
+
+#include <QtTest>
+
+#include <QAtomicInt>
+#include <QColor>
+#include <QThread>
+#include <QThreadPool>
+
+namespace PerceptualColor
+{
+/** @brief Returns a render function that renders a single-color image.
+ *
+ * @param color The color of the image
+ * @param delayMilliseconds Time to wait (in small steps, checking the
+ * cancellation flag) before the image is rendered.
+ * @param callCount Incremented each time the render function starts.
+ * @returns The render function */
+static AsyncImageRenderer::RenderFunction filledImage(const QColor color, const int delayMilliseconds, QAtomicInt *callCount)
+{
+    return [color, delayMilliseconds, callCount](const QAtomicInt &isCancelled) {
+        callCount->fetchAndAddOrdered(1);
+        for (int i = 0; i < delayMilliseconds; ++i) {
+            if (isCancelled.loadAcquire() != 0) {
+                return QImage();
+            }
+            QThread::msleep(1);
+        }
+        QImage result(4, 4, QImage::Format_ARGB32_Premultiplied);
+        result.fill(color);
+        return result;
+    };
+}
+
+static void snippet01()
+{
+    //! [AsyncImageRenderer usage]
+    AsyncImageRenderer myRenderer;
+    // The render function gets only copies of the parameters,
+    // because it is called on a worker thread.
+    const QColor color = Qt::red;
+    auto renderFunction = [color](const QAtomicInt &isCancelled) {
+        Q_UNUSED(isCancelled)
+        QImage result(4, 4, QImage::Format_ARGB32_Premultiplied);
+        result.fill(color);
+        return result;
+    };
+    // The key must contain all parameters that influence the image.
+    const QByteArray key = color.name().toUtf8();
+    // The first request is rendered synchronously. Later requests
+    // return immediately the most recent ready image; the widget
+    // repaints again when imageReady() is emitted.
+    QImage myImage = myRenderer.request(key, renderFunction);
+    //! [AsyncImageRenderer usage]
+    Q_UNUSED(myImage)
+}
+
+class TestAsyncImageRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestAsyncImageRenderer(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    /** @brief Counts the calls of render functions. */
+    QAtomicInt m_callCount {0};
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+        m_callCount.storeRelease(0);
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+        // Worker threads might still access m_callCount.
+        QThreadPool::globalInstance()->waitForDone();
+    }
+
+    void testSnippet01()
+    {
+        snippet01();
+    }
+
+    void testInitialState()
+    {
+        AsyncImageRenderer myRenderer;
+        QVERIFY(myRenderer.image().isNull());
+        QVERIFY(!myRenderer.isReady());
+    }
+
+    void testFirstRequestIsSynchronous()
+    {
+        AsyncImageRenderer myRenderer;
+        const QImage result = myRenderer.request( //
+            QByteArrayLiteral("red"),
+            filledImage(Qt::red, 0, &m_callCount));
+        QVERIFY(!result.isNull());
+        QCOMPARE(result.pixelColor(0, 0), QColor(Qt::red));
+        QVERIFY(myRenderer.isReady());
+        QCOMPARE(m_callCount.loadAcquire(), 1);
+    }
+
+    void testSameKeyIsNotRenderedAgain()
+    {
+        AsyncImageRenderer myRenderer;
+        myRenderer.request(QByteArrayLiteral("red"), filledImage(Qt::red, 0, &m_callCount));
+        myRenderer.request(QByteArrayLiteral("red"), filledImage(Qt::red, 0, &m_callCount));
+        QVERIFY(myRenderer.isReady());
+        QCOMPARE(m_callCount.loadAcquire(), 1);
+    }
+
+    void testLaterRequestIsAsynchronous()
+    {
+        AsyncImageRenderer myRenderer;
+        myRenderer.request(QByteArrayLiteral("red"), filledImage(Qt::red, 0, &m_callCount));
+        QSignalSpy spy(&myRenderer, &AsyncImageRenderer::imageReady);
+        const QImage staleImage = myRenderer.request( //
+            QByteArrayLiteral("blue"),
+            filledImage(Qt::blue, 20, &m_callCount));
+        // Meanwhile, the stale image is provided.
+        QCOMPARE(staleImage.pixelColor(0, 0), QColor(Qt::red));
+        QTRY_VERIFY(myRenderer.isReady());
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(myRenderer.image().pixelColor(0, 0), QColor(Qt::blue));
+    }
+
+    void testStaleRenderIsCancelled()
+    {
+        AsyncImageRenderer myRenderer;
+        myRenderer.request(QByteArrayLiteral("red"), filledImage(Qt::red, 0, &m_callCount));
+        QSignalSpy spy(&myRenderer, &AsyncImageRenderer::imageReady);
+        // A slow render that becomes stale…
+        myRenderer.request(QByteArrayLiteral("blue"), filledImage(Qt::blue, 5000, &m_callCount));
+        // …and a new render.
+        myRenderer.request(QByteArrayLiteral("green"), filledImage(Qt::green, 0, &m_callCount));
+        // The stale render is cancelled, so the new render does not
+        // have to wait 5 seconds.
+        QTRY_VERIFY_WITH_TIMEOUT(myRenderer.isReady(), 4000);
+        QCOMPARE(myRenderer.image().pixelColor(0, 0), QColor(Qt::green));
+        // The stale result never gets delivered.
+        QTest::qWait(50);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(myRenderer.image().pixelColor(0, 0), QColor(Qt::green));
+    }
+
+    void testBackToReadyImage()
+    {
+        AsyncImageRenderer myRenderer;
+        myRenderer.request(QByteArrayLiteral("red"), filledImage(Qt::red, 0, &m_callCount));
+        myRenderer.request(QByteArrayLiteral("blue"), filledImage(Qt::blue, 5000, &m_callCount));
+        QVERIFY(!myRenderer.isReady());
+        // Requesting again the parameters of the ready image cancels
+        // the render in progress.
+        const QImage result = myRenderer.request( //
+            QByteArrayLiteral("red"),
+            filledImage(Qt::red, 0, &m_callCount));
+        QVERIFY(myRenderer.isReady());
+        QCOMPARE(result.pixelColor(0, 0), QColor(Qt::red));
+    }
+
+    void testDestroyWhileRendering()
+    {
+        {
+            AsyncImageRenderer myRenderer;
+            myRenderer.request(QByteArrayLiteral("red"), filledImage(Qt::red, 0, &m_callCount));
+            myRenderer.request(QByteArrayLiteral("blue"), filledImage(Qt::blue, 50, &m_callCount));
+            // Wait until the worker thread has started.
+            QTRY_COMPARE(m_callCount.loadAcquire(), 2);
+        }
+        // The renderer is gone; the worker must neither crash nor block.
+        QVERIFY(QThreadPool::globalInstance()->waitForDone(5000));
+        QTest::qWait(10);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestAsyncImageRenderer)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testasyncimagerenderer.moc"
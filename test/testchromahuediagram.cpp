@@ -105,6 +105,60 @@ private Q_SLOTS:
         myDiagram.show();
     }
 
+    void testStaticLayer()
+    {
+        PerceptualColor::ChromaHueDiagram myDiagram(m_rgbColorSpace);
+        myDiagram.resize(300, 300);
+        myDiagram.show();
+        myDiagram.setCurrentColor(LchDouble {50, 20, 10});
+        myDiagram.repaint();
+        const qint64 layerKey = myDiagram.d_pointer->m_staticLayer.cacheKey();
+        QVERIFY(!myDiagram.d_pointer->m_staticLayer.isNull());
+        // Moving the handle within the same lightness reuses the layer.
+        myDiagram.setCurrentColor(LchDouble {50, 30, 200});
+        myDiagram.repaint();
+        QCOMPARE(myDiagram.d_pointer->m_staticLayer.cacheKey(), layerKey);
+        // A new lightness needs a new layer.
+        myDiagram.setCurrentColor(LchDouble {60, 30, 200});
+        myDiagram.repaint();
+        // The new image is rendered asynchronously.
+        QTRY_VERIFY(myDiagram.d_pointer->m_chromaHueRenderer.isReady());
+        myDiagram.repaint();
+        QVERIFY(myDiagram.d_pointer->m_staticLayer.cacheKey() != layerKey);
+    }
+
+    void testThrottledNotifications()
+    {
+        // Needed to read the signal arguments from QSignalSpy:
+        qRegisterMetaType<LchDouble>();
+        PerceptualColor::ChromaHueDiagram myDiagram(m_rgbColorSpace);
+        QSignalSpy spyThrottled(&myDiagram, &ChromaHueDiagram::currentColorChangedThrottled);
+        QSignalSpy spyFinished(&myDiagram, &ChromaHueDiagram::currentColorChangeFinished);
+        QCOMPARE(myDiagram.throttledNotificationRate(), 0.0);
+        myDiagram.setThrottledNotificationRate(10);
+        QCOMPARE(myDiagram.throttledNotificationRate(), 10.0);
+        myDiagram.setCurrentColor(LchDouble {50, 20, 10});
+        myDiagram.setCurrentColor(LchDouble {50, 25, 10});
+        QCOMPARE(spyThrottled.count(), 1);
+        QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 2000);
+        QVERIFY(isEqual(spyFinished.at(0).at(0).value<LchDouble>(), LchDouble {50, 25, 10}));
+    }
+
+    void testThrottledNotificationsMouseRelease()
+    {
+        PerceptualColor::ChromaHueDiagram myDiagram(m_rgbColorSpace);
+        myDiagram.resize(300, 300);
+        myDiagram.show();
+        myDiagram.setThrottledNotificationRate(10);
+        QSignalSpy spyFinished(&myDiagram, &ChromaHueDiagram::currentColorChangeFinished);
+        const QPoint center = myDiagram.d_pointer->diagramCenter().toPoint();
+        QTest::mousePress(&myDiagram, Qt::LeftButton, Qt::NoModifier, center);
+        QCOMPARE(spyFinished.count(), 0);
+        // The release finishes the interaction without delay.
+        QTest::mouseRelease(&myDiagram, Qt::LeftButton, Qt::NoModifier, center);
+        QCOMPARE(spyFinished.count(), 1);
+    }
+
     void testKeyPressEvent()
     {
         PerceptualColor::ChromaHueDiagram myDiagram(m_rgbColorSpace);
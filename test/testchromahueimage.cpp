@@ -31,9 +31,12 @@
 // this forces the header to be self-contained.
 #include "chromahueimage.h"
 
+#include <QPainter>
+#include <QtMath>
 #include <QtTest>
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "PerceptualColor/sharedimagecache.h"
 #include "helper.h"
 #include "lchvalues.h"
 
@@ -80,6 +83,43 @@ public:
 private:
     QSharedPointer<RgbColorSpace> colorSpace = RgbColorSpaceFactory::createSrgb();
 
+    /** @brief Renders the image pixel by pixel with
+     * <tt>QImage::setPixelColor()</tt>.
+     *
+     * This is a straight-forward reference implementation against
+     * which the optimized rendering of the image class is tested. */
+    QImage referenceImage(const int size, const qreal border, const qreal lightness, const qreal chromaRange) const
+    {
+        QImage result(QSize(size, size), QImage::Format_ARGB32_Premultiplied);
+        const qreal circleRadius = (size - 2 * border) / 2.;
+        result.fill(colorSpace->toQColorRgbBound(LchValues::neutralGray()));
+        cmsCIELab lab;
+        lab.L = lightness;
+        QColor tempColor;
+        const qreal scaleFactor = static_cast<qreal>(2 * chromaRange) / (size - 2 * border);
+        for (int y = 0; y < size; ++y) {
+            lab.b = chromaRange - (y + 0.5 - border) * scaleFactor;
+            for (int x = 0; x < size; ++x) {
+                lab.a = (x + 0.5 - border) * scaleFactor - chromaRange;
+                if ((qPow(lab.a, 2) + qPow(lab.b, 2)) <= (qPow(chromaRange + overlap, 2))) {
+                    tempColor = colorSpace->toQColorRgbUnbound(lab);
+                    if (tempColor.isValid()) {
+                        result.setPixelColor(x, y, tempColor);
+                    }
+                }
+            }
+        }
+        const qreal cutOffThickness = qSqrt(qPow(size, 2) * 2) / 2 - circleRadius + overlap;
+        QPainter myPainter(&result);
+        myPainter.setRenderHint(QPainter::Antialiasing, true);
+        myPainter.setPen(QPen(Qt::SolidPattern, cutOffThickness));
+        myPainter.setCompositionMode(QPainter::CompositionMode_Clear);
+        myPainter.drawEllipse(QPointF(static_cast<qreal>(size) / 2, static_cast<qreal>(size) / 2),
+                              circleRadius + cutOffThickness / 2,
+                              circleRadius + cutOffThickness / 2);
+        return result;
+    }
+
 private Q_SLOTS:
     void initTestCase()
     {
@@ -94,6 +134,8 @@ private Q_SLOTS:
     void init()
     {
         // Called before each test function is executed
+        // Make sure that the images are really rendered.
+        SharedImageCache::clear();
     }
 
     void cleanup()
@@ -112,6 +154,133 @@ private Q_SLOTS:
         Q_UNUSED(test.getImage());
     }
 
+    void testBitIdenticalToReference_data()
+    {
+        QTest::addColumn<int>("size");
+        QTest::addColumn<qreal>("border");
+        QTest::addColumn<qreal>("lightness");
+        QTest::addColumn<qreal>("chromaRange");
+        QTest::newRow("51 0 50 0") << 51 << 0. << 50. << 0.;
+        QTest::newRow("51 0 50 100") << 51 << 0. << 50. << 100.;
+        QTest::newRow("100 5.5 30 130") << 100 << 5.5 << 30. << 130.;
+        QTest::newRow("99 10 85 60") << 99 << 10. << 85. << 60.;
+    }
+
+    void testBitIdenticalToReference()
+    {
+        QFETCH(int, size);
+        QFETCH(qreal, border);
+        QFETCH(qreal, lightness);
+        QFETCH(qreal, chromaRange);
+        ChromaHueImage myImage(colorSpace);
+        myImage.setImageSize(size);
+        myImage.setBorder(border);
+        myImage.setLightness(lightness);
+        myImage.setChromaRange(chromaRange);
+        QCOMPARE(myImage.getImage(), referenceImage(size, border, lightness, chromaRange));
+    }
+
+    void testThreadCount()
+    {
+        ChromaHueImage myImage(colorSpace);
+        myImage.setImageSize(151);
+        myImage.setBorder(5);
+        myImage.setChromaRange(130);
+        myImage.setLightness(60);
+        const QImage sequentialImage = myImage.getImage();
+        myImage.setThreadCount(QThread::idealThreadCount() + 3);
+        // Changing the thread count does not invalidate the cache:
+        QVERIFY(!myImage.m_image.isNull());
+        // Render again:
+        myImage.m_image = QImage();
+        SharedImageCache::clear();
+        // The result must be deterministic:
+        QCOMPARE(myImage.getImage(), sequentialImage);
+        // Invalid values are bound to 1:
+        myImage.setThreadCount(-5);
+        QCOMPARE(myImage.m_threadCount, 1);
+    }
+
+    void testResolutionDivisor()
+    {
+        ChromaHueImage myImage(colorSpace);
+        myImage.setImageSize(151);
+        myImage.setBorder(5);
+        myImage.setChromaRange(130);
+        myImage.setDevicePixelRatioF(1.25);
+        const QByteArray fullResolutionKey = myImage.cacheKey();
+        myImage.setResolutionDivisor(2);
+        QVERIFY(myImage.cacheKey() != fullResolutionKey);
+        const QImage coarseImage = myImage.getImage();
+        // The coarse image has nevertheless the full size:
+        QCOMPARE(coarseImage.size(), QSize(151, 151));
+        QCOMPARE(coarseImage.devicePixelRatioF(), 1.25);
+        // The center is within the gamut for all resolutions:
+        QVERIFY(coarseImage.pixelColor(75, 75).alpha() > 0);
+        // Invalid values are bound to 1:
+        myImage.setResolutionDivisor(-1);
+        QCOMPARE(myImage.m_resolutionDivisor, 1);
+        QCOMPARE(myImage.cacheKey(), fullResolutionKey);
+    }
+
+    void testResolutionDivisorBypassesCaches()
+    {
+        SharedImageCache::clear();
+        ChromaHueImage myImage(colorSpace);
+        myImage.setImageSize(151);
+        myImage.setChromaRange(130);
+        myImage.setResolutionDivisor(2);
+        QVERIFY(!myImage.getImage().isNull());
+        // Coarse images must not displace full-resolution images:
+        QCOMPARE(SharedImageCache::size(), Q_INT64_C(0));
+        myImage.setResolutionDivisor(1);
+        myImage.getImage();
+        QVERIFY(SharedImageCache::size() > 0);
+    }
+
+    void testCancellationFlag()
+    {
+        ChromaHueImage myImage(colorSpace);
+        myImage.setImageSize(151);
+        myImage.setChromaRange(130);
+        QAtomicInt cancellationFlag {1};
+        myImage.setCancellationFlag(&cancellationFlag);
+        // A cancelled render returns a null image…
+        QVERIFY(myImage.getImage().isNull());
+        // …and does not poison the cache.
+        cancellationFlag.storeRelease(0);
+        QCOMPARE(myImage.getImage().size(), QSize(151, 151));
+        myImage.setCancellationFlag(nullptr);
+        QCOMPARE(myImage.getImage().size(), QSize(151, 151));
+    }
+
+    void benchmarkGetImage_data()
+    {
+        QTest::addColumn<int>("threadCount");
+        QTest::newRow("1 thread") << 1;
+        QTest::newRow("ideal thread count") << QThread::idealThreadCount();
+    }
+
+    void benchmarkGetImage()
+    {
+        QFETCH(int, threadCount);
+        ChromaHueImage myImage(colorSpace);
+        myImage.setImageSize(500);
+        myImage.setChromaRange(130);
+        myImage.setThreadCount(threadCount);
+        qreal lightness = 0;
+        // Measure the rendering, and not the shared cache.
+        const qint64 oldMaximumSize = SharedImageCache::maximumSize();
+        SharedImageCache::setMaximumSize(0);
+        QBENCHMARK {
+            // Force a new rendering for each iteration
+            lightness = (lightness >= 100) ? 0 : lightness + 1;
+            myImage.setLightness(lightness);
+            myImage.getImage();
+        }
+        SharedImageCache::setMaximumSize(oldMaximumSize);
+    }
+
     void testImageSize()
     {
         ChromaHueImage test(colorSpace);
@@ -300,6 +300,82 @@ private Q_SLOTS:
         QTest::mouseRelease(&myWidget, Qt::MouseButton::LeftButton);
     }
 
+    void testMouseMoveCoalescing()
+    {
+        ChromaLightnessDiagram myWidget {m_rgbColorSpace};
+        myWidget.show();
+        constexpr int size = 100;
+        myWidget.resize(size, size);
+        QTest::mousePress(&myWidget, Qt::MouseButton::LeftButton, Qt::KeyboardModifier::NoModifier, QPoint(size * 10 / 100, size * 50 / 100));
+        QMouseEvent firstMove(QEvent::MouseMove, QPointF(size * 15 / 100, size * 45 / 100), Qt::NoButton, Qt::LeftButton, Qt::NoModifier);
+        QCoreApplication::sendEvent(&myWidget, &firstMove);
+        // The first move is processed immediately…
+        const LchDouble afterFirstMove = myWidget.currentColor();
+        QMouseEvent secondMove(QEvent::MouseMove, QPointF(size * 20 / 100, size * 40 / 100), Qt::NoButton, Qt::LeftButton, Qt::NoModifier);
+        QCoreApplication::sendEvent(&myWidget, &secondMove);
+        // …the second one within the same frame is delayed…
+        QVERIFY(myWidget.currentColor().hasSameCoordinates(afterFirstMove));
+        // …until the end of the frame.
+        QTRY_VERIFY(!myWidget.currentColor().hasSameCoordinates(afterFirstMove));
+        QTest::mouseRelease(&myWidget, Qt::MouseButton::LeftButton, Qt::KeyboardModifier::NoModifier, QPoint(size * 20 / 100, size * 40 / 100));
+    }
+
+    void testMouseReleaseNotDelayed()
+    {
+        ChromaLightnessDiagram myWidget {m_rgbColorSpace};
+        myWidget.show();
+        constexpr int size = 100;
+        myWidget.resize(size, size);
+        QTest::mousePress(&myWidget, Qt::MouseButton::LeftButton, Qt::KeyboardModifier::NoModifier, QPoint(size * 10 / 100, size * 50 / 100));
+        QMouseEvent firstMove(QEvent::MouseMove, QPointF(size * 15 / 100, size * 45 / 100), Qt::NoButton, Qt::LeftButton, Qt::NoModifier);
+        QCoreApplication::sendEvent(&myWidget, &firstMove);
+        // This move is waiting for processing when the release comes:
+        QMouseEvent secondMove(QEvent::MouseMove, QPointF(size * 20 / 100, size * 40 / 100), Qt::NoButton, Qt::LeftButton, Qt::NoModifier);
+        QCoreApplication::sendEvent(&myWidget, &secondMove);
+        QMouseEvent release(QEvent::MouseButtonRelease, QPointF(size * 5 / 100, size * 60 / 100), Qt::LeftButton, Qt::NoButton, Qt::NoModifier);
+        QCoreApplication::sendEvent(&myWidget, &release);
+        // The release is processed immediately…
+        const LchDouble afterRelease = myWidget.currentColor();
+        const LchDouble expected = m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness( //
+            myWidget.d_pointer->fromWidgetPixelPositionToColor(QPoint(size * 5 / 100, size * 60 / 100)));
+        QVERIFY(afterRelease.hasSameCoordinates(expected));
+        // …and is not overwritten by the dropped move.
+        QTest::qWait(100);
+        QVERIFY(myWidget.currentColor().hasSameCoordinates(afterRelease));
+    }
+
+    void testThrottledNotifications()
+    {
+        // Needed to read the signal arguments from QSignalSpy:
+        qRegisterMetaType<LchDouble>();
+        ChromaLightnessDiagram myWidget {m_rgbColorSpace};
+        QSignalSpy spyThrottled(&myWidget, &ChromaLightnessDiagram::currentColorChangedThrottled);
+        QSignalSpy spyFinished(&myWidget, &ChromaLightnessDiagram::currentColorChangeFinished);
+        QCOMPARE(myWidget.throttledNotificationRate(), 0.0);
+        myWidget.setThrottledNotificationRate(10);
+        QCOMPARE(myWidget.throttledNotificationRate(), 10.0);
+        myWidget.setCurrentColor(LchDouble {50, 20, 10});
+        myWidget.setCurrentColor(LchDouble {50, 25, 10});
+        QCOMPARE(spyThrottled.count(), 1);
+        QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 2000);
+        QVERIFY(spyFinished.at(0).at(0).value<LchDouble>().hasSameCoordinates(LchDouble {50, 25, 10}));
+    }
+
+    void testThrottledNotificationsMouseRelease()
+    {
+        ChromaLightnessDiagram myWidget {m_rgbColorSpace};
+        myWidget.show();
+        constexpr int size = 100;
+        myWidget.resize(size, size);
+        myWidget.setThrottledNotificationRate(10);
+        QSignalSpy spyFinished(&myWidget, &ChromaLightnessDiagram::currentColorChangeFinished);
+        QTest::mousePress(&myWidget, Qt::MouseButton::LeftButton, Qt::KeyboardModifier::NoModifier, QPoint(size * 10 / 100, size * 50 / 100));
+        QCOMPARE(spyFinished.count(), 0);
+        // The release finishes the interaction without delay.
+        QTest::mouseRelease(&myWidget, Qt::MouseButton::LeftButton, Qt::KeyboardModifier::NoModifier, QPoint(size * 20 / 100, size * 40 / 100));
+        QCOMPARE(spyFinished.count(), 1);
+    }
+
     void testMouseSupport2()
     {
         // Test reactions to mouse events when moving out-of-gamut
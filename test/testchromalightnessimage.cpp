@@ -32,7 +32,9 @@
 #include "chromalightnessimage.h"
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "PerceptualColor/sharedimagecache.h"
 #include "helper.h"
+#include "lchvalues.h"
 
 #include <QtTest>
 
@@ -51,6 +53,31 @@ public:
 private:
     QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace = RgbColorSpaceFactory::createSrgb();
 
+    /** @brief Renders the image pixel by pixel with
+     * <tt>QImage::setPixelColor()</tt>.
+     *
+     * This is a straight-forward reference implementation against
+     * which the optimized rendering of the image class is tested. */
+    QImage referenceImage(const QSize size, const qreal hue) const
+    {
+        QImage result(size, QImage::Format_ARGB32_Premultiplied);
+        result.fill(m_rgbColorSpace->toQColorRgbBound(LchValues::neutralGray()));
+        LchDouble lch;
+        lch.h = hue;
+        QColor rgbColor;
+        for (int y = 0; y < size.height(); ++y) {
+            lch.l = 100 - (y + 0.5) * 100.0 / size.height();
+            for (int x = 0; x < size.width(); ++x) {
+                lch.c = (x + 0.5) * 100.0 / size.height();
+                rgbColor = m_rgbColorSpace->toQColorRgbUnbound(lch);
+                if (rgbColor.isValid()) {
+                    result.setPixelColor(x, y, rgbColor);
+                }
+            }
+        }
+        return result;
+    }
+
 private Q_SLOTS:
     void initTestCase()
     {
@@ -65,6 +92,8 @@ private Q_SLOTS:
     void init()
     {
         // Called before each test function is executed
+        // Make sure that the images are really rendered.
+        SharedImageCache::clear();
     }
 
     void cleanup()
@@ -118,6 +147,118 @@ private Q_SLOTS:
         QCOMPARE(m_image.pixelColor(0, 101).isValid(), false);
     }
 
+    void testBitIdenticalToReference_data()
+    {
+        QTest::addColumn<QSize>("size");
+        QTest::addColumn<qreal>("hue");
+        QTest::newRow("1 1 0") << QSize(1, 1) << 0.;
+        QTest::newRow("201 101 0") << QSize(201, 101) << 0.;
+        QTest::newRow("201 101 123.4") << QSize(201, 101) << 123.4;
+        QTest::newRow("50 120 270") << QSize(50, 120) << 270.;
+    }
+
+    void testBitIdenticalToReference()
+    {
+        QFETCH(QSize, size);
+        QFETCH(qreal, hue);
+        ChromaLightnessImage myImage(m_rgbColorSpace);
+        myImage.setImageSize(size);
+        myImage.setHue(hue);
+        QCOMPARE(myImage.getImage(), referenceImage(size, hue));
+    }
+
+    void testThreadCount()
+    {
+        ChromaLightnessImage myImage(m_rgbColorSpace);
+        myImage.setImageSize(QSize(201, 101));
+        myImage.setHue(40);
+        const QImage sequentialImage = myImage.getImage();
+        myImage.setThreadCount(QThread::idealThreadCount() + 3);
+        // Changing the thread count does not invalidate the cache:
+        QVERIFY(!myImage.m_image.isNull());
+        // Render again:
+        myImage.m_image = QImage();
+        SharedImageCache::clear();
+        // The result must be deterministic:
+        QCOMPARE(myImage.getImage(), sequentialImage);
+        // Invalid values are bound to 1:
+        myImage.setThreadCount(0);
+        QCOMPARE(myImage.m_threadCount, 1);
+    }
+
+    void testResolutionDivisor()
+    {
+        ChromaLightnessImage myImage(m_rgbColorSpace);
+        myImage.setImageSize(QSize(201, 101));
+        myImage.setHue(40);
+        const QByteArray fullResolutionKey = myImage.cacheKey();
+        myImage.setResolutionDivisor(2);
+        QVERIFY(myImage.cacheKey() != fullResolutionKey);
+        // The coarse image has nevertheless the full size:
+        QCOMPARE(myImage.getImage().size(), QSize(201, 101));
+        // Invalid values are bound to 1:
+        myImage.setResolutionDivisor(0);
+        QCOMPARE(myImage.m_resolutionDivisor, 1);
+        QCOMPARE(myImage.cacheKey(), fullResolutionKey);
+    }
+
+    void testResolutionDivisorBypassesCaches()
+    {
+        SharedImageCache::clear();
+        ChromaLightnessImage myImage(m_rgbColorSpace);
+        myImage.setImageSize(QSize(201, 101));
+        myImage.setHue(40);
+        myImage.setResolutionDivisor(2);
+        QVERIFY(!myImage.getImage().isNull());
+        // Coarse images must not displace full-resolution images:
+        QCOMPARE(SharedImageCache::size(), Q_INT64_C(0));
+        myImage.setResolutionDivisor(1);
+        myImage.getImage();
+        QVERIFY(SharedImageCache::size() > 0);
+    }
+
+    void testCancellationFlag()
+    {
+        ChromaLightnessImage myImage(m_rgbColorSpace);
+        myImage.setImageSize(QSize(201, 101));
+        myImage.setHue(40);
+        QAtomicInt cancellationFlag {1};
+        myImage.setCancellationFlag(&cancellationFlag);
+        // A cancelled render returns a null image…
+        QVERIFY(myImage.getImage().isNull());
+        // …and does not poison the cache.
+        cancellationFlag.storeRelease(0);
+        QCOMPARE(myImage.getImage().size(), QSize(201, 101));
+        myImage.setCancellationFlag(nullptr);
+        QCOMPARE(myImage.getImage().size(), QSize(201, 101));
+    }
+
+    void benchmarkGetImage_data()
+    {
+        QTest::addColumn<int>("threadCount");
+        QTest::newRow("1 thread") << 1;
+        QTest::newRow("ideal thread count") << QThread::idealThreadCount();
+    }
+
+    void benchmarkGetImage()
+    {
+        QFETCH(int, threadCount);
+        ChromaLightnessImage myImage(m_rgbColorSpace);
+        myImage.setImageSize(QSize(500, 250));
+        myImage.setThreadCount(threadCount);
+        qreal hue = 0;
+        // Measure the rendering, and not the shared cache.
+        const qint64 oldMaximumSize = SharedImageCache::maximumSize();
+        SharedImageCache::setMaximumSize(0);
+        QBENCHMARK {
+            // Force a new rendering for each iteration
+            hue = (hue >= 359) ? 0 : hue + 1;
+            myImage.setHue(hue);
+            myImage.getImage();
+        }
+        SharedImageCache::setMaximumSize(oldMaximumSize);
+    }
+
     void testImageSize()
     {
         ChromaLightnessImage test(m_rgbColorSpace);
@@ -0,0 +1,247 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "colorchangethrottle.h"
+
+#include <QtTest>
+
+namespace PerceptualColor
+{
+/** @brief A color for the unit tests.
+ *
+ * @param lightness The lightness of the color
+ * @returns An opaque gray with the given lightness. */
+static LchaDouble gray(const qreal lightness)
+{
+    LchaDouble result;
+    result.l = lightness;
+    result.c = 0;
+    result.h = 0;
+    result.a = 1;
+    return result;
+}
+
+static void snippet01()
+{
+    //! [ColorChangeThrottle usage]
+    ColorChangeThrottle myThrottle;
+    // At most 30 notifications per second …
+    myThrottle.setMaximumRate(30);
+    // … and only for changes that are visible.
+    myThrottle.setMinimumDeltaE(1);
+    QObject::connect(&myThrottle, &ColorChangeThrottle::throttledChange, []() {
+        // Cheap preview of the current color
+    });
+    QObject::connect(&myThrottle, &ColorChangeThrottle::finished, []() {
+        // Full-quality update with the current color
+    });
+    // Call this on each change of the color:
+    myThrottle.registerChange(gray(50));
+    //! [ColorChangeThrottle usage]
+}
+
+class TestColorChangeThrottle : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestColorChangeThrottle(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testSnippet01()
+    {
+        snippet01();
+    }
+
+    void testConstructor()
+    {
+        ColorChangeThrottle myThrottle;
+        QCOMPARE(myThrottle.maximumRate(), 0.0);
+        QCOMPARE(myThrottle.minimumDeltaE(), 0.0);
+    }
+
+    void testDeltaE()
+    {
+        QCOMPARE(ColorChangeThrottle::deltaE(gray(50), gray(50)), 0.0);
+        QCOMPARE(ColorChangeThrottle::deltaE(gray(50), gray(60)), 10.0);
+        QCOMPARE(ColorChangeThrottle::deltaE(gray(60), gray(50)), 10.0);
+        LchaDouble red = gray(50);
+        red.c = 10;
+        red.h = 0;
+        LchaDouble green = gray(50);
+        green.c = 10;
+        green.h = 180;
+        QCOMPARE(ColorChangeThrottle::deltaE(red, green), 20.0);
+        // Hue differences without chroma are irrelevant.
+        LchaDouble grayWithHue = gray(50);
+        grayWithHue.h = 90;
+        QCOMPARE(ColorChangeThrottle::deltaE(gray(50), grayWithHue), 0.0);
+        // Alpha is scaled to the range of lightness.
+        LchaDouble transparent = gray(50);
+        transparent.a = 0;
+        QCOMPARE(ColorChangeThrottle::deltaE(gray(50), transparent), 100.0);
+    }
+
+    void testSetters()
+    {
+        ColorChangeThrottle myThrottle;
+        myThrottle.setMaximumRate(25);
+        QCOMPARE(myThrottle.maximumRate(), 25.0);
+        myThrottle.setMaximumRate(-5);
+        QCOMPARE(myThrottle.maximumRate(), 0.0);
+        myThrottle.setMinimumDeltaE(2.5);
+        QCOMPARE(myThrottle.minimumDeltaE(), 2.5);
+        myThrottle.setMinimumDeltaE(-1);
+        QCOMPARE(myThrottle.minimumDeltaE(), 0.0);
+    }
+
+    void testDisabledByDefault()
+    {
+        ColorChangeThrottle myThrottle;
+        QSignalSpy throttledSpy(&myThrottle, &ColorChangeThrottle::throttledChange);
+        QSignalSpy finishedSpy(&myThrottle, &ColorChangeThrottle::finished);
+        myThrottle.registerChange(gray(10));
+        myThrottle.registerChange(gray(20));
+        QTest::qWait(ColorChangeThrottle::finishDelayMilliseconds + 100);
+        QCOMPARE(throttledSpy.count(), 0);
+        QCOMPARE(finishedSpy.count(), 0);
+    }
+
+    void testFirstChangeIsImmediate()
+    {
+        ColorChangeThrottle myThrottle;
+        myThrottle.setMaximumRate(10);
+        QSignalSpy throttledSpy(&myThrottle, &ColorChangeThrottle::throttledChange);
+        myThrottle.registerChange(gray(10));
+        QCOMPARE(throttledSpy.count(), 1);
+    }
+
+    void testRateLimit()
+    {
+        ColorChangeThrottle myThrottle;
+        // One notification each 100 ms
+        myThrottle.setMaximumRate(10);
+        QSignalSpy throttledSpy(&myThrottle, &ColorChangeThrottle::throttledChange);
+        myThrottle.registerChange(gray(10));
+        myThrottle.registerChange(gray(20));
+        myThrottle.registerChange(gray(30));
+        QCOMPARE(throttledSpy.count(), 1);
+        // The most recent change is notified after the interval, while
+        // the intermediate change is dropped.
+        QTRY_COMPARE_WITH_TIMEOUT(throttledSpy.count(), 2, 1000);
+        QCOMPARE(myThrottle.m_notifiedColor.l, 30.0);
+    }
+
+    void testMinimumDeltaE()
+    {
+        ColorChangeThrottle myThrottle;
+        myThrottle.setMaximumRate(1000);
+        myThrottle.setMinimumDeltaE(5);
+        QSignalSpy throttledSpy(&myThrottle, &ColorChangeThrottle::throttledChange);
+        myThrottle.registerChange(gray(50));
+        QCOMPARE(throttledSpy.count(), 1);
+        QTRY_VERIFY(!myThrottle.m_rateTimer.isActive());
+        // Too small compared to the notified color:
+        myThrottle.registerChange(gray(52));
+        QTRY_VERIFY(!myThrottle.m_rateTimer.isActive());
+        QCOMPARE(throttledSpy.count(), 1);
+        // The small changes add up:
+        myThrottle.registerChange(gray(56));
+        QCOMPARE(throttledSpy.count(), 2);
+    }
+
+    void testFinishedWhenResting()
+    {
+        ColorChangeThrottle myThrottle;
+        myThrottle.setMaximumRate(10);
+        QSignalSpy finishedSpy(&myThrottle, &ColorChangeThrottle::finished);
+        myThrottle.registerChange(gray(10));
+        myThrottle.registerChange(gray(20));
+        QCOMPARE(finishedSpy.count(), 0);
+        QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 2000);
+        // Only once per series of changes:
+        QTest::qWait(ColorChangeThrottle::finishDelayMilliseconds + 100);
+        QCOMPARE(finishedSpy.count(), 1);
+    }
+
+    void testFinish()
+    {
+        ColorChangeThrottle myThrottle;
+        myThrottle.setMaximumRate(10);
+        QSignalSpy throttledSpy(&myThrottle, &ColorChangeThrottle::throttledChange);
+        QSignalSpy finishedSpy(&myThrottle, &ColorChangeThrottle::finished);
+        // Without changes, there is nothing to finish.
+        myThrottle.finish();
+        QCOMPARE(finishedSpy.count(), 0);
+        myThrottle.registerChange(gray(10));
+        myThrottle.registerChange(gray(20));
+        myThrottle.finish();
+        QCOMPARE(finishedSpy.count(), 1);
+        // The pending change is dropped because finished() makes
+        // it obsolete.
+        QTest::qWait(ColorChangeThrottle::finishDelayMilliseconds + 100);
+        QCOMPARE(throttledSpy.count(), 1);
+        QCOMPARE(finishedSpy.count(), 1);
+        // A new series of changes is notified immediately.
+        myThrottle.registerChange(gray(30));
+        QCOMPARE(throttledSpy.count(), 2);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestColorChangeThrottle)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testcolorchangethrottle.moc"
@@ -124,6 +124,31 @@ static void snippet04()
     Q_UNUSED(myColor);
 }
 
+static void snippet06()
+{
+    //! [ColorDialog Throttled notifications]
+    auto myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+    PerceptualColor::ColorDialog *myDialog = new PerceptualColor::ColorDialog(myColorSpace);
+    // At most 20 previews per second, and only for visible changes:
+    myDialog->setThrottledNotificationRate(20);
+    myDialog->setThrottledNotificationDeltaE(1);
+    QObject::connect(myDialog, //
+                     &PerceptualColor::ColorDialog::currentColorChangedThrottled,
+                     [](const QColor &color) {
+                         // Render a cheap preview with this color
+                         Q_UNUSED(color)
+                     });
+    QObject::connect(myDialog, //
+                     &PerceptualColor::ColorDialog::currentColorChangeFinished,
+                     [](const QColor &color) {
+                         // Render in full quality with this color
+                         Q_UNUSED(color)
+                     });
+    //! [ColorDialog Throttled notifications]
+    QCOMPARE(myDialog->throttledNotificationRate(), 20.0);
+    delete myDialog;
+}
+
 namespace PerceptualColor
 {
 class TestColorDialog : public QObject
@@ -618,6 +643,42 @@ private Q_SLOTS:
         QCOMPARE(spyPerceptualDialog.count(), spyQDialog.count());
     }
 
+    void testThrottledNotifications()
+    {
+        m_perceptualDialog.reset(new PerceptualColor::ColorDialog(m_srgbBuildinColorSpace));
+        QSignalSpy spyThrottled(m_perceptualDialog.data(), &PerceptualColor::ColorDialog::currentColorChangedThrottled);
+        QSignalSpy spyFinished(m_perceptualDialog.data(), &PerceptualColor::ColorDialog::currentColorChangeFinished);
+        QSignalSpy spyRate(m_perceptualDialog.data(), &PerceptualColor::ColorDialog::throttledNotificationRateChanged);
+        QSignalSpy spyDeltaE(m_perceptualDialog.data(), &PerceptualColor::ColorDialog::throttledNotificationDeltaEChanged);
+
+        // Disabled by default
+        QCOMPARE(m_perceptualDialog->throttledNotificationRate(), 0.0);
+        QCOMPARE(m_perceptualDialog->throttledNotificationDeltaE(), 0.0);
+        m_perceptualDialog->setCurrentColor(QColor(1, 2, 3));
+        QTest::qWait(ColorChangeThrottle::finishDelayMilliseconds + 100);
+        QCOMPARE(spyThrottled.count(), 0);
+        QCOMPARE(spyFinished.count(), 0);
+
+        // Property notify signals
+        m_perceptualDialog->setThrottledNotificationRate(10);
+        m_perceptualDialog->setThrottledNotificationRate(10);
+        QCOMPARE(spyRate.count(), 1);
+        m_perceptualDialog->setThrottledNotificationDeltaE(-3);
+        QCOMPARE(m_perceptualDialog->throttledNotificationDeltaE(), 0.0);
+        QCOMPARE(spyDeltaE.count(), 0);
+
+        // A quick series of changes
+        m_perceptualDialog->setCurrentColor(QColor(10, 20, 30));
+        m_perceptualDialog->setCurrentColor(QColor(40, 50, 60));
+        m_perceptualDialog->setCurrentColor(QColor(70, 80, 90));
+        QCOMPARE(spyThrottled.count(), 1);
+        QCOMPARE(spyThrottled.at(0).at(0).value<QColor>().name(), QStringLiteral("#0a141e"));
+        QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 2000);
+        QCOMPARE(spyFinished.at(0).at(0).value<QColor>().name(), QStringLiteral("#46505a"));
+        QCOMPARE(spyThrottled.count(), 2);
+        QCOMPARE(spyThrottled.at(1).at(0).value<QColor>().name(), QStringLiteral("#46505a"));
+    }
+
     void testCurrentColorProperty_data()
     {
         helperProvideQColors();
@@ -1465,6 +1526,11 @@ private Q_SLOTS:
         mySnippets.testSnippet05();
     }
 
+    void testSnippet06()
+    {
+        snippet06();
+    }
+
     void benchmarkCreateAndShowPerceptualDialog()
     {
         m_perceptualDialog.reset(nullptr);
@@ -140,6 +140,44 @@ private Q_SLOTS:
         QCOMPARE(myWheel.hue(), referenceHue);
     }
 
+    void testThrottledNotifications()
+    {
+        ColorWheel myWheel(m_rgbColorSpace);
+        QSignalSpy spyThrottled(&myWheel, &ColorWheel::hueChangedThrottled);
+        QSignalSpy spyFinished(&myWheel, &ColorWheel::hueChangeFinished);
+        QCOMPARE(myWheel.throttledNotificationRate(), 0.0);
+        // Disabled by default:
+        myWheel.setHue(10);
+        QTest::qWait(2 * ColorChangeThrottle::finishDelayMilliseconds);
+        QCOMPARE(spyThrottled.count(), 0);
+        QCOMPARE(spyFinished.count(), 0);
+        myWheel.setThrottledNotificationRate(10);
+        QCOMPARE(myWheel.throttledNotificationRate(), 10.0);
+        myWheel.setHue(20);
+        myWheel.setHue(30);
+        QCOMPARE(spyThrottled.count(), 1);
+        QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 2000);
+        QCOMPARE(spyFinished.at(0).at(0).toReal(), 30.0);
+    }
+
+    void testStaticLayer()
+    {
+        ColorWheel myWheel(m_rgbColorSpace);
+        myWheel.resize(300, 300);
+        myWheel.show();
+        myWheel.repaint();
+        const qint64 layerKey = myWheel.d_pointer->m_staticLayer.cacheKey();
+        QVERIFY(!myWheel.d_pointer->m_staticLayer.isNull());
+        // Moving the handle reuses the layer.
+        myWheel.setHue(myWheel.hue() + 30);
+        myWheel.repaint();
+        QCOMPARE(myWheel.d_pointer->m_staticLayer.cacheKey(), layerKey);
+        // A new size needs a new layer.
+        myWheel.resize(200, 200);
+        myWheel.repaint();
+        QVERIFY(myWheel.d_pointer->m_staticLayer.cacheKey() != layerKey);
+    }
+
     void testMinimumSizeHint()
     {
         ColorWheel myColorWheel(m_rgbColorSpace);
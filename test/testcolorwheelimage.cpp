@@ -31,9 +31,15 @@
 // this forces the header to be self-contained.
 #include "colorwheelimage.h"
 
+#include <QPainter>
+#include <QtMath>
 #include <QtTest>
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "PerceptualColor/sharedimagecache.h"
+#include "helper.h"
+#include "lchvalues.h"
+#include "polarpointf.h"
 
 class TestColorWheelSnippetClass : public QWidget
 {
@@ -79,6 +85,54 @@ public:
 private:
     QSharedPointer<RgbColorSpace> colorSpace = RgbColorSpaceFactory::createSrgb();
 
+    /** @brief Renders the image pixel by pixel with
+     * <tt>QImage::setPixelColor()</tt>.
+     *
+     * This is a straight-forward reference implementation against
+     * which the optimized rendering of the image class is tested. */
+    QImage referenceImage(const int size, const qreal border, const qreal wheelThickness) const
+    {
+        QImage result(QSize(size, size), QImage::Format_ARGB32_Premultiplied);
+        result.fill(Qt::transparent);
+        const qreal outerCircleDiameter = size - 2 * border;
+        PolarPointF polarCoordinates;
+        QColor rgbColor;
+        LchDouble lch;
+        const qreal center = (size - 1) / static_cast<qreal>(2);
+        lch.l = LchValues::neutralLightness;
+        lch.c = LchValues::srgbVersatileChroma;
+        const qreal minimumRadial = center - wheelThickness - border - overlap;
+        const qreal maximumRadial = center - border + overlap;
+        for (int x = 0; x < size; ++x) {
+            for (int y = 0; y < size; ++y) {
+                polarCoordinates = PolarPointF(QPointF(x - center, center - y));
+                if (isInRange<qreal>(minimumRadial, polarCoordinates.radial(), maximumRadial)) {
+                    lch.h = polarCoordinates.angleDegree();
+                    rgbColor = colorSpace->toQColorRgbUnbound(lch);
+                    if (rgbColor.isValid()) {
+                        result.setPixelColor(x, y, rgbColor);
+                    }
+                }
+            }
+        }
+        const qreal circleRadius = outerCircleDiameter / 2;
+        const qreal cutOffThickness = qSqrt(qPow(size, 2) * 2) / 2 - circleRadius + overlap;
+        QPainter myPainter(&result);
+        myPainter.setRenderHint(QPainter::Antialiasing, true);
+        myPainter.setPen(QPen(Qt::SolidPattern, cutOffThickness));
+        myPainter.setCompositionMode(QPainter::CompositionMode_Clear);
+        myPainter.drawEllipse(QPointF(static_cast<qreal>(size) / 2, static_cast<qreal>(size) / 2),
+                              circleRadius + cutOffThickness / 2,
+                              circleRadius + cutOffThickness / 2);
+        const qreal innerCircleDiameter = size - 2 * (wheelThickness + border);
+        if (innerCircleDiameter > 0) {
+            myPainter.setPen(QPen(Qt::NoPen));
+            myPainter.setBrush(QBrush(Qt::SolidPattern));
+            myPainter.drawEllipse(QRectF(wheelThickness + border, wheelThickness + border, innerCircleDiameter, innerCircleDiameter));
+        }
+        return result;
+    }
+
 private Q_SLOTS:
     void initTestCase()
     {
@@ -93,6 +147,8 @@ private Q_SLOTS:
     void init()
     {
         // Called before each test function is executed
+        // Make sure that the images are really rendered.
+        SharedImageCache::clear();
     }
 
     void cleanup()
@@ -105,6 +161,100 @@ private Q_SLOTS:
         ColorWheelImage test(colorSpace);
     }
 
+    void testMatchesReference_data()
+    {
+        QTest::addColumn<int>("size");
+        QTest::addColumn<qreal>("border");
+        QTest::addColumn<qreal>("wheelThickness");
+        QTest::newRow("50 0 10") << 50 << 0. << 10.;
+        QTest::newRow("101 5.5 20") << 101 << 5.5 << 20.;
+        QTest::newRow("100 2 80") << 100 << 2. << 80.;
+    }
+
+    void testMatchesReference()
+    {
+        QFETCH(int, size);
+        QFETCH(qreal, border);
+        QFETCH(qreal, wheelThickness);
+        ColorWheelImage myImage(colorSpace);
+        myImage.setImageSize(size);
+        myImage.setBorder(border);
+        myImage.setWheelThickness(wheelThickness);
+        const QImage actual = myImage.getImage();
+        const QImage expected = referenceImage(size, border, wheelThickness);
+        QCOMPARE(actual.size(), expected.size());
+        QCOMPARE(actual.format(), expected.format());
+        // The colors come from a lookup table with a hue resolution
+        // of 0.1°, so tiny rounding differences are allowed.
+        constexpr int tolerance = 2;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                const QRgb actualPixel = actual.pixel(x, y);
+                const QRgb expectedPixel = expected.pixel(x, y);
+                QVERIFY(qAbs(qRed(actualPixel) - qRed(expectedPixel)) <= tolerance);
+                QVERIFY(qAbs(qGreen(actualPixel) - qGreen(expectedPixel)) <= tolerance);
+                QVERIFY(qAbs(qBlue(actualPixel) - qBlue(expectedPixel)) <= tolerance);
+                QVERIFY(qAbs(qAlpha(actualPixel) - qAlpha(expectedPixel)) <= tolerance);
+            }
+        }
+    }
+
+    void testFastAngleDegree()
+    {
+        // Exact values on the axes
+        QCOMPARE(ColorWheelImage::fastAngleDegree(0, 0), 0.);
+        QCOMPARE(ColorWheelImage::fastAngleDegree(1, 0), 0.);
+        QCOMPARE(ColorWheelImage::fastAngleDegree(0, 1), 90.);
+        QCOMPARE(ColorWheelImage::fastAngleDegree(-1, 0), 180.);
+        QCOMPARE(ColorWheelImage::fastAngleDegree(0, -1), 270.);
+        // Compare with PolarPointF all around the circle
+        for (int i = 0; i < 3600; ++i) {
+            const qreal angle = qDegreesToRadians(i / 10. + 0.03);
+            const qreal x = 37 * qCos(angle);
+            const qreal y = 37 * qSin(angle);
+            const qreal expected = PolarPointF(QPointF(x, y)).angleDegree();
+            const qreal actual = ColorWheelImage::fastAngleDegree(x, y);
+            QVERIFY(isInRange<qreal>(0, actual, 360));
+            QVERIFY(qAbs(actual - expected) < 0.001);
+        }
+    }
+
+    void testHueTable()
+    {
+        ColorWheelImage myImage(colorSpace);
+        QVERIFY(myImage.m_hueTable.isEmpty());
+        myImage.setImageSize(50);
+        myImage.setWheelThickness(10);
+        myImage.getImage();
+        QCOMPARE(myImage.m_hueTable.size(), ColorWheelImage::hueTableSize);
+        // Colors are either opaque (in gamut) or transparent (out of gamut).
+        for (const QRgb color : qAsConst(myImage.m_hueTable)) {
+            QVERIFY((qAlpha(color) == 255) || (color == qRgba(0, 0, 0, 0)));
+        }
+        // The table does not depend on the image size.
+        const QVector<QRgb> oldTable = myImage.m_hueTable;
+        myImage.setImageSize(80);
+        myImage.getImage();
+        QCOMPARE(myImage.m_hueTable, oldTable);
+    }
+
+    void benchmarkGetImage()
+    {
+        ColorWheelImage myImage(colorSpace);
+        myImage.setWheelThickness(30);
+        int size = 500;
+        // Measure the rendering, and not the shared cache.
+        const qint64 oldMaximumSize = SharedImageCache::maximumSize();
+        SharedImageCache::setMaximumSize(0);
+        QBENCHMARK {
+            // Force a new rendering for each iteration, like resizing does.
+            size = (size >= 600) ? 500 : size + 1;
+            myImage.setImageSize(size);
+            myImage.getImage();
+        }
+        SharedImageCache::setMaximumSize(oldMaximumSize);
+    }
+
     void testImageSize()
     {
         ColorWheelImage test(colorSpace);
@@ -0,0 +1,249 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "gamutslice.h"
+
+#include <QtTest>
+
+#include <QRandomGenerator>
+
+#include <limits>
+
+namespace PerceptualColor
+{
+class TestGamutSlice : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestGamutSlice(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    /** @brief A disk-shaped mask. */
+    static QVector<bool> diskMask(const int width, const int height, const QPoint center, const int radius)
+    {
+        QVector<bool> result(width * height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const QPoint distance = QPoint(x, y) - center;
+                result[y * width + x] = (QPoint::dotProduct(distance, distance) <= radius * radius);
+            }
+        }
+        return result;
+    }
+
+    /** @brief A mask with randomly distributed in-gamut pixels.
+     *
+     * At least one pixel is in-gamut. */
+    static QVector<bool> randomMask(const int width, const int height, const quint32 seed, const int percent)
+    {
+        QRandomGenerator generator(seed);
+        QVector<bool> result(width * height);
+        for (int i = 0; i < result.count(); ++i) {
+            result[i] = (generator.bounded(100) < percent);
+        }
+        result[static_cast<int>(seed % static_cast<quint32>(result.count()))] = true;
+        return result;
+    }
+
+    /** @brief Squared distance to the nearest in-gamut pixel,
+     * found by brute force. */
+    static int referenceDistanceSquare(const int width, const int height, const QVector<bool> &mask, const QPoint point)
+    {
+        int result = std::numeric_limits<int>::max();
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                if (mask.at(y * width + x)) {
+                    const QPoint distance = QPoint(x, y) - point;
+                    result = qMin(result, QPoint::dotProduct(distance, distance));
+                }
+            }
+        }
+        return result;
+    }
+
+    /** @brief Compares all query results with a brute-force search. */
+    static void verifyAgainstBruteForce(const int width, const int height, const QVector<bool> &mask)
+    {
+        const GamutSlice slice(width, height, mask);
+        // Test all pixels within the raster, and some points outside.
+        for (int y = -3; y < height + 3; ++y) {
+            for (int x = -3; x < width + 3; ++x) {
+                const QPoint point(x, y);
+                const QPoint result = slice.nearestInGamutPixel(point);
+                QVERIFY(result.x() >= 0);
+                QVERIFY(result.x() < width);
+                QVERIFY(result.y() >= 0);
+                QVERIFY(result.y() < height);
+                QVERIFY(mask.at(result.y() * width + result.x()));
+                const QPoint distance = result - point;
+                QCOMPARE(QPoint::dotProduct(distance, distance), //
+                         referenceDistanceSquare(width, height, mask, point));
+            }
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testConstructor()
+    {
+        const GamutSlice slice(3, 2, QVector<bool>(6, true));
+        QCOMPARE(slice.width(), 3);
+        QCOMPARE(slice.height(), 2);
+        QCOMPARE(slice.isEmpty(), false);
+    }
+
+    void testEmpty()
+    {
+        const GamutSlice slice(5, 4, QVector<bool>(20, false));
+        QCOMPARE(slice.isEmpty(), true);
+        QCOMPARE(slice.nearestInGamutPixel(QPoint(2, 2)), QPoint(0, 0));
+        QCOMPARE(slice.nearestInGamutPixel(QPoint(-10, 10)), QPoint(0, 0));
+        const GamutSlice zeroSize(0, 0, QVector<bool>());
+        QCOMPARE(zeroSize.isEmpty(), true);
+        QCOMPARE(zeroSize.nearestInGamutPixel(QPoint(2, 2)), QPoint(0, 0));
+    }
+
+    void testInGamutPixelsAreUnchanged()
+    {
+        const QVector<bool> mask = diskMask(20, 15, QPoint(8, 7), 5);
+        const GamutSlice slice(20, 15, mask);
+        for (int y = 0; y < 15; ++y) {
+            for (int x = 0; x < 20; ++x) {
+                if (mask.at(y * 20 + x)) {
+                    QCOMPARE(slice.nearestInGamutPixel(QPoint(x, y)), QPoint(x, y));
+                }
+            }
+        }
+    }
+
+    void testSinglePixel()
+    {
+        QVector<bool> mask(7 * 5, false);
+        mask[3 * 7 + 6] = true;
+        const GamutSlice slice(7, 5, mask);
+        QCOMPARE(slice.nearestInGamutPixel(QPoint(0, 0)), QPoint(6, 3));
+        QCOMPARE(slice.nearestInGamutPixel(QPoint(6, 3)), QPoint(6, 3));
+        QCOMPARE(slice.nearestInGamutPixel(QPoint(100, -100)), QPoint(6, 3));
+    }
+
+    void testSizeInBytes()
+    {
+        const GamutSlice small(4, 3, QVector<bool>(12, true));
+        const GamutSlice big(40, 30, QVector<bool>(1200, true));
+        QVERIFY(small.sizeInBytes() >= 12 * static_cast<int>(sizeof(int)));
+        QVERIFY(big.sizeInBytes() >= 1200 * static_cast<int>(sizeof(int)));
+        QVERIFY(big.sizeInBytes() > small.sizeInBytes());
+    }
+
+    void testAgainstBruteForce_data()
+    {
+        QTest::addColumn<int>("width");
+        QTest::addColumn<int>("height");
+        QTest::addColumn<QVector<bool>>("mask");
+        QTest::newRow("disk") << 31 << 23 << diskMask(31, 23, QPoint(10, 12), 8);
+        QTest::newRow("disk touching edge") << 31 << 23 << diskMask(31, 23, QPoint(0, 11), 9);
+        QTest::newRow("single column") << 1 << 17 << randomMask(1, 17, 1, 20);
+        QTest::newRow("single row") << 17 << 1 << randomMask(17, 1, 2, 20);
+        QTest::newRow("random sparse") << 29 << 19 << randomMask(29, 19, 3, 2);
+        QTest::newRow("random medium") << 29 << 19 << randomMask(29, 19, 4, 20);
+        QTest::newRow("random dense") << 29 << 19 << randomMask(29, 19, 5, 80);
+    }
+
+    void testAgainstBruteForce()
+    {
+        QFETCH(int, width);
+        QFETCH(int, height);
+        QFETCH(QVector<bool>, mask);
+        verifyAgainstBruteForce(width, height, mask);
+    }
+
+    void testSnippet()
+    {
+        //! [GamutSlice usage]
+        // A raster of 4 × 3 pixels. Only the pixel at (3, 2) is in-gamut.
+        QVector<bool> inGamutMask(4 * 3, false);
+        inGamutMask[2 * 4 + 3] = true;
+        const GamutSlice slice(4, 3, inGamutMask);
+        const QPoint nearest = slice.nearestInGamutPixel(QPoint(0, 0));
+        //! [GamutSlice usage]
+        QCOMPARE(nearest, QPoint(3, 2));
+    }
+
+    void benchmarkConstructor()
+    {
+        const QVector<bool> mask = diskMask(801, 400, QPoint(0, 200), 300);
+        QBENCHMARK {
+            const GamutSlice slice(801, 400, mask);
+            Q_UNUSED(slice)
+        }
+    }
+
+    void benchmarkNearestInGamutPixel()
+    {
+        const QVector<bool> mask = diskMask(801, 400, QPoint(0, 200), 300);
+        const GamutSlice slice(801, 400, mask);
+        QBENCHMARK {
+            for (int x = 0; x < 801; x += 10) {
+                Q_UNUSED(slice.nearestInGamutPixel(QPoint(x, 10)))
+            }
+        }
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestGamutSlice)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testgamutslice.moc"
@@ -31,9 +31,12 @@
 // this forces the header to be self-contained.
 #include "gradientimage.h"
 
+#include <QPainter>
 #include <QtTest>
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "PerceptualColor/sharedimagecache.h"
+#include "helper.h"
 
 class TestGradientSnippetClass : public QWidget
 {
@@ -90,6 +93,33 @@ public:
 private:
     QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace = RgbColorSpaceFactory::createSrgb();
 
+    /** @brief Renders the image pixel by pixel with
+     * <tt>QImage::setPixelColor()</tt>.
+     *
+     * This is a straight-forward reference implementation against
+     * which the optimized rendering of the image class is tested. */
+    QImage referenceImage(const GradientImage &gradient) const
+    {
+        QImage temp(gradient.m_gradientLength, 1, QImage::Format_ARGB32_Premultiplied);
+        temp.fill(Qt::transparent);
+        for (int i = 0; i < gradient.m_gradientLength; ++i) {
+            temp.setPixelColor( //
+                i,
+                0,
+                m_rgbColorSpace->toQColorRgbBound( //
+                    gradient.colorFromValue((i + 0.5) / static_cast<qreal>(gradient.m_gradientLength))));
+        }
+        QImage result(gradient.m_gradientLength, gradient.m_gradientThickness, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&result);
+        if ((gradient.m_firstColorCorrected.a != 1) || (gradient.m_secondColorCorrectedAndAltered.a != 1)) {
+            painter.fillRect(0, 0, gradient.m_gradientLength, gradient.m_gradientThickness, QBrush(transparencyBackground(gradient.m_devicePixelRatioF)));
+        }
+        for (int i = 0; i < gradient.m_gradientThickness; ++i) {
+            painter.drawImage(0, i, temp);
+        }
+        return result;
+    }
+
 private Q_SLOTS:
     void initTestCase()
     {
@@ -225,6 +255,74 @@ private Q_SLOTS:
         QCOMPARE(myGradient.getImage().isNull(), false);
     }
 
+    void testBitIdenticalToReference_data()
+    {
+        QTest::addColumn<LchaDouble>("firstColor");
+        QTest::addColumn<LchaDouble>("secondColor");
+        QTest::newRow("opaque") << LchaDouble {20, 30, 40, 1} << LchaDouble {80, 60, 200, 1};
+        QTest::newRow("out-of-gamut") << LchaDouble {50, 150, 0, 1} << LchaDouble {50, 150, 180, 1};
+        QTest::newRow("transparent") << LchaDouble {20, 30, 40, 0} << LchaDouble {80, 60, 200, 0.7};
+        QTest::newRow("alpha only") << LchaDouble {50, 40, 120, 0} << LchaDouble {50, 40, 120, 1};
+        QTest::newRow("alpha only out-of-gamut") << LchaDouble {50, 150, 0, 0.2} << LchaDouble {50, 150, 0, 0.9};
+        QTest::newRow("constant opaque") << LchaDouble {70, 20, 300, 1} << LchaDouble {70, 20, 300, 1};
+    }
+
+    void testBitIdenticalToReference()
+    {
+        QFETCH(LchaDouble, firstColor);
+        QFETCH(LchaDouble, secondColor);
+        GradientImage myGradient(m_rgbColorSpace);
+        myGradient.setGradientLength(120);
+        myGradient.setGradientThickness(7);
+        myGradient.setFirstColor(firstColor);
+        myGradient.setSecondColor(secondColor);
+        QCOMPARE(myGradient.getImage(), referenceImage(myGradient));
+        // Checkerboard squares that are not a divisor of the thickness
+        myGradient.setDevicePixelRatioF(1.5);
+        myGradient.setGradientThickness(40);
+        QCOMPARE(myGradient.getImage(), referenceImage(myGradient));
+    }
+
+    void testTransparencyRows()
+    {
+        GradientImage myGradient(m_rgbColorSpace);
+        myGradient.setGradientLength(50);
+        myGradient.setGradientThickness(10);
+        const QImage rows = myGradient.transparencyRows();
+        QCOMPARE(rows.size(), QSize(50, 2));
+        const int squareSize = transparencySquareSize(1);
+        // The rows are complementary.
+        QVERIFY(rows.pixel(0, 0) != rows.pixel(0, 1));
+        QCOMPARE(rows.pixel(0, 0), rows.pixel(squareSize, 1));
+        QCOMPARE(rows.pixel(squareSize, 0), rows.pixel(0, 1));
+        // Cached independently of the colors…
+        myGradient.setFirstColor(LchaDouble {30, 20, 10, 0.5});
+        QCOMPARE(myGradient.transparencyRows().cacheKey(), rows.cacheKey());
+        // …but not of the geometry.
+        myGradient.setGradientLength(60);
+        QCOMPARE(myGradient.transparencyRows().width(), 60);
+    }
+
+    void benchmarkGetImageAlphaOnly()
+    {
+        GradientImage myGradient(m_rgbColorSpace);
+        myGradient.setGradientLength(300);
+        myGradient.setGradientThickness(20);
+        // Measure the rendering, and not the shared cache.
+        const qint64 oldMaximumSize = SharedImageCache::maximumSize();
+        SharedImageCache::setMaximumSize(0);
+        qreal lightness = 0;
+        QBENCHMARK {
+            // A new color on each iteration, like the alpha
+            // slider of the color dialog gets.
+            lightness = (lightness >= 100) ? 0 : lightness + 1;
+            myGradient.setFirstColor(LchaDouble {lightness, 30, 40, 0});
+            myGradient.setSecondColor(LchaDouble {lightness, 30, 40, 1});
+            myGradient.getImage();
+        }
+        SharedImageCache::setMaximumSize(oldMaximumSize);
+    }
+
     void testColorFromValue()
     {
         GradientImage myGradient(m_rgbColorSpace);
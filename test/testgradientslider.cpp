@@ -375,6 +375,35 @@ private Q_SLOTS:
         testSlider.repaint();
     }
 
+    void testGradientImageGeometry()
+    {
+        GradientSlider testSlider(m_rgbColorSpace, Qt::Vertical);
+        testSlider.resize(30, 200);
+        testSlider.show();
+        testSlider.repaint();
+        const QImage image = testSlider.d_pointer->m_gradientImageCache.getImage();
+        QCOMPARE(image.width(), testSlider.d_pointer->physicalPixelLength());
+        QCOMPARE(image.height(), testSlider.d_pointer->physicalPixelThickness());
+        // Painting again must not render a new image.
+        testSlider.setValue(0.2);
+        testSlider.repaint();
+        QCOMPARE(testSlider.d_pointer->m_gradientImageCache.getImage().cacheKey(), image.cacheKey());
+    }
+
+    void benchmarkPaintEvent()
+    {
+        GradientSlider testSlider(m_rgbColorSpace, Qt::Horizontal);
+        testSlider.resize(400, 30);
+        testSlider.show();
+        qreal value = 0;
+        QBENCHMARK {
+            // Only the handle moves, like during a mouse drag.
+            value = (value >= 1) ? 0 : value + 0.01;
+            testSlider.setValue(value);
+            testSlider.repaint();
+        }
+    }
+
     void testVerySmallWidgetSizes()
     {
         // Also very small widget sizes should not crash the widget.
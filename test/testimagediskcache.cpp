@@ -0,0 +1,274 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "PerceptualColor/imagediskcache.h"
+
+#include <QtTest>
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "PerceptualColor/sharedimagecache.h"
+#include "chromahueimage.h"
+#include "chromalightnessimage.h"
+#include "colorwheelimage.h"
+
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+
+namespace PerceptualColor
+{
+class TestImageDiskCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestImageDiskCache(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    /** @brief An image with random, semi-transparent pixels.
+     *
+     * Random pixels cannot be compressed well, so the file size
+     * is predictable. */
+    static QImage randomImage(const quint32 seed)
+    {
+        QRandomGenerator generator(seed);
+        QImage result(64, 64, QImage::Format_ARGB32_Premultiplied);
+        for (int y = 0; y < result.height(); ++y) {
+            QRgb *line = reinterpret_cast<QRgb *>(result.scanLine(y));
+            for (int x = 0; x < result.width(); ++x) {
+                const int alpha = generator.bounded(256);
+                line[x] = qRgba(generator.bounded(alpha + 1), //
+                                generator.bounded(alpha + 1),
+                                generator.bounded(alpha + 1),
+                                alpha);
+            }
+        }
+        return result;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+        // Do not touch the real cache of the user.
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+        ImageDiskCache::clear();
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+        ImageDiskCache::clear();
+        ImageDiskCache::setEnabled(false);
+        ImageDiskCache::setMaximumSize(64 * 1024 * 1024);
+    }
+
+    void testDefaults()
+    {
+        QCOMPARE(ImageDiskCache::isEnabled(), false);
+        QCOMPARE(ImageDiskCache::maximumSize(), Q_INT64_C(64 * 1024 * 1024));
+        QVERIFY(!ImageDiskCache::directory().isEmpty());
+    }
+
+    void testSetters()
+    {
+        ImageDiskCache::setEnabled(true);
+        QCOMPARE(ImageDiskCache::isEnabled(), true);
+        ImageDiskCache::setMaximumSize(1000);
+        QCOMPARE(ImageDiskCache::maximumSize(), Q_INT64_C(1000));
+        ImageDiskCache::setMaximumSize(-1);
+        QCOMPARE(ImageDiskCache::maximumSize(), Q_INT64_C(0));
+    }
+
+    void testDisabled()
+    {
+        const QByteArray key = QByteArrayLiteral("key");
+        ImageDiskCache::store(key, randomImage(1));
+        QVERIFY(!QFileInfo::exists(ImageDiskCache::fileName(key)));
+        ImageDiskCache::setEnabled(true);
+        ImageDiskCache::store(key, randomImage(1));
+        ImageDiskCache::setEnabled(false);
+        QVERIFY(ImageDiskCache::load(key).isNull());
+    }
+
+    void testRoundTrip()
+    {
+        ImageDiskCache::setEnabled(true);
+        const QImage image = randomImage(2);
+        const QByteArray key = QByteArrayLiteral("key");
+        ImageDiskCache::store(key, image);
+        QVERIFY(QFileInfo::exists(ImageDiskCache::fileName(key)));
+        const QImage loaded = ImageDiskCache::load(key);
+        QCOMPARE(loaded.format(), QImage::Format_ARGB32_Premultiplied);
+        // Bit-identical, also for semi-transparent pixels:
+        QCOMPARE(loaded, image);
+        // Other keys are not found:
+        QVERIFY(ImageDiskCache::load(QByteArrayLiteral("other key")).isNull());
+    }
+
+    void testClear()
+    {
+        ImageDiskCache::setEnabled(true);
+        const QByteArray key = QByteArrayLiteral("key");
+        ImageDiskCache::store(key, randomImage(3));
+        ImageDiskCache::clear();
+        QVERIFY(ImageDiskCache::load(key).isNull());
+    }
+
+    void testLeastRecentlyUsed()
+    {
+        ImageDiskCache::setEnabled(true);
+        const QByteArray first = QByteArrayLiteral("first");
+        const QByteArray second = QByteArrayLiteral("second");
+        const QByteArray third = QByteArrayLiteral("third");
+        ImageDiskCache::store(first, randomImage(4));
+        const qint64 fileSize = QFileInfo(ImageDiskCache::fileName(first)).size();
+        QVERIFY(fileSize > 0);
+        // Enough for two files, but not for three.
+        ImageDiskCache::setMaximumSize(fileSize * 5 / 2);
+        // Make sure that the modification times differ.
+        QTest::qWait(50);
+        ImageDiskCache::store(second, randomImage(5));
+        QTest::qWait(50);
+        // Using “first” makes it more recently used than “second”.
+        QVERIFY(!ImageDiskCache::load(first).isNull());
+        QTest::qWait(50);
+        ImageDiskCache::store(third, randomImage(6));
+        QVERIFY(!ImageDiskCache::load(first).isNull());
+        QVERIFY(ImageDiskCache::load(second).isNull());
+        QVERIFY(!ImageDiskCache::load(third).isNull());
+    }
+
+    void testChromaHueImage()
+    {
+        ImageDiskCache::setEnabled(true);
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        ChromaHueImage image(colorSpace);
+        image.setImageSize(50);
+        image.setBorder(5);
+        image.setDevicePixelRatioF(1.25);
+        const QImage rendered = image.getImage();
+        QVERIFY(QFileInfo::exists(ImageDiskCache::fileName(image.cacheKey())));
+
+        // Make sure that the next image comes from the disk.
+        SharedImageCache::clear();
+        ChromaHueImage other(colorSpace);
+        other.setImageSize(50);
+        other.setBorder(5);
+        other.setDevicePixelRatioF(1.25);
+        QCOMPARE(other.cacheKey(), image.cacheKey());
+        const QImage loaded = other.getImage();
+        QCOMPARE(loaded, rendered);
+        QCOMPARE(loaded.devicePixelRatioF(), 1.25);
+
+        // Different parameters, different keys:
+        other.setLightness(30);
+        QVERIFY(other.cacheKey() != image.cacheKey());
+    }
+
+    void testChromaLightnessImage()
+    {
+        ImageDiskCache::setEnabled(true);
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        ChromaLightnessImage image(colorSpace);
+        image.setImageSize(QSize(40, 30));
+        image.setHue(120);
+        const QImage rendered = image.getImage();
+        // Make sure that the next image comes from the disk.
+        SharedImageCache::clear();
+        ChromaLightnessImage other(colorSpace);
+        other.setImageSize(QSize(40, 30));
+        other.setHue(120);
+        QCOMPARE(other.cacheKey(), image.cacheKey());
+        QCOMPARE(other.getImage(), rendered);
+        other.setHue(121);
+        QVERIFY(other.cacheKey() != image.cacheKey());
+    }
+
+    void testColorWheelImage()
+    {
+        ImageDiskCache::setEnabled(true);
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        ColorWheelImage image(colorSpace);
+        image.setImageSize(50);
+        image.setWheelThickness(10);
+        const QImage rendered = image.getImage();
+        // Make sure that the next image comes from the disk.
+        SharedImageCache::clear();
+        ColorWheelImage other(colorSpace);
+        other.setImageSize(50);
+        other.setWheelThickness(10);
+        QCOMPARE(other.cacheKey(), image.cacheKey());
+        QCOMPARE(other.getImage(), rendered);
+        other.setWheelThickness(11);
+        QVERIFY(other.cacheKey() != image.cacheKey());
+    }
+
+    void testProfileIdentifierIsStable()
+    {
+        // The sRGB profile is created in memory, with the current time
+        // as creation date. Nevertheless, the identifier (which is part
+        // of the cache key) must not change.
+        const auto first = RgbColorSpaceFactory::createSrgb();
+        QTest::qWait(1100);
+        const auto second = RgbColorSpaceFactory::createSrgb();
+        QCOMPARE(first->profileIdentifier(), second->profileIdentifier());
+        QVERIFY(!first->profileIdentifier().isEmpty());
+    }
+
+    void testSnippet()
+    {
+        //! [Enable]
+        PerceptualColor::ImageDiskCache::setEnabled(true);
+        //! [Enable]
+        QCOMPARE(ImageDiskCache::isEnabled(), true);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestImageDiskCache)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testimagediskcache.moc"
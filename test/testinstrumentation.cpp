@@ -0,0 +1,294 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "PerceptualColor/instrumentation.h"
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "PerceptualColor/sharedimagecache.h"
+#include "chromahueimage.h"
+#include "instrumentationscope.h"
+#include "rgbcolorspace.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtTest>
+
+#include <thread>
+
+namespace PerceptualColor
+{
+static void snippet01()
+{
+    //! [Instrumentation usage]
+    PerceptualColor::Instrumentation::setEnabled(true);
+    // … use the library …
+    const QMap<QString, quint64> counters = //
+        PerceptualColor::Instrumentation::counters();
+    PerceptualColor::Instrumentation::writeTrace( //
+        QStringLiteral("perceptualcolor-trace.json"));
+    //! [Instrumentation usage]
+    Q_UNUSED(counters)
+    QFile::remove(QStringLiteral("perceptualcolor-trace.json"));
+}
+
+static void snippet02()
+{
+    //! [InstrumentationScope usage]
+    {
+        const InstrumentationScope instrumentationScope("MyClass::myFunction");
+        // … do the work …
+    } // The scope is recorded here.
+    InstrumentationScope::count("My counter");
+    //! [InstrumentationScope usage]
+}
+
+class TestInstrumentation : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestInstrumentation(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+        Instrumentation::reset();
+        Instrumentation::setEnabled(true);
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+        Instrumentation::setEnabled(false);
+        Instrumentation::reset();
+    }
+
+    void testSnippet01()
+    {
+        snippet01();
+    }
+
+    void testSnippet02()
+    {
+        snippet02();
+        QCOMPARE(Instrumentation::eventCount(), 1);
+        QCOMPARE(Instrumentation::counters().value(QStringLiteral("My counter")), Q_UINT64_C(1));
+    }
+
+    void testDisabled()
+    {
+        Instrumentation::setEnabled(false);
+        QCOMPARE(Instrumentation::isEnabled(), false);
+        {
+            const InstrumentationScope scope("test");
+        }
+        InstrumentationScope::count("test");
+        QCOMPARE(Instrumentation::eventCount(), 0);
+        QVERIFY(Instrumentation::counters().isEmpty());
+    }
+
+    void testEnabledWhileScopeIsRunning()
+    {
+        Instrumentation::setEnabled(false);
+        {
+            const InstrumentationScope scope("test");
+            // Scopes that have started before enabling are not recorded.
+            Instrumentation::setEnabled(true);
+        }
+        QCOMPARE(Instrumentation::eventCount(), 0);
+    }
+
+    void testCounters()
+    {
+        InstrumentationScope::count("first");
+        InstrumentationScope::count("first", 4);
+        InstrumentationScope::count("second");
+        // Identical names at different addresses are merged.
+        const QByteArray copy("second");
+        InstrumentationScope::count(copy.constData());
+        const QMap<QString, quint64> counters = Instrumentation::counters();
+        QCOMPARE(counters.count(), 2);
+        QCOMPARE(counters.value(QStringLiteral("first")), Q_UINT64_C(5));
+        QCOMPARE(counters.value(QStringLiteral("second")), Q_UINT64_C(2));
+        Instrumentation::reset();
+        QVERIFY(Instrumentation::counters().isEmpty());
+    }
+
+    void testScopeDuration()
+    {
+        {
+            const InstrumentationScope scope("sleep");
+            QThread::msleep(20);
+        }
+        QCOMPARE(Instrumentation::eventCount(), 1);
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString fileName = directory.filePath(QStringLiteral("trace.json"));
+        QVERIFY(Instrumentation::writeTrace(fileName));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QJsonArray events = QJsonDocument::fromJson(file.readAll()).object().value(QStringLiteral("traceEvents")).toArray();
+        bool found = false;
+        for (const QJsonValue &value : events) {
+            const QJsonObject event = value.toObject();
+            if (event.value(QStringLiteral("name")).toString() == QStringLiteral("sleep")) {
+                found = true;
+                QCOMPARE(event.value(QStringLiteral("ph")).toString(), QStringLiteral("X"));
+                QVERIFY(event.value(QStringLiteral("dur")).toDouble() >= 19000);
+            }
+        }
+        QVERIFY(found);
+    }
+
+    void testWriteTrace()
+    {
+        {
+            const InstrumentationScope scope("scope");
+        }
+        InstrumentationScope::count("counter", 3);
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString fileName = directory.filePath(QStringLiteral("trace.json"));
+        QVERIFY(Instrumentation::writeTrace(fileName));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+        QCOMPARE(error.error, QJsonParseError::NoError);
+        const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+        int completeEvents = 0;
+        int counterEvents = 0;
+        for (const QJsonValue &value : events) {
+            const QJsonObject event = value.toObject();
+            const QString phase = event.value(QStringLiteral("ph")).toString();
+            if (phase == QStringLiteral("X")) {
+                ++completeEvents;
+                QCOMPARE(event.value(QStringLiteral("name")).toString(), QStringLiteral("scope"));
+                QVERIFY(event.contains(QStringLiteral("ts")));
+                QVERIFY(event.contains(QStringLiteral("dur")));
+                QVERIFY(event.contains(QStringLiteral("pid")));
+                QVERIFY(event.contains(QStringLiteral("tid")));
+            }
+            if (phase == QStringLiteral("C")) {
+                ++counterEvents;
+                QCOMPARE(event.value(QStringLiteral("name")).toString(), QStringLiteral("counter"));
+                QCOMPARE(event.value(QStringLiteral("args")).toObject().value(QStringLiteral("value")).toDouble(), 3.0);
+            }
+        }
+        QCOMPARE(completeEvents, 1);
+        QCOMPARE(counterEvents, 1);
+    }
+
+    void testWriteTraceInvalidFile()
+    {
+        QVERIFY(!Instrumentation::writeTrace(QStringLiteral("/nonexistingdirectory/trace.json")));
+    }
+
+    void testTraceFileName()
+    {
+        const QString oldFileName = Instrumentation::traceFileName();
+        Instrumentation::setTraceFileName(QStringLiteral("abc.json"));
+        QCOMPARE(Instrumentation::traceFileName(), QStringLiteral("abc.json"));
+        Instrumentation::setTraceFileName(oldFileName);
+    }
+
+    void testMultipleThreads()
+    {
+        std::thread worker([]() {
+            const InstrumentationScope scope("worker");
+            InstrumentationScope::count("worker counter");
+        });
+        worker.join();
+        {
+            const InstrumentationScope scope("main");
+        }
+        QCOMPARE(Instrumentation::eventCount(), 2);
+        QCOMPARE(Instrumentation::counters().value(QStringLiteral("worker counter")), Q_UINT64_C(1));
+    }
+
+    void testCountersOfMultipleThreadsAreMerged()
+    {
+        const auto countMany = []() {
+            for (int i = 0; i < 1000; ++i) {
+                InstrumentationScope::count("shared counter");
+            }
+        };
+        std::thread firstWorker(countMany);
+        std::thread secondWorker(countMany);
+        countMany();
+        firstWorker.join();
+        secondWorker.join();
+        QCOMPARE(Instrumentation::counters().value(QStringLiteral("shared counter")), Q_UINT64_C(3000));
+        // Resetting also clears the counters of finished threads.
+        Instrumentation::reset();
+        QVERIFY(Instrumentation::counters().isEmpty());
+    }
+
+    void testLibraryInstrumentation()
+    {
+        const qint64 oldMaximumSize = SharedImageCache::maximumSize();
+        SharedImageCache::setMaximumSize(0);
+        ChromaHueImage myImage(RgbColorSpaceFactory::createSrgb());
+        myImage.setImageSize(50);
+        myImage.getImage();
+        SharedImageCache::setMaximumSize(oldMaximumSize);
+        const QMap<QString, quint64> counters = Instrumentation::counters();
+        QVERIFY(counters.value(QStringLiteral("cmsDoTransform")) > 0);
+        QVERIFY(counters.value(QStringLiteral("SharedImageCache miss")) > 0);
+        // Color space creation and image generation are recorded.
+        QVERIFY(Instrumentation::eventCount() >= 2);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestInstrumentation)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testinstrumentation.moc"
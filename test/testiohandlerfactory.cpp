@@ -74,11 +74,21 @@ private Q_SLOTS:
         // Called after every test function
     }
 
+    void testExistingFile_data()
+    {
+        QTest::addColumn<bool>("memoryMapped");
+        QTest::newRow("buffered") << false;
+        QTest::newRow("memory-mapped") << true;
+    }
+
     void testExistingFile()
     {
+        QFETCH(bool, memoryMapped);
         cmsIOHANDLER *myHandler = IOHandlerFactory::createReadOnly( //
             nullptr,
-            QStringLiteral("../testbed/ascii-abcd.txt"));
+            QStringLiteral("../testbed/ascii-abcd.txt"),
+            memoryMapped ? IOHandlerFactory::FileAccess::MemoryMapped //
+                         : IOHandlerFactory::FileAccess::Buffered);
 
         QVERIFY(myHandler != nullptr);
         QCOMPARE(myHandler->ContextID, nullptr);
@@ -153,6 +163,112 @@ private Q_SLOTS:
         QCOMPARE(closeResult, true);
     }
 
+    void testFileAccess()
+    {
+        using Stream = IOHandlerFactory::Stream;
+        const QString fileName = QStringLiteral("../testbed/ascii-abcd.txt");
+
+        // Memory-mapped access is the default.
+        cmsIOHANDLER *myHandler = IOHandlerFactory::createReadOnly( //
+            nullptr,
+            fileName);
+        QVERIFY(myHandler != nullptr);
+        const Stream *myStream = static_cast<Stream *>(myHandler->stream);
+        QVERIFY(myStream->mappedData != nullptr);
+        QCOMPARE(myStream->size, 4);
+        QCOMPARE(myHandler->Close(myHandler), true);
+
+        myHandler = IOHandlerFactory::createReadOnly( //
+            nullptr,
+            fileName,
+            IOHandlerFactory::FileAccess::Buffered);
+        QVERIFY(myHandler != nullptr);
+        myStream = static_cast<Stream *>(myHandler->stream);
+        QVERIFY(myStream->mappedData == nullptr);
+        QCOMPARE(myHandler->Close(myHandler), true);
+    }
+
+    void testEmptyFile()
+    {
+        // Empty files cannot be mapped. Make sure that the fallback
+        // to buffered reads works.
+        QTemporaryFile myFile;
+        QVERIFY(myFile.open());
+        cmsIOHANDLER *myHandler = IOHandlerFactory::createReadOnly( //
+            nullptr,
+            myFile.fileName(),
+            IOHandlerFactory::FileAccess::MemoryMapped);
+        QVERIFY(myHandler != nullptr);
+        QCOMPARE(myHandler->ReportedSize, 0);
+        const auto myStream = static_cast<IOHandlerFactory::Stream *>( //
+            myHandler->stream);
+        QVERIFY(myStream->mappedData == nullptr);
+        QByteArray myByteArray(2, ' ');
+        QCOMPARE(myHandler->Read(myHandler, myByteArray.data(), 1, 2), 0);
+        QCOMPARE(myHandler->Close(myHandler), true);
+    }
+
+    void testMemoryMappedOverflow()
+    {
+        // size * count does not fit into cmsUInt32Number. This
+        // must not lead to an out-of-bound read.
+        cmsIOHANDLER *myHandler = IOHandlerFactory::createReadOnly( //
+            nullptr,
+            QStringLiteral("../testbed/ascii-abcd.txt"),
+            IOHandlerFactory::FileAccess::MemoryMapped);
+        QVERIFY(myHandler != nullptr);
+        QByteArray myByteArray(5, ' ');
+        const cmsUInt32Number readResult = myHandler->Read( //
+            myHandler,
+            myByteArray.data(),
+            0x10000,
+            0x10000);
+        QCOMPARE(readResult, 0);
+        QCOMPARE(myByteArray, QByteArrayLiteral("     "));
+        QCOMPARE(myHandler->Tell(myHandler), 0);
+        QCOMPARE(myHandler->Close(myHandler), true);
+    }
+
+    void testMemory()
+    {
+        const QByteArray data = QByteArrayLiteral("abcd");
+        cmsIOHANDLER *myHandler = IOHandlerFactory::createReadOnly(nullptr, data);
+        QVERIFY(myHandler != nullptr);
+        QCOMPARE(myHandler->ReportedSize, 4);
+        // The data is read in place, without a copy:
+        const auto myStream = static_cast<IOHandlerFactory::Stream *>( //
+            myHandler->stream);
+        QVERIFY(reinterpret_cast<const char *>(myStream->mappedData) //
+                == data.constData());
+
+        QByteArray myByteArray(5, ' ');
+        QCOMPARE(myHandler->Read(myHandler, myByteArray.data(), 1, 3), 3);
+        QCOMPARE(myByteArray, QByteArrayLiteral("abc  "));
+        QCOMPARE(myHandler->Tell(myHandler), 3);
+        myByteArray.fill(' ');
+        QCOMPARE(myHandler->Read(myHandler, myByteArray.data(), 1, 2), 0);
+        QCOMPARE(myByteArray, QByteArrayLiteral("     "));
+        QCOMPARE(myHandler->Seek(myHandler, 1), true);
+        QCOMPARE(myHandler->Read(myHandler, myByteArray.data(), 2, 1), 1);
+        QCOMPARE(myByteArray, QByteArrayLiteral("bc   "));
+        QCOMPARE(myHandler->Close(myHandler), true);
+    }
+
+    void testMemoryKeepsDataAlive()
+    {
+        QByteArray data = QByteArrayLiteral("abcd");
+        cmsIOHANDLER *myHandler = IOHandlerFactory::createReadOnly(nullptr, data);
+        QVERIFY(myHandler != nullptr);
+        // The handler has a shallow copy. Modifying the original
+        // detaches the original, not the handler’s copy.
+        data.fill('x');
+        data.clear();
+        QByteArray myByteArray(4, ' ');
+        QCOMPARE(myHandler->Read(myHandler, myByteArray.data(), 1, 4), 4);
+        QCOMPARE(myByteArray, QByteArrayLiteral("abcd"));
+        QCOMPARE(myHandler->Close(myHandler), true);
+    }
+
     void testNonExisting()
     {
         cmsIOHANDLER *myHandler = IOHandlerFactory::createReadOnly( //
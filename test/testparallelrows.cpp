@@ -0,0 +1,153 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "parallelrows.h"
+
+#include <QtTest>
+
+namespace PerceptualColor
+{
+class TestParallelRows : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestParallelRows(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testEachRowExactlyOnce_data()
+    {
+        QTest::addColumn<int>("rowCount");
+        QTest::addColumn<int>("threadCount");
+        QTest::newRow("0 rows") << 0 << 4;
+        QTest::newRow("1 row, 1 thread") << 1 << 1;
+        QTest::newRow("1 row, 4 threads") << 1 << 4;
+        QTest::newRow("100 rows, 0 threads") << 100 << 0;
+        QTest::newRow("100 rows, 1 thread") << 100 << 1;
+        QTest::newRow("100 rows, 2 threads") << 100 << 2;
+        QTest::newRow("1000 rows, 16 threads") << 1000 << 16;
+        QTest::newRow("3 rows, 64 threads") << 3 << 64;
+    }
+
+    void testEachRowExactlyOnce()
+    {
+        QFETCH(int, rowCount);
+        QFETCH(int, threadCount);
+        // Each row writes only to its own element, so no
+        // synchronization is necessary.
+        QVector<int> callCount(rowCount, 0);
+        int *data = callCount.data();
+        ParallelRows::forEachRow(rowCount, threadCount, [data](const int row) {
+            ++data[row];
+        });
+        for (int row = 0; row < rowCount; ++row) {
+            QCOMPARE(callCount.at(row), 1);
+        }
+    }
+
+    void testSequentialOrder()
+    {
+        // With only one thread, the rows are processed in ascending order.
+        QVector<int> order;
+        ParallelRows::forEachRow(10, 1, [&order](const int row) {
+            order.append(row);
+        });
+        QCOMPARE(order, (QVector<int> {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    }
+
+    void testNestedCalls()
+    {
+        // Nested calls must not dead-lock, even if the thread pool
+        // is completely busy.
+        QVector<int> result(50, 0);
+        int *data = result.data();
+        ParallelRows::forEachRow(50, QThread::idealThreadCount() * 2, [data](const int row) {
+            QAtomicInt sum {0};
+            ParallelRows::forEachRow(20, QThread::idealThreadCount() * 2, [&sum](const int innerRow) {
+                sum.fetchAndAddRelaxed(innerRow);
+            });
+            data[row] = row + sum.loadAcquire();
+        });
+        for (int row = 0; row < 50; ++row) {
+            QCOMPARE(result.at(row), row + 190);
+        }
+    }
+
+    void testSnippet()
+    {
+        //! [ParallelRows usage]
+        QImage image(100, 50, QImage::Format_ARGB32_Premultiplied);
+        // Make sure the image is detached before the threads start.
+        uchar *const bits = image.bits();
+        const int bytesPerLine = image.bytesPerLine();
+        ParallelRows::forEachRow( //
+            image.height(),
+            QThread::idealThreadCount(),
+            [bits, bytesPerLine](const int y) {
+                QRgb *line = reinterpret_cast<QRgb *>(bits + y * bytesPerLine);
+                for (int x = 0; x < 100; ++x) {
+                    line[x] = qRgb(x, y, 0);
+                }
+            });
+        //! [ParallelRows usage]
+        QCOMPARE(image.pixelColor(10, 20), QColor(10, 20, 0));
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestParallelRows)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testparallelrows.moc"
@@ -33,9 +33,15 @@
 // Second, the private implementation.
 #include "rgbcolorspace_p.h"
 
+#include <QSemaphore>
 #include <QtTest>
 
+#include "PerceptualColor/instrumentation.h"
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "helper.h"
+#include "lchvalues.h"
+
+#include <thread>
 
 namespace PerceptualColor
 {
@@ -97,6 +103,602 @@ private Q_SLOTS:
         QCOMPARE(nearestInGamutColor.c, 0);
         QCOMPARE(nearestInGamutColor.h, 10);
     }
+
+    void testNearestInGamutColorByAdjustingChromaLightnessIsInGamut()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        LchDouble color;
+        // The hue is the outer loop, because changing
+        // the hue means calculating a new gamut slice.
+        for (int h = 0; h < 360; h += 15) {
+            for (int l = 0; l <= 100; l += 5) {
+                for (int c = 0; c <= 150; c += 10) {
+                    color.l = l;
+                    color.c = c;
+                    color.h = h;
+                    const LchDouble result = myColorSpace->nearestInGamutColorByAdjustingChromaLightness(color);
+                    QVERIFY(myColorSpace->isInGamut(result));
+                    QCOMPARE(result.h, color.h);
+                }
+            }
+        }
+        // Also out-of-range values get an in-gamut result:
+        const LchDouble result = myColorSpace->nearestInGamutColorByAdjustingChromaLightness(LchDouble {150, 300, 10});
+        QVERIFY(myColorSpace->isInGamut(result));
+    }
+
+    void benchmarkNearestInGamutColorByAdjustingChromaLightness()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        LchDouble color {50, 150, 10};
+        // Calculate the gamut slice outside of the benchmark.
+        myColorSpace->nearestInGamutColorByAdjustingChromaLightness(color);
+        QBENCHMARK {
+            for (int l = 0; l <= 100; ++l) {
+                color.l = l;
+                myColorSpace->nearestInGamutColorByAdjustingChromaLightness(color);
+            }
+        }
+    }
+
+    void testGamutSliceCache()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        QCOMPARE(myColorSpace->gamutSliceCacheBudget(), //
+                 RgbColorSpace::RgbColorSpacePrivate::defaultGamutSliceCacheBudget);
+        QCOMPARE(myColorSpace->gamutSliceCacheHits(), Q_UINT64_C(0));
+        QCOMPARE(myColorSpace->gamutSliceCacheMisses(), Q_UINT64_C(0));
+
+        // Out-of-gamut colors, so that a gamut slice is actually needed:
+        const LchDouble first {50, 150, 10};
+        const LchDouble second {50, 150, 250};
+
+        // Alternating between two hues: Both fit into the cache.
+        for (int i = 0; i < 3; ++i) {
+            myColorSpace->nearestInGamutColorByAdjustingChromaLightness(first);
+            myColorSpace->nearestInGamutColorByAdjustingChromaLightness(second);
+        }
+        QCOMPARE(myColorSpace->gamutSliceCacheMisses(), Q_UINT64_C(2));
+        QCOMPARE(myColorSpace->gamutSliceCacheHits(), Q_UINT64_C(4));
+
+        // Hues that differ by less than the quantization share a slice.
+        LchDouble nearlyFirst = first;
+        nearlyFirst.h += 0.001;
+        myColorSpace->nearestInGamutColorByAdjustingChromaLightness(nearlyFirst);
+        QCOMPARE(myColorSpace->gamutSliceCacheMisses(), Q_UINT64_C(2));
+        QCOMPARE(myColorSpace->gamutSliceCacheHits(), Q_UINT64_C(5));
+
+        // Budget for a single slice: Alternating hues evict each other.
+        const int sliceSize = myColorSpace->d_pointer->gamutSlice(first.h)->sizeInBytes();
+        myColorSpace->setGamutSliceCacheBudget(sliceSize);
+        QCOMPARE(myColorSpace->gamutSliceCacheBudget(), sliceSize);
+        const quint64 missesBefore = myColorSpace->gamutSliceCacheMisses();
+        myColorSpace->nearestInGamutColorByAdjustingChromaLightness(second);
+        myColorSpace->nearestInGamutColorByAdjustingChromaLightness(first);
+        myColorSpace->nearestInGamutColorByAdjustingChromaLightness(second);
+        QCOMPARE(myColorSpace->gamutSliceCacheMisses(), missesBefore + 3);
+
+        // Budget 0 disables the cache, but results stay correct.
+        myColorSpace->setGamutSliceCacheBudget(0);
+        QCOMPARE(myColorSpace->gamutSliceCacheBudget(), 0);
+        const quint64 hitsBefore = myColorSpace->gamutSliceCacheHits();
+        const LchDouble result = myColorSpace->nearestInGamutColorByAdjustingChromaLightness(first);
+        myColorSpace->nearestInGamutColorByAdjustingChromaLightness(first);
+        QCOMPARE(myColorSpace->gamutSliceCacheHits(), hitsBefore);
+        QVERIFY(myColorSpace->isInGamut(result));
+
+        // Negative budgets are treated as 0.
+        myColorSpace->setGamutSliceCacheBudget(-1);
+        QCOMPARE(myColorSpace->gamutSliceCacheBudget(), 0);
+    }
+
+    void testGamutSliceKey()
+    {
+        using Private = RgbColorSpace::RgbColorSpacePrivate;
+        QCOMPARE(Private::gamutSliceKey(0), 0);
+        QCOMPARE(Private::gamutSliceKey(10), 10 * Private::gamutSliceHueResolution);
+        QCOMPARE(Private::gamutSliceKey(370), 10 * Private::gamutSliceHueResolution);
+        QCOMPARE(Private::gamutSliceKey(-10), 350 * Private::gamutSliceHueResolution);
+        // Values that round up to 360° are wrapped to 0°.
+        QCOMPARE(Private::gamutSliceKey(359.9999), 0);
+    }
+
+    void testToRgbUnboundBatch()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const QVector<LchDouble> lchBuffer = lchTestColors();
+        const int count = lchBuffer.count();
+        QVector<RgbDouble> rgbBuffer(count);
+        QVector<bool> isInGamutBuffer(count);
+        myColorSpace->toRgbUnbound(lchBuffer.constData(), rgbBuffer.data(), isInGamutBuffer.data(), count);
+        QColor expected;
+        int inGamutCount = 0;
+        for (int i = 0; i < count; ++i) {
+            expected = myColorSpace->toQColorRgbUnbound(lchBuffer.at(i));
+            QCOMPARE(isInGamutBuffer.at(i), expected.isValid());
+            if (isInGamutBuffer.at(i)) {
+                ++inGamutCount;
+                QCOMPARE(QColor::fromRgbF(rgbBuffer.at(i).red, //
+                                          rgbBuffer.at(i).green,
+                                          rgbBuffer.at(i).blue),
+                         expected);
+            }
+        }
+        // Make sure the test data covers both, in-gamut and
+        // out-of-gamut colors.
+        QVERIFY(inGamutCount > 0);
+        QVERIFY(inGamutCount < count);
+    }
+
+    void testToRgbBoundBatch()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const QVector<LchDouble> lchBuffer = lchTestColors();
+        const int count = lchBuffer.count();
+        QVector<RgbDouble> rgbBuffer(count);
+        myColorSpace->toRgbBound(lchBuffer.constData(), rgbBuffer.data(), count);
+        for (int i = 0; i < count; ++i) {
+            QCOMPARE(QColor::fromRgbF(rgbBuffer.at(i).red, //
+                                      rgbBuffer.at(i).green,
+                                      rgbBuffer.at(i).blue),
+                     myColorSpace->toQColorRgbBound(lchBuffer.at(i)));
+        }
+    }
+
+    void testBatchEmpty()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        // Must not crash, also with nullptr buffers:
+        myColorSpace->toRgbBound(static_cast<const LchDouble *>(nullptr), nullptr, 0);
+        myColorSpace->toRgbBound(static_cast<const cmsCIELab *>(nullptr), nullptr, 0);
+        myColorSpace->toRgbUnbound(static_cast<const LchDouble *>(nullptr), nullptr, nullptr, 0);
+        myColorSpace->toRgbUnbound(static_cast<const cmsCIELab *>(nullptr), nullptr, nullptr, -1);
+    }
+
+    void benchmarkToQColorRgbUnboundSingle()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const QVector<LchDouble> lchBuffer = lchTestColors();
+        QColor color;
+        QBENCHMARK {
+            for (const LchDouble &lch : lchBuffer) {
+                color = myColorSpace->toQColorRgbUnbound(lch);
+            }
+        }
+        Q_UNUSED(color)
+    }
+
+    void benchmarkToRgbUnboundBatch()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const QVector<LchDouble> lchBuffer = lchTestColors();
+        const int count = lchBuffer.count();
+        QVector<RgbDouble> rgbBuffer(count);
+        QVector<bool> isInGamutBuffer(count);
+        QBENCHMARK {
+            myColorSpace->toRgbUnbound(lchBuffer.constData(), rgbBuffer.data(), isInGamutBuffer.data(), count);
+        }
+    }
+
+    void testConcurrentUse()
+    {
+        // Stress test: Many threads use the same color space object at
+        // the same time. The results must be identical to the results
+        // of a single thread.
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        QVector<LchDouble> input;
+        LchDouble color;
+        for (int i = 0; i < 200; ++i) {
+            // Pseudo-random, but deterministic values,
+            // both in-gamut and out-of-gamut. Only two different hues
+            // to limit the workload of the nearest-neighbor search.
+            color.l = (i * 37) % 101;
+            color.c = (i * 53) % 151;
+            color.h = (i < 100) ? 10 : 250;
+            input.append(color);
+        }
+        const QVector<ConversionResult> expected = convert(*myColorSpace, input);
+
+        constexpr int taskCount = 16;
+        QThreadPool pool;
+        pool.setMaxThreadCount(16);
+        QAtomicInt mismatchCount {0};
+        for (int i = 0; i < taskCount; ++i) {
+            pool.start(new ConversionTask(myColorSpace.data(), &input, &expected, &mismatchCount));
+        }
+        pool.waitForDone();
+        QCOMPARE(mismatchCount.loadAcquire(), 0);
+    }
+
+    void testDestroyWhileThreadsAlive()
+    {
+        // A color space might be destroyed while threads that have used
+        // it are still running. Their resources are released
+        // immediately, and new color spaces must not be confused with
+        // the old one.
+        QThreadPool pool;
+        pool.setMaxThreadCount(4);
+        pool.setExpiryTimeout(-1); // Keep the threads alive
+        const QVector<LchDouble> input {LchDouble {50, 20, 10}, LchDouble {50, 200, 10}};
+        for (int i = 0; i < 3; ++i) {
+            QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+            const QVector<ConversionResult> expected = convert(*myColorSpace, input);
+            QAtomicInt mismatchCount {0};
+            for (int j = 0; j < 8; ++j) {
+                pool.start(new ConversionTask(myColorSpace.data(), &input, &expected, &mismatchCount));
+            }
+            pool.waitForDone();
+            QCOMPARE(mismatchCount.loadAcquire(), 0);
+        }
+    }
+
+    void testThreadLocalRegistryIsPruned()
+    {
+        // A long-lived thread must not collect the entries of color
+        // spaces that have been destroyed by another thread.
+        QSharedPointer<PerceptualColor::RgbColorSpace> first = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const quint64 firstSerialNumber = first->d_pointer->m_serialNumber;
+        QSemaphore firstUsed;
+        QSemaphore firstDestroyed;
+        bool containsBefore = false;
+        bool containsAfter = true;
+        std::thread worker([&]() {
+            first->isInGamut(LchDouble {50, 20, 10});
+            containsBefore = RgbColorSpace::RgbColorSpacePrivate::threadLocalRegistry().contains(firstSerialNumber);
+            firstUsed.release();
+            firstDestroyed.acquire();
+            QSharedPointer<PerceptualColor::RgbColorSpace> second = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+            second->isInGamut(LchDouble {50, 20, 10});
+            containsAfter = RgbColorSpace::RgbColorSpacePrivate::threadLocalRegistry().contains(firstSerialNumber);
+        });
+        firstUsed.acquire();
+        first.reset();
+        firstDestroyed.release();
+        worker.join();
+        QVERIFY(containsBefore);
+        QVERIFY(!containsAfter);
+    }
+
+    void testNearestInGamutColorByAdjustingChromaLightnessIsConst()
+    {
+        const QSharedPointer<const PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const LchDouble result = myColorSpace->nearestInGamutColorByAdjustingChromaLightness(LchDouble {50, 200, 10});
+        QVERIFY(myColorSpace->isInGamut(result));
+    }
+
+    void testMaximumChromaTable()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const auto &table = myColorSpace->d_pointer->m_maximumChromaTable;
+        QCOMPARE(table.count(),
+                 RgbColorSpace::RgbColorSpacePrivate::maximumChromaTableLightnessCount //
+                     * RgbColorSpace::RgbColorSpacePrivate::maximumChromaTableHueCount);
+        // Test values exactly on the grid, and values between the grid.
+        for (qreal l = 0; l <= 100; l += 2.5) {
+            for (qreal h = 0; h < 360; h += 7.25) {
+                const qreal expected = maximumChromaByBisection(*myColorSpace, l, h);
+                const qreal interpolated = myColorSpace->d_pointer->interpolatedMaximumChroma(l, h);
+                QVERIFY2(qAbs(interpolated - expected) < maximumChromaTableTolerance, //
+                         qPrintable(QStringLiteral("l=%1 h=%2 expected=%3 actual=%4").arg(l).arg(h).arg(expected).arg(interpolated)));
+                const qreal refined = myColorSpace->d_pointer->refinedMaximumChroma(l, h);
+                QVERIFY2(qAbs(refined - expected) <= 2 * gamutPrecision, //
+                         qPrintable(QStringLiteral("l=%1 h=%2 expected=%3 actual=%4").arg(l).arg(h).arg(expected).arg(refined)));
+            }
+        }
+    }
+
+    void testRefinedMaximumChromaNeedsFewConversions()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        myColorSpace->precalculate();
+        const bool wasEnabled = Instrumentation::isEnabled();
+        Instrumentation::setEnabled(true);
+        const QString counterName = QStringLiteral("cmsDoTransform");
+        Instrumentation::reset();
+        for (qreal l = 5; l <= 95; l += 2.5) {
+            for (qreal h = 0; h < 360; h += 7.25) {
+                myColorSpace->d_pointer->refinedMaximumChroma(l, h);
+            }
+        }
+        const quint64 refinedCount = Instrumentation::counters().value(counterName);
+        Instrumentation::reset();
+        for (qreal l = 5; l <= 95; l += 2.5) {
+            for (qreal h = 0; h < 360; h += 7.25) {
+                maximumChromaByBisection(*myColorSpace, l, h);
+            }
+        }
+        const quint64 bisectionCount = Instrumentation::counters().value(counterName);
+        Instrumentation::reset();
+        Instrumentation::setEnabled(wasEnabled);
+        QVERIFY2(refinedCount * 4 < bisectionCount * 3, //
+                 qPrintable(QStringLiteral("refined=%1 bisection=%2").arg(refinedCount).arg(bisectionCount)));
+    }
+
+    void testMaximumChromaTableIsLazy()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const auto &ready = myColorSpace->d_pointer->m_maximumChromaCellRowReady;
+        QCOMPARE(ready.count(), RgbColorSpace::RgbColorSpacePrivate::maximumChromaTableLightnessCount - 1);
+        for (int i = 0; i < ready.count(); ++i) {
+            QCOMPARE(ready.at(i).loadAcquire(), 0);
+        }
+        myColorSpace->d_pointer->interpolatedMaximumChroma(50.5, 10);
+        for (int i = 0; i < ready.count(); ++i) {
+            QCOMPARE(ready.at(i).loadAcquire(), (i == 50) ? 1 : 0);
+        }
+        const auto &rowReady = myColorSpace->d_pointer->m_maximumChromaRowReady;
+        for (int i = 0; i < rowReady.count(); ++i) {
+            QCOMPARE(rowReady.at(i), (i == 50) || (i == 51));
+        }
+    }
+
+    void testPrecalculate()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const auto &ready = myColorSpace->d_pointer->m_maximumChromaCellRowReady;
+        constexpr int totalSteps = RgbColorSpace::RgbColorSpacePrivate::maximumChromaTableLightnessCount - 1;
+
+        // Abort after three steps:
+        int callCount = 0;
+        const auto abortingCallback = [&callCount](const int finishedSteps, const int) {
+            ++callCount;
+            return finishedSteps < 3;
+        };
+        QCOMPARE(myColorSpace->precalculate(abortingCallback), false);
+        QCOMPARE(callCount, 3);
+        QCOMPARE(ready.at(2).loadAcquire(), 1);
+        QCOMPARE(ready.at(3).loadAcquire(), 0);
+
+        // Run until the end:
+        callCount = 0;
+        int lastFinishedSteps = 0;
+        const auto callback = [&callCount, &lastFinishedSteps](const int finishedSteps, const int) {
+            ++callCount;
+            lastFinishedSteps = finishedSteps;
+            return true;
+        };
+        QCOMPARE(myColorSpace->precalculate(callback), true);
+        QCOMPARE(callCount, totalSteps);
+        QCOMPARE(lastFinishedSteps, totalSteps);
+        for (int i = 0; i < ready.count(); ++i) {
+            QCOMPARE(ready.at(i).loadAcquire(), 1);
+        }
+
+        // Without callback:
+        QCOMPARE(myColorSpace->precalculate(), true);
+    }
+
+    void testGrayAxisBoundaries()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const qreal blackpoint = myColorSpace->d_pointer->m_blackpointL;
+        const qreal whitepoint = myColorSpace->d_pointer->m_whitepointL;
+        QVERIFY(blackpoint >= 0);
+        QVERIFY(blackpoint < 1);
+        QVERIFY(whitepoint > 99);
+        QVERIFY(whitepoint <= 100);
+        QVERIFY(myColorSpace->isInGamut(LchDouble {blackpoint, 0, 0}));
+        QVERIFY(myColorSpace->isInGamut(LchDouble {whitepoint, 0, 0}));
+        // The boundaries are precise:
+        if (blackpoint > 0) {
+            QVERIFY(!myColorSpace->isInGamut(LchDouble {blackpoint - 2 * gamutPrecision, 0, 0}));
+        }
+        if (whitepoint < 100) {
+            QVERIFY(!myColorSpace->isInGamut(LchDouble {whitepoint + 2 * gamutPrecision, 0, 0}));
+        }
+    }
+
+    void benchmarkCreateSrgb()
+    {
+        QBENCHMARK {
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        }
+    }
+
+    void benchmarkNearestInGamutColorByAdjustingChroma()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        // Measure the clamping, and not the lazy table calculation.
+        myColorSpace->precalculate();
+        QBENCHMARK {
+            for (qreal h = 0; h < 360; h += 7.25) {
+                myColorSpace->nearestInGamutColorByAdjustingChroma(LchDouble {50, 150, h});
+            }
+        }
+    }
+
+    void benchmarkNearestInGamutColorByAdjustingChromaBaseline()
+    {
+        // The bisection over the whole chroma range, as it was done
+        // before the maximum chroma table was introduced.
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        QBENCHMARK {
+            for (qreal h = 0; h < 360; h += 7.25) {
+                LchDouble lower {50, 0, h};
+                LchDouble upper {50, 150, h};
+                LchDouble candidate = upper;
+                while (upper.c - lower.c > gamutPrecision) {
+                    candidate.c = (lower.c + upper.c) / 2;
+                    if (myColorSpace->isInGamut(candidate)) {
+                        lower = candidate;
+                    } else {
+                        upper = candidate;
+                    }
+                }
+            }
+        }
+    }
+
+    void benchmarkTimeToFirstConversion()
+    {
+        // Time from the creation of the color space to the first
+        // conversion, as it happens when a widget is shown.
+        QBENCHMARK {
+            QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+            myColorSpace->toQColorRgbBound(LchDouble {50, 20, 10});
+        }
+    }
+
+    void testNearestInGamutColorByAdjustingChroma()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        LchDouble color;
+        LchDouble result;
+        for (qreal l = 5; l <= 95; l += 2.5) {
+            for (qreal h = 0; h < 360; h += 7.25) {
+                color.l = l;
+                color.c = 150;
+                color.h = h;
+                result = myColorSpace->nearestInGamutColorByAdjustingChroma(color);
+                QVERIFY(myColorSpace->isInGamut(result));
+                QCOMPARE(result.l, color.l);
+                QCOMPARE(result.h, color.h);
+                const qreal expected = maximumChromaByBisection(*myColorSpace, l, h);
+                QVERIFY(result.c <= expected + gamutPrecision);
+                QVERIFY(result.c >= expected - 2 * gamutPrecision);
+            }
+        }
+
+        // In-gamut colors should not be changed.
+        color.l = 50;
+        color.c = 20;
+        color.h = 10;
+        result = myColorSpace->nearestInGamutColorByAdjustingChroma(color);
+        QVERIFY(result.hasSameCoordinates(color));
+
+        // Gray out-of-gamut: The nearest gray is used.
+        color.l = 150;
+        color.c = 20;
+        color.h = 10;
+        result = myColorSpace->nearestInGamutColorByAdjustingChroma(color);
+        QCOMPARE(result.l, myColorSpace->d_pointer->m_whitepointL);
+        QCOMPARE(result.c, 0);
+        color.l = -50;
+        result = myColorSpace->nearestInGamutColorByAdjustingChroma(color);
+        QCOMPARE(result.l, myColorSpace->d_pointer->m_blackpointL);
+        QCOMPARE(result.c, 0);
+    }
+
+    void benchmarkNearestInGamutColorByAdjustingChroma()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const QVector<LchDouble> colors = lchTestColors();
+        QBENCHMARK {
+            for (const LchDouble &color : colors) {
+                myColorSpace->nearestInGamutColorByAdjustingChroma(color);
+            }
+        }
+    }
+
+private:
+    /** @brief Tolerance of the interpolated maximum chroma compared
+     * to the exact value.
+     *
+     * Near the edges and cusps of the gamut body, bilinear interpolation
+     * cannot be exact. */
+    static constexpr qreal maximumChromaTableTolerance = 3;
+
+    /** @brief Maximum in-gamut chroma, found by a bisection search over
+     * the whole chroma range. This is the reference for the tests. */
+    static qreal maximumChromaByBisection(const RgbColorSpace &colorSpace, const qreal l, const qreal h)
+    {
+        LchDouble lower {l, 0, h};
+        LchDouble upper {l, LchValues::humanMaximumChroma, h};
+        if (!colorSpace.isInGamut(lower)) {
+            return 0;
+        }
+        if (colorSpace.isInGamut(upper)) {
+            return upper.c;
+        }
+        LchDouble candidate = lower;
+        while (upper.c - lower.c > gamutPrecision) {
+            candidate.c = (lower.c + upper.c) / 2;
+            if (colorSpace.isInGamut(candidate)) {
+                lower = candidate;
+            } else {
+                upper = candidate;
+            }
+        }
+        return lower.c;
+    }
+
+    /** @brief Results of various conversions of a single color. */
+    struct ConversionResult {
+        bool isInGamut;
+        QColor bound;
+        QColor unbound;
+        LchDouble nearest;
+        LchDouble roundTrip;
+    };
+
+    /** @brief Converts a list of colors with various functions. */
+    static QVector<ConversionResult> convert(const RgbColorSpace &colorSpace, const QVector<LchDouble> &input)
+    {
+        QVector<ConversionResult> result;
+        ConversionResult temp;
+        for (const LchDouble &color : input) {
+            temp.isInGamut = colorSpace.isInGamut(color);
+            temp.bound = colorSpace.toQColorRgbBound(color);
+            temp.unbound = colorSpace.toQColorRgbUnbound(color);
+            temp.nearest = colorSpace.nearestInGamutColorByAdjustingChromaLightness(color);
+            temp.roundTrip = colorSpace.toLch(temp.bound);
+            result.append(temp);
+        }
+        return result;
+    }
+
+    /** @brief Task for the stress test that compares the conversion
+     * results with the expected results. */
+    class ConversionTask : public QRunnable
+    {
+    public:
+        ConversionTask(const RgbColorSpace *colorSpace, const QVector<LchDouble> *input, const QVector<ConversionResult> *expected, QAtomicInt *mismatchCount)
+            : m_colorSpace(colorSpace)
+            , m_input(input)
+            , m_expected(expected)
+            , m_mismatchCount(mismatchCount)
+        {
+        }
+        virtual void run() override
+        {
+            const QVector<ConversionResult> actual = convert(*m_colorSpace, *m_input);
+            for (int i = 0; i < actual.count(); ++i) {
+                const ConversionResult &a = actual.at(i);
+                const ConversionResult &e = m_expected->at(i);
+                if ((a.isInGamut != e.isInGamut)                         //
+                    || (a.bound != e.bound)                              //
+                    || (a.unbound != e.unbound)                          //
+                    || (!a.nearest.hasSameCoordinates(e.nearest))        //
+                    || (!a.roundTrip.hasSameCoordinates(e.roundTrip))) { //
+                    m_mismatchCount->fetchAndAddOrdered(1);
+                }
+            }
+        }
+
+    private:
+        const RgbColorSpace *m_colorSpace;
+        const QVector<LchDouble> *m_input;
+        const QVector<ConversionResult> *m_expected;
+        QAtomicInt *m_mismatchCount;
+    };
+
+    /** @brief A grid of LCh colors, both in-gamut and out-of-gamut. */
+    static QVector<LchDouble> lchTestColors()
+    {
+        QVector<LchDouble> result;
+        LchDouble color;
+        for (int l = 0; l <= 100; l += 5) {
+            for (int c = 0; c <= 150; c += 10) {
+                for (int h = 0; h < 360; h += 15) {
+                    color.l = l;
+                    color.c = c;
+                    color.h = h;
+                    result.append(color);
+                }
+            }
+        }
+        return result;
+    }
 };
 
 } // namespace PerceptualColor
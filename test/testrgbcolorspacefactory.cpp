@@ -33,10 +33,17 @@
 
 #include <QtTest>
 
+#include <QFutureWatcher>
+#include <QProgressBar>
+
 #include "PerceptualColor/chromahuediagram.h"
 #include "PerceptualColor/colorwheel.h"
 #include "rgbcolorspace.h"
 
+#include <lcms2.h>
+
+#include <thread>
+
 static void snippet01()
 {
     //! [Create]
@@ -60,8 +67,65 @@ static void snippet01()
     delete myWheel;
 }
 
+static void snippet02()
+{
+    //! [Async]
+    QProgressBar *myProgressBar = new QProgressBar;
+    auto *myWatcher = new QFutureWatcher<QSharedPointer<PerceptualColor::RgbColorSpace>>(myProgressBar);
+    QObject::connect(myWatcher, &QFutureWatcherBase::progressRangeChanged, myProgressBar, &QProgressBar::setRange);
+    QObject::connect(myWatcher, &QFutureWatcherBase::progressValueChanged, myProgressBar, &QProgressBar::setValue);
+    QObject::connect(myWatcher, &QFutureWatcherBase::finished, myProgressBar, [myWatcher, myProgressBar]() {
+        if (myWatcher->isCanceled()) {
+            return;
+        }
+        // Now the color space object is ready:
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace = myWatcher->result();
+        if (!myColorSpace.isNull()) {
+            myProgressBar->setFormat(myColorSpace->profileInfoDescription());
+        }
+    });
+    // This call returns immediately:
+    myWatcher->setFuture(PerceptualColor::RgbColorSpaceFactory::createSrgbAsync());
+    //! [Async]
+
+    myWatcher->waitForFinished();
+    delete myProgressBar;
+}
+
 namespace PerceptualColor
 {
+/** @brief Creates an RGB profile file with sRGB primaries.
+ *
+ * @param fileName The file name of the new profile
+ * @param gamma The gamma of the tone curves
+ * @returns <tt>true</tt> on success, <tt>false</tt> otherwise. */
+static bool createProfile(const QString &fileName, const double gamma)
+{
+    cmsCIExyY whitePoint {0.3127, 0.3290, 1};
+    cmsCIExyYTRIPLE primaries {
+        {0.64, 0.33, 1}, // red
+        {0.30, 0.60, 1}, // green
+        {0.15, 0.06, 1} // blue
+    };
+    cmsToneCurve *toneCurve = cmsBuildGamma(nullptr, gamma);
+    cmsToneCurve *toneCurves[3] {toneCurve, toneCurve, toneCurve};
+    cmsHPROFILE profile = cmsCreateRGBProfile(&whitePoint, &primaries, toneCurves);
+    cmsFreeToneCurve(toneCurve);
+    if (profile == nullptr) {
+        return false;
+    }
+    // Write the profile ID to the header, so that the tests can compare
+    // it with our own calculation.
+    bool success = cmsMD5computeID(profile);
+    if (success) {
+        success = cmsSaveProfileToFile( //
+            profile,
+            QFile::encodeName(fileName).constData());
+    }
+    cmsCloseProfile(profile);
+    return success;
+}
+
 class TestRgbColorSpaceFactory : public QObject
 {
     Q_OBJECT
@@ -72,6 +136,10 @@ public:
     {
     }
 
+private:
+    /** @brief Holds the profile files of the tests. */
+    QTemporaryDir m_temporaryDir;
+
 private Q_SLOTS:
     void initTestCase()
     {
@@ -103,10 +171,239 @@ private Q_SLOTS:
         QCOMPARE(temp->profileInfoDescription(), QStringLiteral("sRGB color space"));
     }
 
+    void testProfileId()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("profileid.icc"));
+        QVERIFY(createProfile(fileName, 2.2));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray content = file.readAll();
+        const QByteArray idFromHeader = content.mid(84, 16);
+        QVERIFY(idFromHeader != QByteArray(16, 0));
+        QCOMPARE(RgbColorSpaceFactory::profileId(content.constData(), content.size()), //
+                 idFromHeader);
+        // The ID is calculated from the content, not read from the header:
+        QByteArray modifiedContent = content;
+        modifiedContent.replace(84, 16, QByteArray(16, 'x'));
+        QCOMPARE(RgbColorSpaceFactory::profileId(modifiedContent.constData(), modifiedContent.size()), //
+                 idFromHeader);
+        // Too small to be an ICC profile:
+        QCOMPARE(RgbColorSpaceFactory::profileId(content.constData(), 100), //
+                 QByteArray());
+        QCOMPARE(RgbColorSpaceFactory::profileId(nullptr, 0), QByteArray());
+    }
+
+    void testCreateFromFileShared()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("shared.icc"));
+        QVERIFY(createProfile(fileName, 2.2));
+        const auto first = RgbColorSpaceFactory::createFromFile(fileName);
+        QVERIFY(!first.isNull());
+        const auto second = RgbColorSpaceFactory::createFromFile(fileName);
+        QCOMPARE(second.data(), first.data());
+    }
+
+    void testCreateFromFileIdenticalContent()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("original.icc"));
+        const QString copyName = m_temporaryDir.filePath(QStringLiteral("copy.icc"));
+        QVERIFY(createProfile(fileName, 2.2));
+        QVERIFY(QFile::copy(fileName, copyName));
+        const auto original = RgbColorSpaceFactory::createFromFile(fileName);
+        QVERIFY(!original.isNull());
+        const auto copy = RgbColorSpaceFactory::createFromFile(copyName);
+        QCOMPARE(copy.data(), original.data());
+    }
+
+    void testCreateFromFileChanged()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("changed.icc"));
+        QVERIFY(createProfile(fileName, 2.2));
+        const auto before = RgbColorSpaceFactory::createFromFile(fileName);
+        QVERIFY(!before.isNull());
+
+        QVERIFY(QFile::remove(fileName));
+        QVERIFY(createProfile(fileName, 1.8));
+        // Make sure that the modification time actually changes, even on
+        // file systems with a coarse time resolution:
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(60), //
+                                 QFileDevice::FileModificationTime));
+        file.close();
+
+        const auto after = RgbColorSpaceFactory::createFromFile(fileName);
+        QVERIFY(!after.isNull());
+        QVERIFY(after.data() != before.data());
+        QVERIFY(after->profileIdentifier() != before->profileIdentifier());
+        // Requesting it again gives the new object:
+        QCOMPARE(RgbColorSpaceFactory::createFromFile(fileName).data(), //
+                 after.data());
+    }
+
+    void testCreateFromFileReplacedWithSameMetadata()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("replaced.icc"));
+        QVERIFY(createProfile(fileName, 2.2));
+        const QDateTime lastModified = QFileInfo(fileName).lastModified();
+        QFile oldFile(fileName);
+        QVERIFY(oldFile.open(QIODevice::ReadOnly));
+        const QByteArray oldContent = oldFile.readAll();
+        oldFile.close();
+        // Load it once, so that the file is known, and release it again.
+        QVERIFY(!RgbColorSpaceFactory::createFromFile(fileName).isNull());
+
+        // Replace the content, but keep size and modification time:
+        QVERIFY(QFile::remove(fileName));
+        QVERIFY(createProfile(fileName, 1.8));
+        QFile newFile(fileName);
+        QVERIFY(newFile.open(QIODevice::ReadWrite));
+        QVERIFY(newFile.setFileTime(lastModified, //
+                                    QFileDevice::FileModificationTime));
+        const QByteArray newContent = newFile.readAll();
+        newFile.close();
+        QCOMPARE(newContent.size(), oldContent.size());
+        QVERIFY(newContent != oldContent);
+
+        // The object is built from the new content, and cached by the
+        // profile ID of the new content:
+        const auto colorSpace = RgbColorSpaceFactory::createFromFile(fileName);
+        QVERIFY(!colorSpace.isNull());
+        QCOMPARE(RgbColorSpaceFactory::createFromMemory(newContent).data(), //
+                 colorSpace.data());
+        QVERIFY(RgbColorSpaceFactory::createFromMemory(oldContent).data() //
+                != colorSpace.data());
+    }
+
+    void testCreateFromFileReleased()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("released.icc"));
+        QVERIFY(createProfile(fileName, 2.2));
+        QWeakPointer<RgbColorSpace> weak = RgbColorSpaceFactory::createFromFile(fileName);
+        // The cache does not keep the object alive:
+        QVERIFY(weak.isNull());
+        const auto colorSpace = RgbColorSpaceFactory::createFromFile(fileName);
+        QVERIFY(!colorSpace.isNull());
+        QCOMPARE(colorSpace->profileInfoDescription().isNull(), false);
+    }
+
+    void testCreateFromFileNonExisting()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("nonexisting.icc"));
+        QVERIFY(RgbColorSpaceFactory::createFromFile(fileName).isNull());
+    }
+
+    void testCreateFromFileNoProfile()
+    {
+        QVERIFY(RgbColorSpaceFactory::createFromFile( //
+                    QStringLiteral("../testbed/ascii-abcd.txt"))
+                    .isNull());
+    }
+
+    void testCreateFromMemory()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("memory.icc"));
+        QVERIFY(createProfile(fileName, 2.0));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray content = file.readAll();
+
+        const auto fromMemory = RgbColorSpaceFactory::createFromMemory(content);
+        QVERIFY(!fromMemory.isNull());
+        QCOMPARE(fromMemory->profileInfoDescription().isNull(), false);
+
+        // A raw memory buffer with the same content (a deep copy, so that
+        // the pointers actually differ) gives the same shared object:
+        const QByteArray deepCopy(content.constData(), content.size());
+        const auto fromRawData = RgbColorSpaceFactory::createFromMemory( //
+            QByteArray::fromRawData(deepCopy.constData(), deepCopy.size()));
+        QCOMPARE(fromRawData.data(), fromMemory.data());
+
+        // Also the file gives the same shared object:
+        QCOMPARE(RgbColorSpaceFactory::createFromFile(fileName).data(), //
+                 fromMemory.data());
+    }
+
+    void testCreateFromMemoryInvalid()
+    {
+        QVERIFY(RgbColorSpaceFactory::createFromMemory(QByteArray()).isNull());
+        QVERIFY(RgbColorSpaceFactory::createFromMemory(QByteArray(1000, 'x')).isNull());
+    }
+
+    void testCreateSrgbAsync()
+    {
+        QFuture<QSharedPointer<RgbColorSpace>> future = RgbColorSpaceFactory::createSrgbAsync();
+        future.waitForFinished();
+        QVERIFY(!future.isCanceled());
+        QCOMPARE(future.progressMinimum(), 0);
+        QCOMPARE(future.progressMaximum(), 100);
+        QCOMPARE(future.progressValue(), 100);
+        const QSharedPointer<RgbColorSpace> colorSpace = future.result();
+        QVERIFY(!colorSpace.isNull());
+        QCOMPARE(colorSpace->profileInfoDescription(), QStringLiteral("sRGB color space"));
+        // The object has been handed over to the main thread:
+        QCOMPARE(colorSpace->thread(), QCoreApplication::instance()->thread());
+    }
+
+    void testCreateFromFileAsync()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("async.icc"));
+        QVERIFY(createProfile(fileName, 2.2));
+        QFuture<QSharedPointer<RgbColorSpace>> future = RgbColorSpaceFactory::createFromFileAsync(fileName);
+        future.waitForFinished();
+        QVERIFY(!future.isCanceled());
+        const QSharedPointer<RgbColorSpace> colorSpace = future.result();
+        QVERIFY(!colorSpace.isNull());
+        // The result is shared with the synchronous function:
+        QCOMPARE(RgbColorSpaceFactory::createFromFile(fileName).data(), //
+                 colorSpace.data());
+    }
+
+    void testCreateFromFileOnWorkerThread()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("worker.icc"));
+        QVERIFY(createProfile(fileName, 2.4));
+        QSharedPointer<RgbColorSpace> colorSpace;
+        std::thread worker([&colorSpace, &fileName]() {
+            colorSpace = RgbColorSpaceFactory::createFromFile(fileName);
+        });
+        worker.join();
+        QVERIFY(!colorSpace.isNull());
+        // The worker thread has exited, but the shared object
+        // lives in the main thread:
+        QCOMPARE(colorSpace->thread(), QCoreApplication::instance()->thread());
+        QCOMPARE(RgbColorSpaceFactory::createFromFile(fileName).data(), //
+                 colorSpace.data());
+    }
+
+    void testCreateFromFileAsyncNonExisting()
+    {
+        const QString fileName = m_temporaryDir.filePath(QStringLiteral("nonexisting.icc"));
+        QFuture<QSharedPointer<RgbColorSpace>> future = RgbColorSpaceFactory::createFromFileAsync(fileName);
+        future.waitForFinished();
+        QVERIFY(!future.isCanceled());
+        QVERIFY(future.result().isNull());
+    }
+
+    void testCreateAsyncCancel()
+    {
+        QFuture<QSharedPointer<RgbColorSpace>> future = RgbColorSpaceFactory::createSrgbAsync();
+        future.cancel();
+        // Must not block forever:
+        future.waitForFinished();
+        QVERIFY(future.isCanceled());
+        QVERIFY(future.isFinished());
+    }
+
     void testSnipped01()
     {
         snippet01();
     }
+
+    void testSnipped02()
+    {
+        snippet02();
+    }
 };
 
 } // namespace PerceptualColor
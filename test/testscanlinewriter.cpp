@@ -0,0 +1,190 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "scanlinewriter.h"
+
+#include <QtTest>
+
+namespace PerceptualColor
+{
+class TestScanlineWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestScanlineWriter(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    /** @brief Channel values used for the tests, including the limits. */
+    static QVector<double> channelValues()
+    {
+        QVector<double> result;
+        for (int i = 0; i <= 100; ++i) {
+            result.append(i / 100.0);
+        }
+        // Values that are close to the rounding thresholds:
+        result.append(0.5 / 65535);
+        result.append(1.5 / 255);
+        result.append(127.5 / 255);
+        result.append(1 - 0.5 / 65535);
+        return result;
+    }
+
+    /** @brief The value that <tt>QImage::setPixelColor()</tt> writes. */
+    static QRgb referenceValue(const QColor &color)
+    {
+        QImage image(1, 1, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        image.setPixelColor(0, 0, color);
+        return reinterpret_cast<const QRgb *>(image.constScanLine(0))[0];
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testOpaqueArgb32()
+    {
+        const QVector<double> values = channelValues();
+        RgbDouble rgb;
+        for (const double value : values) {
+            rgb.red = value;
+            rgb.green = 1 - value;
+            rgb.blue = value / 2;
+            QCOMPARE(ScanlineWriter::opaqueArgb32(rgb), //
+                     referenceValue(QColor::fromRgbF(rgb.red, rgb.green, rgb.blue)));
+        }
+    }
+
+    void testPremultipliedArgb32()
+    {
+        const QVector<double> values = channelValues();
+        RgbDouble rgb;
+        for (const double value : values) {
+            for (const double alpha : values) {
+                rgb.red = value;
+                rgb.green = 1 - value;
+                rgb.blue = alpha;
+                QCOMPARE(ScanlineWriter::premultipliedArgb32(rgb, alpha), //
+                         referenceValue(QColor::fromRgbF(rgb.red, rgb.green, rgb.blue, alpha)));
+            }
+        }
+    }
+
+    void testWriteMasked()
+    {
+        QImage image(3, 2, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        const RgbDouble rgbBuffer[3] {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+        const bool maskBuffer[3] {true, false, true};
+        ScanlineWriter::writeMasked(ScanlineWriter::scanline(&image, 1), rgbBuffer, maskBuffer, 3);
+        QCOMPARE(image.pixelColor(0, 1), QColor(Qt::red));
+        QCOMPARE(image.pixelColor(1, 1), QColor(Qt::transparent));
+        QCOMPARE(image.pixelColor(2, 1), QColor(Qt::blue));
+        // The other row must not be touched.
+        for (int x = 0; x < 3; ++x) {
+            QCOMPARE(image.pixelColor(x, 0), QColor(Qt::transparent));
+        }
+    }
+
+    void testWriteMaskedPositions()
+    {
+        QImage image(5, 1, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        const int xBuffer[3] {4, 1, 2};
+        const RgbDouble rgbBuffer[3] {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+        const bool maskBuffer[3] {true, true, false};
+        ScanlineWriter::writeMasked(ScanlineWriter::scanline(&image, 0), xBuffer, rgbBuffer, maskBuffer, 3);
+        QCOMPARE(image.pixelColor(0, 0), QColor(Qt::transparent));
+        QCOMPARE(image.pixelColor(1, 0), QColor(Qt::green));
+        QCOMPARE(image.pixelColor(2, 0), QColor(Qt::transparent));
+        QCOMPARE(image.pixelColor(3, 0), QColor(Qt::transparent));
+        QCOMPARE(image.pixelColor(4, 0), QColor(Qt::red));
+    }
+
+    void testWritePremultiplied()
+    {
+        QImage image(2, 1, QImage::Format_ARGB32_Premultiplied);
+        const RgbDouble rgbBuffer[2] {{1, 0.5, 0.25}, {0.3, 0.6, 0.9}};
+        const qreal alphaBuffer[2] {0.5, 1};
+        ScanlineWriter::writePremultiplied(ScanlineWriter::scanline(&image, 0), rgbBuffer, alphaBuffer, 2);
+        QImage reference(2, 1, QImage::Format_ARGB32_Premultiplied);
+        reference.setPixelColor(0, 0, QColor::fromRgbF(1, 0.5, 0.25, 0.5));
+        reference.setPixelColor(1, 0, QColor::fromRgbF(0.3, 0.6, 0.9, 1));
+        QCOMPARE(image, reference);
+    }
+
+    void testSnippet()
+    {
+        //! [ScanlineWriter usage]
+        QImage image(2, 1, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        const RgbDouble rgbBuffer[2] {{1, 0, 0}, {0, 0, 1}};
+        // Only the first pixel is written; the second one
+        // keeps its transparent background.
+        const bool maskBuffer[2] {true, false};
+        ScanlineWriter::writeMasked( //
+            ScanlineWriter::scanline(&image, 0),
+            rgbBuffer,
+            maskBuffer,
+            2);
+        //! [ScanlineWriter usage]
+        QCOMPARE(image.pixelColor(0, 0), QColor(Qt::red));
+        QCOMPARE(image.pixelColor(1, 0), QColor(Qt::transparent));
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestScanlineWriter)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testscanlinewriter.moc"
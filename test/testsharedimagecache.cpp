@@ -0,0 +1,240 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "PerceptualColor/sharedimagecache.h"
+
+#include <QtTest>
+
+#include "PerceptualColor/lchadouble.h"
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "colorwheelimage.h"
+#include "gradientimage.h"
+
+#include <QDebug>
+
+namespace PerceptualColor
+{
+class TestSharedImageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestSharedImageCache(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    /** @brief The default value of @ref SharedImageCache::maximumSize() */
+    static constexpr qint64 defaultMaximumSize = 32 * 1024 * 1024;
+
+    /** @brief An image of 64 × 64 pixels, which is 16 KiB.
+     *
+     * @param color The color of the image
+     * @returns The image */
+    static QImage filledImage(const QColor color)
+    {
+        QImage result(64, 64, QImage::Format_ARGB32_Premultiplied);
+        result.fill(color);
+        return result;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+        SharedImageCache::clear();
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+        SharedImageCache::clear();
+        SharedImageCache::setMaximumSize(defaultMaximumSize);
+    }
+
+    void testDefaults()
+    {
+        QCOMPARE(SharedImageCache::maximumSize(), defaultMaximumSize);
+        QCOMPARE(SharedImageCache::size(), Q_INT64_C(0));
+        QCOMPARE(SharedImageCache::hits(), Q_UINT64_C(0));
+        QCOMPARE(SharedImageCache::misses(), Q_UINT64_C(0));
+    }
+
+    void testSetMaximumSize()
+    {
+        SharedImageCache::setMaximumSize(100 * 1024);
+        QCOMPARE(SharedImageCache::maximumSize(), Q_INT64_C(100 * 1024));
+        // Rounded down to full KiB:
+        SharedImageCache::setMaximumSize(100 * 1024 + 5);
+        QCOMPARE(SharedImageCache::maximumSize(), Q_INT64_C(100 * 1024));
+        SharedImageCache::setMaximumSize(-1);
+        QCOMPARE(SharedImageCache::maximumSize(), Q_INT64_C(0));
+    }
+
+    void testFindAndInsert()
+    {
+        const QByteArray key = QByteArrayLiteral("key");
+        QVERIFY(SharedImageCache::find(key).isNull());
+        QCOMPARE(SharedImageCache::misses(), Q_UINT64_C(1));
+        const QImage image = filledImage(Qt::red);
+        SharedImageCache::insert(key, image);
+        QCOMPARE(SharedImageCache::size(), Q_INT64_C(16 * 1024));
+        const QImage found = SharedImageCache::find(key);
+        QCOMPARE(SharedImageCache::hits(), Q_UINT64_C(1));
+        QCOMPARE(found, image);
+        // The image is shared, not copied:
+        QCOMPARE(found.constBits(), image.constBits());
+        // Other keys are not found:
+        QVERIFY(SharedImageCache::find(QByteArrayLiteral("other key")).isNull());
+        QCOMPARE(SharedImageCache::misses(), Q_UINT64_C(2));
+        // Null images are not cached:
+        SharedImageCache::insert(QByteArrayLiteral("null"), QImage());
+        QVERIFY(SharedImageCache::find(QByteArrayLiteral("null")).isNull());
+    }
+
+    void testClear()
+    {
+        const QByteArray key = QByteArrayLiteral("key");
+        const QImage image = filledImage(Qt::red);
+        SharedImageCache::insert(key, image);
+        SharedImageCache::find(key);
+        SharedImageCache::clear();
+        QCOMPARE(SharedImageCache::size(), Q_INT64_C(0));
+        QCOMPARE(SharedImageCache::hits(), Q_UINT64_C(0));
+        QVERIFY(SharedImageCache::find(key).isNull());
+        // Images that are still in use stay alive:
+        QCOMPARE(image.pixelColor(0, 0), QColor(Qt::red));
+    }
+
+    void testLeastRecentlyUsed()
+    {
+        // Enough for two images, but not for three.
+        SharedImageCache::setMaximumSize(40 * 1024);
+        const QByteArray first = QByteArrayLiteral("first");
+        const QByteArray second = QByteArrayLiteral("second");
+        const QByteArray third = QByteArrayLiteral("third");
+        SharedImageCache::insert(first, filledImage(Qt::red));
+        SharedImageCache::insert(second, filledImage(Qt::green));
+        // Using “first” makes it more recently used than “second”.
+        QVERIFY(!SharedImageCache::find(first).isNull());
+        SharedImageCache::insert(third, filledImage(Qt::blue));
+        QVERIFY(!SharedImageCache::find(first).isNull());
+        QVERIFY(SharedImageCache::find(second).isNull());
+        QVERIFY(!SharedImageCache::find(third).isNull());
+        QVERIFY(SharedImageCache::size() <= SharedImageCache::maximumSize());
+        // Reducing the maximum size evicts immediately.
+        SharedImageCache::setMaximumSize(20 * 1024);
+        QCOMPARE(SharedImageCache::size(), Q_INT64_C(16 * 1024));
+    }
+
+    void testTooBigImage()
+    {
+        SharedImageCache::setMaximumSize(10 * 1024);
+        const QByteArray key = QByteArrayLiteral("key");
+        SharedImageCache::insert(key, filledImage(Qt::red));
+        QVERIFY(SharedImageCache::find(key).isNull());
+        // A maximum size of 0 disables the cache.
+        SharedImageCache::setMaximumSize(0);
+        SharedImageCache::insert(key, filledImage(Qt::red));
+        QVERIFY(SharedImageCache::find(key).isNull());
+    }
+
+    void testColorWheelImagesAreShared()
+    {
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        ColorWheelImage first(colorSpace);
+        first.setImageSize(50);
+        first.setWheelThickness(10);
+        const QImage firstImage = first.getImage();
+        QCOMPARE(SharedImageCache::misses(), Q_UINT64_C(1));
+        ColorWheelImage second(colorSpace);
+        second.setImageSize(50);
+        second.setWheelThickness(10);
+        const QImage secondImage = second.getImage();
+        QCOMPARE(SharedImageCache::hits(), Q_UINT64_C(1));
+        // Both objects share the same memory:
+        QCOMPARE(secondImage.constBits(), firstImage.constBits());
+        // The hue table has not even been calculated.
+        QVERIFY(second.m_hueTable.isEmpty());
+    }
+
+    void testGradientImagesAreShared()
+    {
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        GradientImage first(colorSpace);
+        first.setGradientLength(100);
+        first.setGradientThickness(10);
+        first.setFirstColor(LchaDouble(50, 20, 30, 0.5));
+        first.setSecondColor(LchaDouble(60, 30, 150, 1));
+        GradientImage second(colorSpace);
+        second.setGradientLength(100);
+        second.setGradientThickness(10);
+        second.setFirstColor(LchaDouble(50, 20, 30, 0.5));
+        second.setSecondColor(LchaDouble(60, 30, 150, 1));
+        QCOMPARE(second.cacheKey(), first.cacheKey());
+        QCOMPARE(second.getImage().constBits(), first.getImage().constBits());
+        // Different parameters, different keys:
+        second.setSecondColor(LchaDouble(60, 30, 151, 1));
+        QVERIFY(second.cacheKey() != first.cacheKey());
+    }
+
+    void testSnippet()
+    {
+        //! [Statistics]
+        // Allow up to 64 MiB for shared images.
+        PerceptualColor::SharedImageCache::setMaximumSize(64 * 1024 * 1024);
+        // Statistics are available for debugging:
+        qDebug() << "Shared image cache:" //
+                 << PerceptualColor::SharedImageCache::size() << "bytes," //
+                 << PerceptualColor::SharedImageCache::hits() << "hits," //
+                 << PerceptualColor::SharedImageCache::misses() << "misses";
+        //! [Statistics]
+        QCOMPARE(SharedImageCache::maximumSize(), Q_INT64_C(64 * 1024 * 1024));
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestSharedImageCache)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testsharedimagecache.moc"
@@ -112,6 +112,33 @@ private Q_SLOTS:
         QCOMPARE(test.d_pointer->m_colorWheel->hue(), color.h);
     }
 
+    void testThrottledNotifications()
+    {
+        // Needed to read the signal arguments from QSignalSpy:
+        qRegisterMetaType<LchDouble>();
+        WheelColorPicker test {m_rgbColorSpace};
+        QSignalSpy spyThrottled(&test, &WheelColorPicker::currentColorChangedThrottled);
+        QSignalSpy spyFinished(&test, &WheelColorPicker::currentColorChangeFinished);
+        QSignalSpy spyDeltaE(&test, &WheelColorPicker::throttledNotificationDeltaEChanged);
+        test.setThrottledNotificationRate(10);
+        test.setThrottledNotificationDeltaE(5);
+        QCOMPARE(test.throttledNotificationDeltaE(), 5.0);
+        QCOMPARE(spyDeltaE.count(), 1);
+        LchDouble color;
+        color.l = 50;
+        color.c = 20;
+        color.h = 10;
+        test.setCurrentColor(color);
+        QCOMPARE(spyThrottled.count(), 1);
+        // Below the ΔE threshold:
+        color.c += 1;
+        test.setCurrentColor(color);
+        QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 2000);
+        QCOMPARE(spyThrottled.count(), 1);
+        // The final color is notified nevertheless:
+        QCOMPARE(spyFinished.at(0).at(0).value<LchDouble>().c, color.c);
+    }
+
     void testSizeHints()
     {
         WheelColorPicker test {m_rgbColorSpace};
@@ -0,0 +1,355 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "PerceptualColor/imagediskcache.h"
+#include "PerceptualColor/lchadouble.h"
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "PerceptualColor/sharedimagecache.h"
+#include "chromahueimage.h"
+#include "chromalightnessimage.h"
+#include "colorwheelimage.h"
+#include "gradientimage.h"
+#include "iohandlerfactory.h"
+#include "rgbcolorspace.h"
+
+#include <QFile>
+#include <QMap>
+#include <QSharedPointer>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <lcms2.h>
+
+// Benchmarks for the image generation of this library.
+//
+// Each benchmark covers a matrix of image sizes, device pixel ratios and
+// color spaces. The data tag of each row contains all parameters, so
+// the results can be compared across releases. Use QTest’s output
+// options to get machine-readable results, for example:
+//
+//     perceptualcolorbenchmarks -o benchmarks.csv,csv
+//     perceptualcolorbenchmarks -o benchmarks.xml,xml
+//
+// The build target “run-perceptualcolorbenchmarks” does exactly this and
+// writes both files to the build directory.
+//
+// The profile loading is benchmarked with LUT-based profiles of various
+// sizes, both with buffered and with memory-mapped file access.
+//
+// The images are rendered single-threaded (their default), so that the
+// results do not depend on the number of processor cores of the machine.
+// The shared image cache and the disk cache are disabled, so that each
+// iteration measures an actual rendering.
+
+namespace PerceptualColor
+{
+/** @brief Creates an ICC profile file with a wide gamut.
+ *
+ * There is no wide-gamut profile shipped with this library, so the
+ * profile is created with LittleCMS: Rec. 2020 primaries, D65 white
+ * point and a simple gamma 2.2 tone curve.
+ *
+ * @param fileName The file name of the new profile
+ * @returns <tt>true</tt> on success, <tt>false</tt> otherwise. */
+static bool createWideGamutProfile(const QString &fileName)
+{
+    cmsCIExyY whitePoint {0.3127, 0.3290, 1};
+    cmsCIExyYTRIPLE primaries {
+        {0.708, 0.292, 1}, // red
+        {0.170, 0.797, 1}, // green
+        {0.131, 0.046, 1} // blue
+    };
+    cmsToneCurve *toneCurve = cmsBuildGamma(nullptr, 2.2);
+    cmsToneCurve *toneCurves[3] {toneCurve, toneCurve, toneCurve};
+    cmsHPROFILE profile = cmsCreateRGBProfile(&whitePoint, &primaries, toneCurves);
+    cmsFreeToneCurve(toneCurve);
+    if (profile == nullptr) {
+        return false;
+    }
+    const bool success = cmsSaveProfileToFile( //
+        profile,
+        QFile::encodeName(fileName).constData());
+    cmsCloseProfile(profile);
+    return success;
+}
+
+/** @brief Creates a big LUT-based ICC profile file.
+ *
+ * The profile is created with LittleCMS: An RGB profile with identical
+ * <tt>AToB0</tt> and <tt>BToA0</tt> tags, each containing a color lookup
+ * table with <tt>gridPoints</tt>³ entries of 16 bit. The table content
+ * is meaningless; only the size matters.
+ *
+ * @param fileName The file name of the new profile
+ * @param gridPoints The number of grid points per dimension
+ * @returns <tt>true</tt> on success, <tt>false</tt> otherwise. */
+static bool createLutProfile(const QString &fileName, const cmsUInt32Number gridPoints)
+{
+    cmsCIExyY whitePoint {0.3127, 0.3290, 1};
+    cmsCIExyYTRIPLE primaries {
+        {0.64, 0.33, 1}, // red
+        {0.30, 0.60, 1}, // green
+        {0.15, 0.06, 1} // blue
+    };
+    cmsToneCurve *toneCurve = cmsBuildGamma(nullptr, 2.2);
+    cmsToneCurve *toneCurves[3] {toneCurve, toneCurve, toneCurve};
+    cmsHPROFILE profile = cmsCreateRGBProfile(&whitePoint, &primaries, toneCurves);
+    cmsFreeToneCurve(toneCurve);
+    if (profile == nullptr) {
+        return false;
+    }
+    cmsPipeline *pipeline = cmsPipelineAlloc(nullptr, 3, 3);
+    cmsPipelineInsertStage(pipeline, //
+                           cmsAT_END,
+                           cmsStageAllocCLut16bit(nullptr, gridPoints, 3, 3, nullptr));
+    bool success = cmsWriteTag(profile, cmsSigAToB0Tag, pipeline) //
+        && cmsWriteTag(profile, cmsSigBToA0Tag, pipeline);
+    cmsPipelineFree(pipeline);
+    if (success) {
+        success = cmsSaveProfileToFile( //
+            profile,
+            QFile::encodeName(fileName).constData());
+    }
+    cmsCloseProfile(profile);
+    return success;
+}
+
+class PerceptualColorBenchmarks : public QObject
+{
+    Q_OBJECT
+
+public:
+    PerceptualColorBenchmarks(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    /** @brief The color spaces of the benchmark matrix, by name. */
+    QMap<QString, QSharedPointer<RgbColorSpace>> m_colorSpaces;
+    /** @brief Holds the wide-gamut profile file. */
+    QTemporaryDir m_temporaryDir;
+
+    /** @brief Adds the columns and rows of the benchmark matrix.
+     *
+     * The columns are <tt>colorSpace</tt>, <tt>size</tt> (measured in
+     * device-independent pixels) and <tt>devicePixelRatio</tt>. */
+    void addBenchmarkMatrix()
+    {
+        QTest::addColumn<QString>("colorSpace");
+        QTest::addColumn<int>("size");
+        QTest::addColumn<qreal>("devicePixelRatio");
+        const QList<int> sizes {128, 512, 1024};
+        const QList<qreal> devicePixelRatios {1, 1.25, 2};
+        const QStringList colorSpaces = m_colorSpaces.keys();
+        for (const QString &colorSpace : colorSpaces) {
+            for (const int size : sizes) {
+                for (const qreal devicePixelRatio : devicePixelRatios) {
+                    const QByteArray tag = colorSpace.toUtf8() //
+                        + " " + QByteArray::number(size) //
+                        + "px dpr" + QByteArray::number(devicePixelRatio);
+                    QTest::newRow(tag.constData()) //
+                        << colorSpace << size << devicePixelRatio;
+                }
+            }
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+        SharedImageCache::setMaximumSize(0);
+        ImageDiskCache::setEnabled(false);
+        m_colorSpaces.insert(QStringLiteral("sRGB"), RgbColorSpaceFactory::createSrgb());
+        const QString wideGamutFileName = m_temporaryDir.filePath(QStringLiteral("widegamut.icc"));
+        QVERIFY(m_temporaryDir.isValid());
+        QVERIFY(createWideGamutProfile(wideGamutFileName));
+        const auto wideGamut = RgbColorSpaceFactory::createFromFile(wideGamutFileName);
+        QVERIFY(!wideGamut.isNull());
+        m_colorSpaces.insert(QStringLiteral("Rec2020"), wideGamut);
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void benchmarkChromaHueImage_data()
+    {
+        addBenchmarkMatrix();
+    }
+
+    void benchmarkChromaHueImage()
+    {
+        QFETCH(QString, colorSpace);
+        QFETCH(int, size);
+        QFETCH(qreal, devicePixelRatio);
+        const auto space = m_colorSpaces.value(colorSpace);
+        QBENCHMARK {
+            ChromaHueImage myImage(space);
+            myImage.setImageSize(qRound(size * devicePixelRatio));
+            myImage.setDevicePixelRatioF(devicePixelRatio);
+            myImage.setLightness(50);
+            myImage.getImage();
+        }
+    }
+
+    void benchmarkChromaLightnessImage_data()
+    {
+        addBenchmarkMatrix();
+    }
+
+    void benchmarkChromaLightnessImage()
+    {
+        QFETCH(QString, colorSpace);
+        QFETCH(int, size);
+        QFETCH(qreal, devicePixelRatio);
+        const auto space = m_colorSpaces.value(colorSpace);
+        // ChromaLightnessImage has no device pixel ratio of its own;
+        // its size is measured in physical pixels.
+        const int physicalSize = qRound(size * devicePixelRatio);
+        QBENCHMARK {
+            ChromaLightnessImage myImage(space);
+            myImage.setImageSize(QSize(physicalSize, physicalSize));
+            myImage.setHue(180);
+            myImage.getImage();
+        }
+    }
+
+    void benchmarkColorWheelImage_data()
+    {
+        addBenchmarkMatrix();
+    }
+
+    void benchmarkColorWheelImage()
+    {
+        QFETCH(QString, colorSpace);
+        QFETCH(int, size);
+        QFETCH(qreal, devicePixelRatio);
+        const auto space = m_colorSpaces.value(colorSpace);
+        QBENCHMARK {
+            ColorWheelImage myImage(space);
+            myImage.setImageSize(qRound(size * devicePixelRatio));
+            myImage.setDevicePixelRatioF(devicePixelRatio);
+            myImage.setWheelThickness(size * devicePixelRatio / 10);
+            myImage.getImage();
+        }
+    }
+
+    void benchmarkGradientImage_data()
+    {
+        addBenchmarkMatrix();
+    }
+
+    void benchmarkGradientImage()
+    {
+        QFETCH(QString, colorSpace);
+        QFETCH(int, size);
+        QFETCH(qreal, devicePixelRatio);
+        const auto space = m_colorSpaces.value(colorSpace);
+        // A semi-transparent gradient across the hue circle, which
+        // uses the general (slowest) code path of GradientImage.
+        LchaDouble firstColor;
+        firstColor.l = 30;
+        firstColor.c = 40;
+        firstColor.h = 0;
+        firstColor.a = 0.2;
+        LchaDouble secondColor;
+        secondColor.l = 80;
+        secondColor.c = 40;
+        secondColor.h = 300;
+        secondColor.a = 1;
+        QBENCHMARK {
+            GradientImage myImage(space);
+            myImage.setDevicePixelRatioF(devicePixelRatio);
+            myImage.setGradientLength(qRound(size * devicePixelRatio));
+            myImage.setGradientThickness(qMax(1, qRound(size * devicePixelRatio / 10)));
+            myImage.setFirstColor(firstColor);
+            myImage.setSecondColor(secondColor);
+            myImage.getImage();
+        }
+    }
+
+    void benchmarkProfileLoading_data()
+    {
+        QTest::addColumn<cmsUInt32Number>("gridPoints");
+        QTest::addColumn<bool>("memoryMapped");
+        const QList<cmsUInt32Number> gridPointsList {17, 33, 65};
+        for (const cmsUInt32Number gridPoints : gridPointsList) {
+            const QByteArray tag = "LUT " + QByteArray::number(gridPoints) //
+                + " grid points ";
+            QTest::newRow((tag + "buffered").constData()) << gridPoints << false;
+            QTest::newRow((tag + "memory-mapped").constData()) << gridPoints << true;
+        }
+    }
+
+    void benchmarkProfileLoading()
+    {
+        QFETCH(cmsUInt32Number, gridPoints);
+        QFETCH(bool, memoryMapped);
+        const QString fileName = m_temporaryDir.filePath( //
+            QStringLiteral("lut%1.icc").arg(gridPoints));
+        if (!QFile::exists(fileName)) {
+            QVERIFY(createLutProfile(fileName, gridPoints));
+        }
+        const auto access = memoryMapped //
+            ? IOHandlerFactory::FileAccess::MemoryMapped
+            : IOHandlerFactory::FileAccess::Buffered;
+        QBENCHMARK {
+            cmsIOHANDLER *handler = IOHandlerFactory::createReadOnly( //
+                nullptr,
+                fileName,
+                access);
+            // The profile takes ownership of the handler.
+            cmsHPROFILE profile = cmsOpenProfileFromIOhandlerTHR(nullptr, handler);
+            // LittleCMS reads the tags lazily. Force it to read the LUTs.
+            cmsReadTag(profile, cmsSigAToB0Tag);
+            cmsReadTag(profile, cmsSigBToA0Tag);
+            cmsCloseProfile(profile);
+        }
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::PerceptualColorBenchmarks)
+
+// The following “include” is necessary because we do not use a header file:
+#include "benchmarks.moc"